@@ -16,6 +16,7 @@
 
 #include "Button.h"
 #include "Texture.h"
+#include "Game.h"
 #include "Label.h"
 #include "SequenceAction.h"
 #include "ResizeByAction.h"
@@ -66,7 +67,9 @@ namespace cocosdl {
   _texture( NULL ),
   _pressedTexture( NULL )
   {
-    _texture = new Texture( textureFilePath );
+    _textureHandle = Game::getInstance()->getResources()->loadTexture( textureFilePath );
+    _pressedTextureHandle = _textureHandle;
+    _texture = _textureHandle.get();
     _pressedTexture = _texture;
     init();
   }
@@ -89,8 +92,11 @@ namespace cocosdl {
   _texture( NULL ),
   _pressedTexture( NULL )
   {
-    _texture = new Texture( textureFilePath );
-    _pressedTexture = new Texture( pressedTextureFilePath );
+    ResourceManager *resources = Game::getInstance()->getResources();
+    _textureHandle = resources->loadTexture( textureFilePath );
+    _pressedTextureHandle = resources->loadTexture( pressedTextureFilePath );
+    _texture = _textureHandle.get();
+    _pressedTexture = _pressedTextureHandle.get();
     init();
   }
 
@@ -117,22 +123,9 @@ namespace cocosdl {
     _pressAction = other._pressAction->copy();
     _releaseAction = other._releaseAction->copy();
     _buttonListener = other._buttonListener;
-    if( other._texture )
-    {
-      _texture = new Texture( *other._texture );
-    }
-    else
-    {
-      _texture = NULL;
-    }
-    if( other._pressedTexture )
-    {
-      _pressedTexture = new Texture( *other._pressedTexture );
-    }
-    else
-    {
-      _pressedTexture = NULL;
-    }
+    _texture = NULL;
+    _pressedTexture = NULL;
+    copyTextures( other );
     if( _buttonType == ButtonTypeNormal )
     {
       addAction( _animation->copy() );
@@ -144,14 +137,7 @@ namespace cocosdl {
     DESTROY_ACTION( _animation );
     DESTROY_ACTION( _pressAction );
     DESTROY_ACTION( _releaseAction );
-    if( _pressedTexture && _pressedTexture != _texture )
-    {
-      delete _pressedTexture;
-    }
-    if( _texture )
-    {
-      delete _texture;
-    }
+    releaseTextures();
     if( _pressedLabel && _pressedLabel != _label )
     {
       removeChild( _pressedLabel, false );
@@ -226,23 +212,52 @@ namespace cocosdl {
 
     // Animations are the same, so no need to remove and copy, we just keep them
     _buttonListener = other._buttonListener;
-    if( other._texture )
+    releaseTextures();
+    copyTextures( other );
+    return *this;
+  }
+
+  void Button::copyTextures( const Button &other )
+  {
+    // textures from the resource manager are shared, the rest are owned by each button
+    _textureHandle = other._textureHandle;
+    _pressedTextureHandle = other._pressedTextureHandle;
+    if( _textureHandle.isValid() )
     {
-      _texture = new Texture( *other._texture );
+      _texture = _textureHandle.get();
     }
     else
     {
-      _texture = NULL;
+      _texture = other._texture ? new Texture( *other._texture ) : NULL;
     }
-    if( other._pressedTexture )
+    if( _pressedTextureHandle.isValid() )
     {
-      _pressedTexture = new Texture( *other._pressedTexture );
+      _pressedTexture = _pressedTextureHandle.get();
+    }
+    else if( other._pressedTexture == other._texture )
+    {
+      _pressedTexture = _texture;
     }
     else
     {
-      _pressedTexture = NULL;
+      _pressedTexture = other._pressedTexture ? new Texture( *other._pressedTexture ) : NULL;
     }
-    return *this;
+  }
+
+  void Button::releaseTextures()
+  {
+    if( _pressedTexture && _pressedTexture != _texture && !_pressedTextureHandle.isValid() )
+    {
+      delete _pressedTexture;
+    }
+    if( _texture && !_textureHandle.isValid() )
+    {
+      delete _texture;
+    }
+    _texture = NULL;
+    _pressedTexture = NULL;
+    _textureHandle.reset();
+    _pressedTextureHandle.reset();
   }
 
 
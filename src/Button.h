@@ -216,9 +216,15 @@ namespace cocosdl
     ButtonType _buttonType;
     Texture *_texture;
     Texture *_pressedTexture;
+    TextureHandle _textureHandle;
+    TextureHandle _pressedTextureHandle;
 
     void init();
 
+    void copyTextures( const Button &other );
+
+    void releaseTextures();
+
     void release( bool click );
 
     void toggle();
@@ -10,9 +10,11 @@
 #define CocosDL_CocosDL_h
 
 #include "Action.h"
+#include "ActionEventQueue.h"
 #include "ActionFactory.h"
 #include "ActionObserver.h"
 #include "ActionPool.h"
+#include "AnimationSet.h"
 #include "FadeInAction.h"
 #include "FadeOutAction.h"
 #include "GroupAction.h"
@@ -26,22 +28,32 @@
 #include "RotateByAction.h"
 #include "RotateToAction.h"
 #include "RunCommandAction.h"
+#include "ScriptAction.h"
 #include "SequenceAction.h"
 #include "TiltLabelFontAction.h"
 #include "TimedAction.h"
 #include "WaitAction.h"
 #include "Button.h"
+#include "CollisionWorld.h"
 #include "Color.h"
 #include "Framework.h"
 #include "Game.h"
 #include "Label.h"
 #include "Node.h"
+#include "Prefab.h"
 #include "Point.h"
+#include "PreloadListener.h"
+#include "PreloadManifest.h"
 #include "Rect.h"
 #include "Renderer.h"
+#include "ResourceManager.h"
+#include "SoundMixer.h"
+#include "MusicPlayer.h"
 #include "Scene.h"
 #include "Sprite.h"
+#include "SpriteBatchNode.h"
 #include "Texture.h"
+#include "TextureListener.h"
 #include <CocosDL/Log.h>
 
 #endif
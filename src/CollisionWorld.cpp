@@ -0,0 +1,319 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include "CollisionWorld.h"
+#include "Node.h"
+#include "Rect.h"
+
+using namespace std;
+
+namespace cocosdl {
+
+  CollisionWorld::CollisionWorld() : _addedCount( 0 ), _pairTestCount( 0 ), _stepMs( 0.0 )
+  {
+  }
+
+  CollisionWorld::~CollisionWorld()
+  {
+    for( unordered_map<const Node *, Uint32>::iterator i = _bodyIndex.begin(); i != _bodyIndex.end(); ++i )
+    {
+      _bodies[i->second].node->_collisionWorld = NULL;
+    }
+  }
+
+  void CollisionWorld::addBody( Node *node, const Uint32 layers, const Uint32 mask )
+  {
+    if( !node )
+    {
+      return;
+    }
+    unordered_map<const Node *, Uint32>::iterator position = _bodyIndex.find( node );
+    if( position != _bodyIndex.end() )
+    {
+      _bodies[position->second].layers = layers;
+      _bodies[position->second].mask = mask;
+      return;
+    }
+    if( node->_collisionWorld )
+    {
+      node->_collisionWorld->removeBody( node );
+    }
+
+    Uint32 slot;
+    if( !_freeSlots.empty() )
+    {
+      slot = _freeSlots.back();
+      _freeSlots.pop_back();
+    }
+    else
+    {
+      slot = (Uint32) _bodies.size();
+      _bodies.push_back( Body() );
+    }
+    Body &body = _bodies[slot];
+    body.node = node;
+    body.layers = layers;
+    body.mask = mask;
+    body.removed = false;
+    _bodyIndex[node] = slot;
+    SweepEntry entry = { 0, 0, 0, 0, layers, mask, slot };
+    _sweep.push_back( entry );
+    _addedCount++;
+    node->_collisionWorld = this;
+  }
+
+  void CollisionWorld::removeBody( Node *node )
+  {
+    unordered_map<const Node *, Uint32>::iterator position = _bodyIndex.find( node );
+    if( position == _bodyIndex.end() )
+    {
+      return;
+    }
+    Uint32 slot = position->second;
+    _bodies[slot].removed = true;
+    // still in the sweep list and the contacts until the next step
+    _releasedSlots.push_back( slot );
+    _bodyIndex.erase( position );
+    node->_collisionWorld = NULL;
+  }
+
+  bool CollisionWorld::hasBody( const Node *node ) const
+  {
+    return _bodyIndex.find( node ) != _bodyIndex.end();
+  }
+
+  void CollisionWorld::step()
+  {
+    Uint64 start = SDL_GetPerformanceCounter();
+    _began.clear();
+    _ended.clear();
+    updateBounds();
+    sortSweep();
+    findPairs();
+    diffContacts();
+    _stepMs = ( SDL_GetPerformanceCounter() - start ) * 1000.0 / (double) SDL_GetPerformanceFrequency();
+
+    // ended first: a deleted body's node may be reused by a new body that begins contacts in the same step
+    for( size_t i = 0; i < _listeners.size() && !_ended.empty(); i++ )
+    {
+      _listeners[i]->contactsEnded( *this, _ended );
+    }
+    for( size_t i = 0; i < _listeners.size() && !_began.empty(); i++ )
+    {
+      _listeners[i]->contactsBegan( *this, _began );
+    }
+  }
+
+  bool CollisionWorld::isTouching( const Node *node, const Node *other ) const
+  {
+    unordered_map<const Node *, Uint32>::const_iterator first = _bodyIndex.find( node );
+    unordered_map<const Node *, Uint32>::const_iterator second = _bodyIndex.find( other );
+    if( first == _bodyIndex.end() || second == _bodyIndex.end() )
+    {
+      return false;
+    }
+    return binary_search( _contacts.begin(), _contacts.end(), getPairKey( first->second, second->second ) );
+  }
+
+  void CollisionWorld::getTouching( const Node *node, vector<Node *> &nodes ) const
+  {
+    unordered_map<const Node *, Uint32>::const_iterator position = _bodyIndex.find( node );
+    if( position == _bodyIndex.end() )
+    {
+      return;
+    }
+    Uint32 slot = position->second;
+    for( size_t i = 0; i < _contacts.size(); i++ )
+    {
+      Uint32 first = (Uint32) ( _contacts[i] >> 32 );
+      Uint32 second = (Uint32) _contacts[i];
+      const Body &other = _bodies[first == slot ? second : first];
+      if( ( first == slot || second == slot ) && !other.removed )
+      {
+        nodes.push_back( other.node );
+      }
+    }
+  }
+
+  void CollisionWorld::addListener( CollisionListener *listener )
+  {
+    if( listener && find( _listeners.begin(), _listeners.end(), listener ) == _listeners.end() )
+    {
+      _listeners.push_back( listener );
+    }
+  }
+
+  void CollisionWorld::removeListener( CollisionListener *listener )
+  {
+    vector<CollisionListener *>::iterator position = find( _listeners.begin(), _listeners.end(), listener );
+    if( position != _listeners.end() )
+    {
+      _listeners.erase( position );
+    }
+  }
+
+  void CollisionWorld::updateBounds()
+  {
+    Rect rect;
+    size_t last = 0;
+    for( size_t i = 0; i < _sweep.size(); i++ )
+    {
+      SweepEntry entry = _sweep[i];
+      const Body &body = _bodies[entry.slot];
+      if( !body.removed )
+      {
+        body.node->getDestinationRect( rect );
+        entry.left = rect.getX();
+        entry.top = rect.getY();
+        entry.right = entry.left + rect.getWidth();
+        entry.bottom = entry.top + rect.getHeight();
+        entry.layers = body.layers;
+        entry.mask = body.mask;
+        _sweep[last++] = entry;
+      }
+    }
+    _sweep.resize( last );
+
+    if( _releasedSlots.empty() )
+    {
+      return;
+    }
+    // end the contacts of removed bodies before their slots can be reused
+    last = 0;
+    for( size_t i = 0; i < _contacts.size(); i++ )
+    {
+      Uint64 key = _contacts[i];
+      if( !_bodies[(Uint32) ( key >> 32 )].removed && !_bodies[(Uint32) key].removed )
+      {
+        _contacts[last++] = key;
+      }
+      else
+      {
+        Contact contact = getContact( key );
+        contact.removed = true;
+        _ended.push_back( contact );
+      }
+    }
+    _contacts.resize( last );
+    for( size_t i = 0; i < _releasedSlots.size(); i++ )
+    {
+      _bodies[_releasedSlots[i]].node = NULL;
+    }
+    _freeSlots.insert( _freeSlots.end(), _releasedSlots.begin(), _releasedSlots.end() );
+    _releasedSlots.clear();
+  }
+
+  void CollisionWorld::sortSweep()
+  {
+    size_t count = _sweep.size();
+    if( _addedCount * 8 > count )
+    {
+      // too many new bodies at the end for an insertion sort
+      sort( _sweep.begin(), _sweep.end(), []( const SweepEntry &entry, const SweepEntry &other )
+      {
+        return entry.left < other.left;
+      } );
+    }
+    else
+    {
+      // bodies move little between steps, so most are already in place
+      for( size_t i = 1; i < count; i++ )
+      {
+        if( _sweep[i - 1].left <= _sweep[i].left )
+        {
+          continue;
+        }
+        SweepEntry entry = _sweep[i];
+        size_t j = i;
+        while( j > 0 && _sweep[j - 1].left > entry.left )
+        {
+          _sweep[j] = _sweep[j - 1];
+          j--;
+        }
+        _sweep[j] = entry;
+      }
+    }
+    _addedCount = 0;
+  }
+
+  void CollisionWorld::findPairs()
+  {
+    _pairs.clear();
+    _pairTestCount = 0;
+    size_t count = _sweep.size();
+    for( size_t i = 0; i < count; i++ )
+    {
+      const SweepEntry &entry = _sweep[i];
+      if( entry.right <= entry.left || entry.bottom <= entry.top )
+      {
+        continue;
+      }
+      size_t j = i + 1;
+      for( ; j < count; j++ )
+      {
+        const SweepEntry &other = _sweep[j];
+        if( other.left >= entry.right )
+        {
+          break;
+        }
+        // evaluated without branching, most tests fail on y and mispredicted branches would cost more than the test
+        bool overlaps = ( other.top < entry.bottom ) & ( entry.top < other.bottom ) & ( other.left < other.right ) &
+                        ( ( entry.layers & other.mask ) != 0 ) & ( ( other.layers & entry.mask ) != 0 );
+        if( overlaps )
+        {
+          _pairs.push_back( getPairKey( entry.slot, other.slot ) );
+        }
+      }
+      _pairTestCount += j - i - 1;
+    }
+    sort( _pairs.begin(), _pairs.end() );
+  }
+
+  void CollisionWorld::diffContacts()
+  {
+    size_t i = 0, j = 0;
+    while( i < _pairs.size() || j < _contacts.size() )
+    {
+      if( j == _contacts.size() || ( i < _pairs.size() && _pairs[i] < _contacts[j] ) )
+      {
+        _began.push_back( getContact( _pairs[i++] ) );
+      }
+      else if( i == _pairs.size() || _contacts[j] < _pairs[i] )
+      {
+        _ended.push_back( getContact( _contacts[j++] ) );
+      }
+      else
+      {
+        i++;
+        j++;
+      }
+    }
+    _contacts.swap( _pairs );
+  }
+
+  Contact CollisionWorld::getContact( const Uint64 key ) const
+  {
+    Contact contact = { _bodies[(Uint32) ( key >> 32 )].node, _bodies[(Uint32) key].node, false };
+    return contact;
+  }
+
+  Uint64 CollisionWorld::getPairKey( const Uint32 slot, const Uint32 otherSlot )
+  {
+    return slot < otherSlot ? ( (Uint64) slot << 32 ) | otherSlot : ( (Uint64) otherSlot << 32 ) | slot;
+  }
+
+}
@@ -0,0 +1,224 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __CollisionWorld_H_
+#define __CollisionWorld_H_
+
+#include <vector>
+#include <unordered_map>
+#include <stddef.h>
+#include <SDL2/SDL.h>
+
+namespace cocosdl {
+
+  class Node;
+  class CollisionWorld;
+
+  static const Uint32 ALL_COLLISION_LAYERS = 0xFFFFFFFF;
+
+  /**
+   * Two bodies whose bounds overlap. A contact that ended because one of its bodies left the world is flagged as
+   * removed; the node of that body may already be deleted, so it can be compared but must not be used (hasBody tells
+   * which one is left).
+   */
+  struct Contact
+  {
+    Node  *node;
+    Node  *other;
+    bool  removed;
+  };
+
+  /**
+   * CollisionListener is an interface / protocol to allow objects to be notified of the contacts between bodies of a
+   * CollisionWorld. Each step delivers every contact that ended and began in it at once, the ended ones first.
+   *
+   * @author narciso.cerezo@gmail.com
+   * @version 1.0
+   */
+  class CollisionListener
+  {
+
+  public:
+    /**
+     * Bodies started to overlap in the last step.
+     *
+     * @param world the world
+     * @param contacts the new contacts
+     */
+    virtual void contactsBegan( CollisionWorld &world, const std::vector<Contact> &contacts ) = 0;
+
+    /**
+     * Bodies stopped overlapping in the last step.
+     *
+     * @param world the world
+     * @param contacts the contacts that ended
+     */
+    virtual void contactsEnded( CollisionWorld &world, const std::vector<Contact> &contacts ) = 0;
+  };
+
+  /**
+   * Detects the overlaps between the screen bounds of nodes registered as bodies. Each body belongs to a set of layers
+   * and collides with those in its mask; two bodies touch when each one's layers are in the other's mask.<br/>
+   * The broadphase is sweep and prune on the x axis: bodies stay sorted by their left edge from one step to the next,
+   * so re-sorting after they move costs little more than a pass, and only bodies overlapping on x are tested on y.
+   * Bounds are the unrotated destination rects of the nodes.<br/>
+   * The game steps its world (Game::getCollisionWorld) once per frame, after running actions. Nodes leave the world
+   * when deleted, and their contacts are reported as ended, flagged as removed, on the next step.
+   *
+   * @author narciso.cerezo@gmail.com
+   * @version 1.0
+   */
+  class CollisionWorld
+  {
+
+  public:
+    CollisionWorld();
+
+    virtual ~CollisionWorld();
+
+    /**
+     * Add a node as a body, or change the layers of a body.
+     *
+     * @param node the node
+     * @param layers bit mask of the layers the body belongs to
+     * @param mask bit mask of the layers it collides with
+     */
+    void addBody( Node *node, const Uint32 layers, const Uint32 mask = ALL_COLLISION_LAYERS );
+
+    /**
+     * Remove a body. Its contacts end on the next step, flagged as removed.
+     *
+     * @param node the node
+     */
+    void removeBody( Node *node );
+
+    /**
+     * Check if a node is a body of this world.
+     *
+     * @param node the node
+     */
+    bool hasBody( const Node *node ) const;
+
+    /**
+     * Update the bodies bounds, find the overlapping bodies and notify the contacts that began or ended since the last
+     * step.
+     */
+    void step();
+
+    /**
+     * Check if two bodies were touching in the last step.
+     *
+     * @param node a body
+     * @param other another body
+     * @return true if they overlapped
+     */
+    bool isTouching( const Node *node, const Node *other ) const;
+
+    /**
+     * Get the bodies touching one in the last step.
+     *
+     * @param node the body
+     * @param nodes filled with the bodies touching it
+     */
+    void getTouching( const Node *node, std::vector<Node *> &nodes ) const;
+
+    void addListener( CollisionListener *listener );
+
+    void removeListener( CollisionListener *listener );
+
+    size_t getBodyCount() const
+    {
+      return _bodyIndex.size();
+    }
+
+    /**
+     * Get the number of body pairs touching in the last step.
+     */
+    size_t getContactCount() const
+    {
+      return _contacts.size();
+    }
+
+    /**
+     * Get the number of body pairs tested on the y axis in the last step.
+     */
+    size_t getPairTestCount() const
+    {
+      return _pairTestCount;
+    }
+
+    /**
+     * Get the duration of the last step, not counting the listeners.
+     *
+     * @return step time in milliseconds
+     */
+    double getStepMs() const
+    {
+      return _stepMs;
+    }
+
+  private:
+    struct Body
+    {
+      Node    *node;      // kept once removed, to report the contacts it ends
+      Uint32  layers;
+      Uint32  mask;
+      bool    removed;
+    };
+
+    // bounds copied next to each other so the sweep reads memory in order
+    struct SweepEntry
+    {
+      int     left, top, right, bottom;
+      Uint32  layers;
+      Uint32  mask;
+      Uint32  slot;
+    };
+
+    std::vector<Body>                       _bodies;          // by slot
+    std::unordered_map<const Node *, Uint32> _bodyIndex;     // slot of each node
+    std::vector<Uint32>                     _freeSlots;
+    std::vector<Uint32>                     _releasedSlots;   // free once the sweep list no longer has them
+    std::vector<SweepEntry>                 _sweep;           // sorted by left edge
+    std::vector<Uint64>                     _contacts;        // sorted pair keys of the last step
+    std::vector<Uint64>                     _pairs;
+    std::vector<Contact>                    _began;
+    std::vector<Contact>                    _ended;
+    std::vector<CollisionListener *>        _listeners;
+    size_t                                  _addedCount;      // bodies appended to the sweep list since last step
+    size_t                                  _pairTestCount;
+    double                                  _stepMs;
+
+    CollisionWorld( const CollisionWorld &other );
+
+    CollisionWorld &operator = ( const CollisionWorld &other );
+
+    void updateBounds();
+
+    void sortSweep();
+
+    void findPairs();
+
+    void diffContacts();
+
+    Contact getContact( const Uint64 key ) const;
+
+    static Uint64 getPairKey( const Uint32 slot, const Uint32 otherSlot );
+  };
+
+}
+
+#endif //__CollisionWorld_H_
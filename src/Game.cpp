@@ -20,6 +20,13 @@
 #include <SDL2_image/SDL_image.h>
 #include <iostream>
 #include "Renderer.h"
+#include "Texture.h"
+#include "ActionEventQueue.h"
+#include "AssetArchive.h"
+#include "Log.h"
+#include "JobSystem.h"
+#include "PreloadManifest.h"
+#include "TextureListener.h"
 
 using namespace std;
 
@@ -34,7 +41,10 @@ namespace cocosdl {
   _windowFlags( SDL_WINDOW_SHOWN ),
   _scene( NULL ),
   _running( false ),
-  _backgroundMusicPlaying( "" ),
+  _resources( new ResourceManager() ),
+  _mixer( new SoundMixer() ),
+  _musicPlayer( new MusicPlayer( _mixer ) ),
+  _collisionWorld( new CollisionWorld() ),
   _soundVolume( DEFAULT_SOUND_VOLUME ),
   _musicVolume( DEFAULT_MUSIC_VOLUME ),
   _windowRect( x, y, width, height )
@@ -45,10 +55,13 @@ namespace cocosdl {
   _window( NULL ),
   _renderer( NULL ),
   _title( title ? title : "Game" ),
-  _windowFlags( SDL_WINDOW_SHOWN ),
+  _windowFlags( windowFlags ),
   _scene( NULL ),
   _running( false ),
-  _backgroundMusicPlaying( "" ),
+  _resources( new ResourceManager() ),
+  _mixer( new SoundMixer() ),
+  _musicPlayer( new MusicPlayer( _mixer ) ),
+  _collisionWorld( new CollisionWorld() ),
   _soundVolume( DEFAULT_SOUND_VOLUME ),
   _musicVolume( DEFAULT_MUSIC_VOLUME ),
   _windowRect( x, y, width, height )
@@ -57,18 +70,11 @@ namespace cocosdl {
 
   Game::~Game()
   {
-    for( map<string, TTF_Font *>::iterator i = _fonts.begin(); i != _fonts.end(); ++i )
-    {
-      TTF_CloseFont( ( *i ).second );
-    }
-    for( map<string, Mix_Music *>::iterator i = _music.begin(); i != _music.end(); ++i )
-    {
-      Mix_FreeMusic( ( *i ).second );
-    }
-    for( map<string, Mix_Chunk *>::iterator i = _sounds.begin(); i != _sounds.end(); ++i )
-    {
-      Mix_FreeChunk( ( *i ).second );
-    }
+    action::ActionEventQueue::clear();
+    delete _collisionWorld;
+    delete _musicPlayer;
+    delete _mixer;
+    delete _resources;
     if( _window )
     {
       SDL_DestroyWindow( _window );
@@ -77,6 +83,11 @@ namespace cocosdl {
     {
       delete _renderer;
     }
+    // last, fonts and music still read from them until closed
+    for( vector<util::AssetArchive *>::iterator i = _archives.begin(); i != _archives.end(); ++i )
+    {
+      delete *i;
+    }
   }
 
 
@@ -105,6 +116,18 @@ namespace cocosdl {
     return true;
   }
 
+  bool Game::init( const char *title, const int x, const int y, const int width, const int height, const Uint32 windowFlags,
+                   const AudioSettings &audioSettings )
+  {
+    if( !_instance )
+    {
+      _instance = new Game( title, x, y, width, height, windowFlags );
+      _instance->_audioSettings = audioSettings;
+      return _instance->init();
+    }
+    return true;
+  }
+
   bool Game::init()
   {
 
@@ -133,11 +156,18 @@ namespace cocosdl {
       return false;
     }
 
-    if( Mix_OpenAudio( MIX_DEFAULT_FREQUENCY, MIX_DEFAULT_FORMAT, MIXER_CHANNELS, MIXER_CHUNK_SIZE ) == -1 )
+    if( Mix_OpenAudio( _audioSettings.frequency, _audioSettings.format, _audioSettings.channels,
+                       _audioSettings.bufferSize ) == -1 )
     {
       SDL_Log( "Can't open audio" );
       return false;
     }
+    // the device may not support what was asked for
+    Mix_QuerySpec( &_audioSettings.frequency, &_audioSettings.format, &_audioSettings.channels );
+    SDL_Log( "Audio: %d Hz, %d channels, %d samples per buffer (%.1f ms)", _audioSettings.frequency,
+             _audioSettings.channels, _audioSettings.bufferSize, _audioSettings.getBufferMs() );
+    _mixer->setVoiceCount( _audioSettings.voiceCount );
+    _musicPlayer->start();
 
     _window = SDL_CreateWindow(
         _title.c_str(),
@@ -163,7 +193,19 @@ namespace cocosdl {
     Rect clipRect( 0, 0, _windowRect.getWidth(), _windowRect.getHeight() );
     _renderer->setClipRect( clipRect );
 
-    Mix_VolumeMusic( (int) ( _musicVolume * MIX_MAX_VOLUME ) );
+    _mixer->setSoundVolume( _soundVolume );
+    _mixer->setBusVolume( MusicBus, _musicVolume );
+
+    // this also resolves the resource path before any worker asks for it
+    SDL_RWops *archive = SDL_RWFromFile( ( getResourcePath() + DEFAULT_ASSET_ARCHIVE ).c_str(), "rb" );
+    if( archive )
+    {
+      SDL_RWclose( archive );
+      mountArchive( DEFAULT_ASSET_ARCHIVE );
+    }
+
+    // created here so this thread, which owns the renderer, is its main thread
+    util::JobSystem::getInstance();
 
     return true;
   }
@@ -197,8 +239,16 @@ namespace cocosdl {
           loops++;
         }
 
+        util::JobSystem::getInstance()->runMainThreadJobs();
+        Texture::uploadLoadedTextures();
+        _resources->enforceBudgets();
+        long long now = currentTimeMillis();
+        _mixer->update( now );
+        _musicPlayer->update( now );
         _renderer->clear();
         _scene->runActions();
+        action::ActionEventQueue::dispatch();
+        _collisionWorld->step();
         _scene->update( currentTimeMillis() / 10 );
         _scene->draw();
         _renderer->present();
@@ -221,6 +271,7 @@ namespace cocosdl {
 
   void Game::quit()
   {
+    util::JobSystem::destroyInstance();
     IMG_Quit();
     TTF_Quit();
     Mix_Quit();
@@ -230,174 +281,291 @@ namespace cocosdl {
 
   bool Game::loadFont( const string &name, const int fontSize )
   {
-    TTF_Font *font = getFont( name, fontSize );
-    if( !font )
-    {
-      string path = getResourcePath() + name + ".ttf";
-      font = TTF_OpenFont( path.c_str(), fontSize );
-      if( font )
-      {
-        char sizeString[20];
-        snprintf( sizeString, 20, "%d", fontSize );
-        string key = name + sizeString;
-        _fonts.insert( _fonts.end(), make_pair( key, font ) );
-        return true;
-      }
-      else
-      {
-        return false;
-      }
-    }
-    else
-    {
-      return true;
-    }
+    return _resources->loadFont( name, fontSize ).isValid();
   }
 
   TTF_Font *Game::getFont( const string &name, const int fontSize )
   {
-    char sizeString[20];
-    snprintf( sizeString, 20, "%d", fontSize );
-    string key = name + sizeString;
-    map<string, TTF_Font *>::iterator position = _fonts.find( key );
-    if( position != _fonts.end() )
-    {
-      return ( *position ).second;
-    }
-    else
-    {
-      return NULL;
-    }
+    return _resources->findFont( name, fontSize ).get();
   }
 
 
   bool Game::loadMusic( const string &name )
   {
-    Mix_Music *music = getMusic( name );
-    if( !music )
-    {
-      string path = getResourcePath() + name + ".mp3";
-      music = Mix_LoadMUS( path.c_str() );
-      if( music )
-      {
-        _music.insert( _music.end(), make_pair( name, music ) );
-        return true;
-      }
-      else
-      {
-        return false;
-      }
-    }
-    else
-    {
-      return true;
-    }
+    return _resources->loadMusic( name ).isValid();
   }
 
   Mix_Music *Game::getMusic( const string &name )
   {
-    map<string, Mix_Music *>::iterator position = _music.find( name );
-    if( position != _music.end() )
-    {
-      return ( *position ).second;
-    }
-    else
-    {
-      return NULL;
-    }
+    return _resources->findMusic( name ).get();
   }
 
   bool Game::playBackgroundMusic( const string &name )
   {
-    Mix_Music *music = getMusic( name );
-    if( music )
-    {
-      if( Mix_FadeInMusic( music, -1, MUSIC_FADE_IN_MS ) != -1 )
-      {
-        _backgroundMusicPlaying = name;
-        return true;
-      }
-      else
-      {
-        return false;
-      }
-    }
-    else
-    {
-      return false;
-    }
+    _musicPlayer->play( name, MUSIC_FADE_OUT_MS + MUSIC_FADE_IN_MS );
+    return true;
   }
 
   bool Game::stopBackgroundMusic()
   {
-    return Mix_FadeOutMusic( MUSIC_FADE_OUT_MS ) == 1;
+    return _musicPlayer->stop( MUSIC_FADE_OUT_MS );
   }
 
   void Game::setMusicVolume( const float musicVolume )
   {
     _musicVolume = musicVolume;
-    Mix_VolumeMusic( (int) ( MIX_MAX_VOLUME * musicVolume ) );
+    _mixer->setBusVolume( MusicBus, musicVolume );
   }
 
   bool Game::loadSound( const string &name )
   {
-    Mix_Chunk *sound = getSound( name );
-    if( !sound )
+    return _resources->loadSound( name ).isValid();
+  }
+
+  Mix_Chunk *Game::getSound( const string &name )
+  {
+    return _resources->findSound( name ).get();
+  }
+
+  int Game::playSound( const string &name )
+  {
+    return _mixer->play( _resources->loadSound( name ) );
+  }
+
+  int Game::playSound( const SoundHandle &sound )
+  {
+    return _mixer->play( sound );
+  }
+
+
+  void Game::setSoundVolume( const float soundVolume )
+  {
+    _soundVolume = soundVolume;
+    _mixer->setSoundVolume( soundVolume );
+  }
+
+  /**
+   * Reports to the manifest when a preloaded texture is ready.
+   */
+  class PreloadTextureListener : public TextureListener
+  {
+
+  public:
+    PreloadTextureListener( PreloadManifest *manifest, const size_t index ) : _manifest( manifest ), _index( index )
     {
-      string path = getResourcePath() + name + ".ogg";
-      sound = Mix_LoadWAV( path.c_str() );
-      if( sound )
-      {
-        Mix_VolumeChunk( sound, (int) ( MIX_MAX_VOLUME * _soundVolume ) );
-        _sounds.insert( _sounds.end(), make_pair( name, sound ) );
-        return true;
-      }
-      else
-      {
-        return false;
-      }
     }
-    else
+
+    virtual void textureLoaded( Texture *texture, const bool success )
     {
-      return true;
+      _manifest->assetFinished( _index, success );
+      delete this;
     }
+
+  private:
+    PreloadManifest *_manifest;
+    size_t          _index;
+  };
+
+  static double elapsedMs( const Uint64 startCounter )
+  {
+    return ( SDL_GetPerformanceCounter() - startCounter ) * 1000.0 / (double) SDL_GetPerformanceFrequency();
   }
 
-  Mix_Chunk *Game::getSound( const string &name )
+  void Game::preload( PreloadManifest *manifest, PreloadListener *listener )
   {
-    map<string, Mix_Chunk *>::iterator position = _sounds.find( name );
-    if( position != _sounds.end() )
-    {
-      return ( *position ).second;
+    util::JobSystem *jobSystem = util::JobSystem::getInstance();
+    manifest->start( listener );
+    size_t count = manifest->getCount();
+    for( size_t i = 0; i < count; i++ )
+    {
+      PreloadAsset &asset = manifest->_assets.at( i );
+      string name = asset.name;
+      int fontSize = asset.fontSize;
+      switch( asset.type )
+      {
+        case TextureAsset:
+        {
+          asset.texture = _resources->loadTextureAsync( name );
+          Texture *texture = asset.texture.get();
+          if( texture->getStatus() != TextureLoading )
+          {
+            manifest->assetFinished( i, texture->isReady() );
+          }
+          else
+          {
+            texture->addListener( new PreloadTextureListener( manifest, i ) );
+          }
+          break;
+        }
+
+        case FontAsset:
+        {
+          asset.font = _resources->findFont( name, fontSize );
+          if( asset.font.isValid() )
+          {
+            manifest->assetFinished( i, true );
+            break;
+          }
+          size_t archivedSize;
+          if( getArchivedResource( name + ".ttf", archivedSize ) )
+          {
+            // already in memory, opening it only parses the font tables
+            Uint64 start = SDL_GetPerformanceCounter();
+            asset.font = _resources->loadFont( name, fontSize );
+            manifest->assetFinished( i, asset.font.isValid(), elapsedMs( start ) );
+            break;
+          }
+          // FreeType faces can't be created concurrently, only the file is read on the worker, and the font is
+          // opened from memory on the game thread
+          jobSystem->runAsync( [this, manifest, i, name, fontSize]()
+          {
+            Uint64 start = SDL_GetPerformanceCounter();
+            vector<Uint8> *data = new vector<Uint8>();
+            SDL_RWops *file = openResource( name + ".ttf" );
+            if( file )
+            {
+              Sint64 size = SDL_RWsize( file );
+              if( size > 0 )
+              {
+                data->resize( (size_t) size );
+                if( SDL_RWread( file, &( *data )[0], 1, (size_t) size ) != (size_t) size )
+                {
+                  data->clear();
+                }
+              }
+              SDL_RWclose( file );
+            }
+            double readMs = elapsedMs( start );
+            util::JobSystem::getInstance()->runOnMainThread( [this, manifest, i, name, fontSize, data, readMs]()
+            {
+              Uint64 start = SDL_GetPerformanceCounter();
+              TTF_Font *font = NULL;
+              if( !data->empty() )
+              {
+                font = TTF_OpenFontRW( SDL_RWFromConstMem( &( *data )[0], (int) data->size() ), 1, fontSize );
+              }
+              if( font )
+              {
+                // the font reads from the buffer, the manager keeps it as long as the font
+                manifest->_assets.at( i ).font = _resources->addFont( name, fontSize, font, data, data->size() );
+              }
+              else
+              {
+                delete data;
+              }
+              manifest->assetFinished( i, font != NULL, readMs + elapsedMs( start ) );
+            } );
+          } );
+          break;
+        }
+
+        case SoundAsset:
+        {
+          asset.sound = _resources->findSound( name );
+          if( asset.sound.isValid() )
+          {
+            manifest->assetFinished( i, true );
+            break;
+          }
+          jobSystem->runAsync( [this, manifest, i, name]()
+          {
+            Uint64 start = SDL_GetPerformanceCounter();
+            SDL_RWops *rw = openResource( name + ".ogg" );
+            Mix_Chunk *sound = rw ? Mix_LoadWAV_RW( rw, 1 ) : NULL;
+            double loadMs = elapsedMs( start );
+            util::JobSystem::getInstance()->runOnMainThread( [this, manifest, i, name, sound, loadMs]()
+            {
+              manifest->_assets.at( i ).sound = _resources->addSound( name, sound );
+              manifest->assetFinished( i, sound != NULL, loadMs );
+            } );
+          } );
+          break;
+        }
+
+        case MusicAsset:
+        {
+          asset.music = _resources->findMusic( name );
+          if( asset.music.isValid() )
+          {
+            manifest->assetFinished( i, true );
+            break;
+          }
+          jobSystem->runAsync( [this, manifest, i, name]()
+          {
+            Uint64 start = SDL_GetPerformanceCounter();
+            SDL_RWops *rw = openResource( name + ".mp3" );
+            Sint64 size = rw ? SDL_RWsize( rw ) : 0;
+            Mix_Music *music = rw ? Mix_LoadMUS_RW( rw, 1 ) : NULL;
+            double loadMs = elapsedMs( start );
+            util::JobSystem::getInstance()->runOnMainThread( [this, manifest, i, name, music, size, loadMs]()
+            {
+              manifest->_assets.at( i ).music = _resources->addMusic( name, music, size > 0 ? (size_t) size : 0 );
+              manifest->assetFinished( i, music != NULL, loadMs );
+            } );
+          } );
+          break;
+        }
+      }
     }
-    else
+  }
+
+  bool Game::preloadAndWait( PreloadManifest *manifest, PreloadListener *listener )
+  {
+    preload( manifest, listener );
+    while( !manifest->isFinished() )
     {
-      return NULL;
+      size_t done = util::JobSystem::getInstance()->runMainThreadJobs();
+      done += Texture::uploadLoadedTextures();
+      if( done == 0 )
+      {
+        SDL_Delay( 1 );
+      }
     }
+    return manifest->isSuccessful();
   }
 
-  int Game::playSound( const string &name )
+  Texture *Game::getTexture( const string &fileName )
   {
-    Mix_Chunk *sound = getSound( name );
-    if( sound )
+    return _resources->findTexture( fileName ).get();
+  }
+
+  bool Game::mountArchive( const string &fileName )
+  {
+    util::AssetArchive *archive = new util::AssetArchive();
+    const string path = getResourcePath() + fileName;
+    if( !archive->open( path ) )
     {
-      return Mix_PlayChannel( -1, sound, 0 );
+      Log::error() << "Can't mount asset archive " << path << std::endl;
+      delete archive;
+      return false;
     }
-    else
+    SDL_Log( "Mounted asset archive %s (%d entries)", path.c_str(), (int) archive->getCount() );
+    _archives.push_back( archive );
+    return true;
+  }
+
+  SDL_RWops *Game::openResource( const string &fileName )
+  {
+    size_t size;
+    const void *data = getArchivedResource( fileName, size );
+    if( data )
     {
-      return -1;
+      return SDL_RWFromConstMem( data, (int) size );
     }
+    return SDL_RWFromFile( ( getResourcePath() + fileName ).c_str(), "rb" );
   }
 
-
-  void Game::setSoundVolume( const float soundVolume )
+  const void *Game::getArchivedResource( const string &fileName, size_t &size )
   {
-    _soundVolume = soundVolume;
-    int volume = (int) ( MIX_MAX_VOLUME * soundVolume );
-    for( map<string, Mix_Chunk *>::iterator i = _sounds.begin(); i != _sounds.end(); ++i )
+    for( vector<util::AssetArchive *>::reverse_iterator i = _archives.rbegin(); i != _archives.rend(); ++i )
     {
-      Mix_VolumeChunk( ( *i ).second, volume );
+      const void *data = ( *i )->find( fileName, size );
+      if( data )
+      {
+        return data;
+      }
     }
+    return NULL;
   }
 
   /*
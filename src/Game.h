@@ -21,8 +21,13 @@
 #include <string>
 #include <map>
 #include <stack>
+#include <vector>
 #include "Scene.h"
 #include "Rect.h"
+#include "ResourceManager.h"
+#include "SoundMixer.h"
+#include "MusicPlayer.h"
+#include "CollisionWorld.h"
 #include <SDL2_ttf/SDL_ttf.h>
 #include <SDL2_mixer/SDL_mixer.h>
 
@@ -33,13 +38,55 @@ namespace cocosdl {
   static const int TICKS_PER_SECOND = 25;
   static const int SKIP_TICKS = 1000 / TICKS_PER_SECOND;
   static const int MAX_FRAME_SKIP = 5;
-  static const int MIXER_CHANNELS = 2;
+  static const int MIXER_CHANNELS = 2;    // output channels (stereo), voices are set with SoundMixer::setVoiceCount
   static const int MIXER_CHUNK_SIZE = 1024;
   static const int MUSIC_FADE_IN_MS = 1000;
   static const int MUSIC_FADE_OUT_MS = 1000;
+  static char const *const DEFAULT_ASSET_ARCHIVE = "assets.pak";
 
   class Scene;
   class Renderer;
+  class Texture;
+  class PreloadManifest;
+  class PreloadListener;
+
+  namespace util
+  {
+    class AssetArchive;
+  }
+
+  /**
+   * Audio device parameters, given to Game::init. The buffer size sets the mixing latency, bufferSize / frequency
+   * seconds on top of the device's own; smaller buffers answer sooner but need the mixer to keep up, watch
+   * MusicPlayer::getUnderrunCount when lowering it. tests/bench/AudioLatencyBenchmark.cpp measures a configuration.
+   */
+  struct AudioSettings
+  {
+    int     frequency;    // output samples per second
+    Uint16  format;       // SDL audio format of the output samples
+    int     channels;     // output channels, 2 for stereo
+    int     bufferSize;   // samples per mixed buffer, a power of two
+    int     voiceCount;   // sounds that can play at once, see SoundMixer
+
+    AudioSettings() :
+    frequency( MIX_DEFAULT_FREQUENCY ),
+    format( MIX_DEFAULT_FORMAT ),
+    channels( MIXER_CHANNELS ),
+    bufferSize( MIXER_CHUNK_SIZE ),
+    voiceCount( DEFAULT_VOICE_COUNT )
+    {
+    }
+
+    /**
+     * Get the duration of a mixed buffer.
+     *
+     * @return buffer duration in milliseconds
+     */
+    double getBufferMs() const
+    {
+      return bufferSize * 1000.0 / frequency;
+    }
+  };
 
   /**
    * This is the Game singleton. It handles the underlying framework initialization and disposal, runs the main game loop,
@@ -84,6 +131,20 @@ namespace cocosdl {
      */
     static bool init( const char *title, const int x, const int y, const int width, const int height, const Uint32 windowFlags );
 
+    /**
+     * Initialize the Game instance.
+     *
+     * @param title window title
+     * @param x window x
+     * @param y window y
+     * @param width window witdth
+     * @param height window height
+     * @param windowFlags (see SDL_Init)
+     * @param audioSettings audio device parameters
+     */
+    static bool init( const char *title, const int x, const int y, const int width, const int height, const Uint32 windowFlags,
+                      const AudioSettings &audioSettings );
+
     /**
      * Quit the game and exit.
      */
@@ -120,6 +181,22 @@ namespace cocosdl {
       return _scene;
     }
 
+    /**
+     * Get the resource manager, owning every texture, font, sound and music loaded by name.
+     */
+    ResourceManager *getResources() const
+    {
+      return _resources;
+    }
+
+    /**
+     * Get the sound mixer, playing sound effects on DEFAULT_VOICE_COUNT voices unless changed.
+     */
+    SoundMixer *getMixer() const
+    {
+      return _mixer;
+    }
+
     /**
      * Set the current scene. You must set a scene or the game will do nothing...<br/>
      * The previous scene is NOT freed, you must free it yourself.
@@ -143,7 +220,8 @@ namespace cocosdl {
     bool loadFont( const std::string &name, const int fontSize );
 
     /**
-     * Get a previously loaded font.
+     * Get a previously loaded font. Unless a handle to it is kept (see ResourceManager), it may be evicted at the end
+     * of the frame if a font budget is set.
      *
      * @param name the font name
      * @param fontSize the font size in points
@@ -160,7 +238,8 @@ namespace cocosdl {
     bool loadMusic( const std::string &name );
 
     /**
-     * Get a previously loaded music item.
+     * Get a previously loaded music item. Unless a handle to it is kept (see ResourceManager), it may be evicted at
+     * the end of the frame if a music budget is set.
      *
      * @param name the file name
      * @return the Mix_Music object, NULL if not loaded
@@ -168,11 +247,11 @@ namespace cocosdl {
     Mix_Music *getMusic( const std::string &name );
 
     /**
-     * Play a background music file. If one was already playing it will be stopped first.<br/>
-     * The music fades in and plays in an infinite loop.
+     * Play a background music file through the music player, opening it in the background if it was not prefetched.
+     * If one was already playing it fades out, and the new one fades in and plays in an infinite loop.
      *
      * @param name the music file name
-     * @return true if the music starts to play, false otherwise
+     * @return true if the music plays or is being opened, failures to open it are logged
      */
     bool playBackgroundMusic( const std::string &name );
 
@@ -183,6 +262,30 @@ namespace cocosdl {
      */
     bool stopBackgroundMusic();
 
+    /**
+     * Get the audio device parameters, as obtained from the device once initialized.
+     */
+    const AudioSettings &getAudioSettings() const
+    {
+      return _audioSettings;
+    }
+
+    /**
+     * Get the music player, streaming the background music.
+     */
+    MusicPlayer *getMusicPlayer() const
+    {
+      return _musicPlayer;
+    }
+
+    /**
+     * Get the collision world, stepped every frame after running the scene actions.
+     */
+    CollisionWorld *getCollisionWorld() const
+    {
+      return _collisionWorld;
+    }
+
     /**
      * Get the sound volume.
      *
@@ -226,7 +329,8 @@ namespace cocosdl {
     bool loadSound( const std::string &name );
 
     /**
-     * Get a previously loaded sound effect.
+     * Get a previously loaded sound effect. Unless a handle to it is kept (see ResourceManager), it may be evicted at
+     * the end of the frame if a sound budget is set.
      *
      * @param sound name
      * @return Mix_Chunk object, NULL if not loaded
@@ -234,13 +338,49 @@ namespace cocosdl {
     Mix_Chunk *getSound( const std::string &name );
 
     /**
-     * Play a sound effect.
+     * Play a sound effect, loading it if it is not resident.
      *
      * @param name the sound effect name
-     * @return the channel the sound is playing on, -1 if not able to play it
+     * @return the voice the sound is playing on, -1 if not able to play it
      */
     int playSound( const std::string &name );
 
+    /**
+     * Play a sound effect through the mixer, without looking it up. Keep the handle of sounds played often.
+     *
+     * @param sound the sound effect
+     * @return the voice the sound is playing on, -1 if not able to play it
+     */
+    int playSound( const SoundHandle &sound );
+
+    /**
+     * Start loading every asset in a manifest at once: files are read and decoded in parallel on the job system
+     * workers, and the results are registered on the game thread as they become ready, so a loading scene can show
+     * the progress while the game runs. Preloaded fonts, sounds and music are then available as if loaded with their
+     * load methods, and preloaded textures through getTexture. The manifest keeps a handle to every asset it loaded.
+     *
+     * @param manifest assets to load, must be kept alive until finished
+     * @param listener optional listener notified of the progress
+     */
+    void preload( PreloadManifest *manifest, PreloadListener *listener = NULL );
+
+    /**
+     * Preload a manifest and wait until it finishes. To be used before calling run.
+     *
+     * @param manifest assets to load
+     * @param listener optional listener notified of the progress
+     * @return true if every asset was loaded
+     */
+    bool preloadAndWait( PreloadManifest *manifest, PreloadListener *listener = NULL );
+
+    /**
+     * Get a resident texture. Sprites created with its file name share it.
+     *
+     * @param fileName resource file name (including extension)
+     * @return the texture, NULL if not resident. It may still be loading.
+     */
+    Texture *getTexture( const std::string &fileName );
+
     /**
      * Get the system current time in milliseconds.
      *
@@ -255,6 +395,34 @@ namespace cocosdl {
      */
     std::string getResourcePath( const std::string &subDir = "" );
 
+    /**
+     * Mount a packed asset archive (see util::AssetArchive) from the resource folder. Resources found in mounted
+     * archives are read from the mapped archive instead of their own files, archives mounted later taking precedence.
+     * DEFAULT_ASSET_ARCHIVE is mounted by init when present. Mount archives before loading anything from them.
+     *
+     * @param fileName archive file name (including extension)
+     * @return true if the archive was mounted
+     */
+    bool mountArchive( const std::string &fileName );
+
+    /**
+     * Open a resource for reading, from a mounted archive if it is packed, or from its file otherwise. Safe to call
+     * from any thread.
+     *
+     * @param fileName resource file name (including extension)
+     * @return an SDL_RWops to be closed by the caller, or NULL if the resource can't be opened
+     */
+    SDL_RWops *openResource( const std::string &fileName );
+
+    /**
+     * Get the data of a resource packed in a mounted archive. Safe to call from any thread.
+     *
+     * @param fileName resource file name (including extension)
+     * @param size filled with the resource size in bytes
+     * @return the resource data, valid as long as the game, or NULL if it is not packed
+     */
+    const void *getArchivedResource( const std::string &fileName, size_t &size );
+
     /**
      * Stop the game.
      */
@@ -274,10 +442,12 @@ namespace cocosdl {
     Scene         *_scene;
     bool          _running;
 
-    std::map<std::string, TTF_Font *> _fonts;
-    std::map<std::string, Mix_Music *> _music;
-    std::map<std::string, Mix_Chunk *> _sounds;
-    std::string _backgroundMusicPlaying;
+    ResourceManager *_resources;
+    SoundMixer *_mixer;
+    MusicPlayer *_musicPlayer;
+    CollisionWorld *_collisionWorld;
+    std::vector<util::AssetArchive *> _archives;
+    AudioSettings _audioSettings;
     float _soundVolume;
     float _musicVolume;
 
@@ -29,7 +29,6 @@ namespace cocosdl {
 
   Label::Label( const string &text ) :
   _text( text ),
-  _font( NULL ),
   _color( _defaultColor ),
   _fontName( _defaultFont ),
   _fontSize( _defaultFontSize ),
@@ -41,7 +40,6 @@ namespace cocosdl {
 
   Label::Label( const string &fontName, const int fontSize, const string &text ) :
   _text( text ),
-  _font( NULL ),
   _color( _defaultColor ),
   _fontName( fontName ),
   _fontSize( fontSize ),
@@ -61,7 +59,11 @@ namespace cocosdl {
   _fontSize( other._fontSize ),
   _initialFontSize( other._initialFontSize )
   {
-    updateTexture();
+    // the rendered text is shared with the other label until either changes it
+    if( !_texture )
+    {
+      updateTexture();
+    }
   }
 
   Label::~Label()
@@ -77,7 +79,10 @@ namespace cocosdl {
     _fontSize = other._fontSize;
     _initialFontSize = other._initialFontSize;
     _fontName = other._fontName;
-    updateTexture();
+    if( !_texture )
+    {
+      updateTexture();
+    }
     return *this;
   }
 
@@ -91,9 +96,7 @@ namespace cocosdl {
   {
     _fontName = fontName;
     _fontSize = fontSize;
-    Game *game = Game::getInstance();
-    game->loadFont( fontName, fontSize );
-    _font = game->getFont( fontName, fontSize );
+    _font = Game::getInstance()->getResources()->loadFont( fontName, fontSize );
     updateTexture();
   }
 
@@ -105,13 +108,12 @@ namespace cocosdl {
 
   void Label::updateTexture()
   {
-    if( _font )
+    if( _font.isValid() )
     {
-      SDL_Surface *surface = TTF_RenderText_Blended( _font, _text.c_str(), _color.getSDL_Color() );
+      SDL_Surface *surface = TTF_RenderText_Blended( _font.get(), _text.c_str(), _color.getSDL_Color() );
       if( surface )
       {
-        setTexture( new Texture( SDL_CreateTextureFromSurface( Game::getInstance()->getRenderer()->getSDL_Renderer(), surface ) ) );
-        _cleanTexture = true;
+        setOwnedTexture( new Texture( SDL_CreateTextureFromSurface( Game::getInstance()->getRenderer()->getSDL_Renderer(), surface ) ) );
         SDL_FreeSurface( surface );
       }
     }
@@ -235,7 +235,7 @@ namespace cocosdl {
     static Color        _defaultColor;
 
     std::string         _text;
-    TTF_Font            *_font;
+    FontHandle          _font;
     Color               _color;
     std::string         _fontName;
     int                 _fontSize;
@@ -0,0 +1,293 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <math.h>
+#include "MusicPlayer.h"
+#include "SoundMixer.h"
+#include "Game.h"
+#include "JobSystem.h"
+#include "Log.h"
+
+using namespace std;
+
+namespace cocosdl {
+
+  MusicPlayer::MusicPlayer( SoundMixer *mixer ) :
+  _mixer( mixer ),
+  _nextRequested( false ),
+  _phase( Idle ),
+  _phaseStart( 0 ),
+  _phaseDuration( 0 ),
+  _curve( EqualPowerFade ),
+  _fadeOutMs( 0 ),
+  _fadeInMs( 0 ),
+  _gain( 1.0f ),
+  _fadeOutFrom( 1.0f ),
+  _time( 0 ),
+  _requestCount( 0 ),
+  _prefetchMissCount( 0 ),
+  _started( false ),
+  _bytesPerSecond( 0 ),
+  _underrunCount( 0 ),
+  _lastMixCounter( 0 )
+  {
+  }
+
+  MusicPlayer::~MusicPlayer()
+  {
+    if( _started )
+    {
+      Mix_SetPostMix( NULL, NULL );
+    }
+  }
+
+  void MusicPlayer::start()
+  {
+    int frequency, channels;
+    Uint16 format;
+    if( Mix_QuerySpec( &frequency, &format, &channels ) == 0 )
+    {
+      return;
+    }
+    _bytesPerSecond = (Uint64) frequency * channels * ( SDL_AUDIO_BITSIZE( format ) / 8 );
+    Mix_SetPostMix( &MusicPlayer::postMix, this );
+    _started = true;
+  }
+
+  void MusicPlayer::prefetch( const string &name )
+  {
+    if( _nextRequested || name == _next.name )
+    {
+      return;
+    }
+    _next = Track();
+    _next.name = name;
+    _next.music = Game::getInstance()->getResources()->findMusic( name );
+    if( !_next.music.isValid() )
+    {
+      open( name );
+    }
+  }
+
+  void MusicPlayer::play( const string &name, const long long fadeMs, const FadeCurve curve )
+  {
+    bool playing = _phase == Playing || _phase == FadingIn;
+    if( name == _current.name && playing )
+    {
+      // cancels a pending switch
+      _nextRequested = false;
+      return;
+    }
+    if( name == _next.name && _nextRequested )
+    {
+      return;
+    }
+    if( name != _next.name )
+    {
+      _nextRequested = false;
+      prefetch( name );
+    }
+    if( _next.opening )
+    {
+      _prefetchMissCount++;
+    }
+    _nextRequested = true;
+    _curve = curve;
+    _fadeOutMs = playing ? fadeMs / 2 : 0;
+    _fadeInMs = playing ? fadeMs - fadeMs / 2 : fadeMs;
+  }
+
+  bool MusicPlayer::stop( const long long fadeMs, const FadeCurve curve )
+  {
+    bool playing = _phase != Idle;
+    _next = Track();
+    _nextRequested = playing;
+    _curve = curve;
+    _fadeOutMs = fadeMs;
+    _fadeInMs = 0;
+    return playing;
+  }
+
+  const string &MusicPlayer::getTrack() const
+  {
+    return _nextRequested ? _next.name : _current.name;
+  }
+
+  bool MusicPlayer::isReady( const string &name ) const
+  {
+    if( name == _current.name && _current.music.isValid() )
+    {
+      return true;
+    }
+    return name == _next.name && _next.music.isValid();
+  }
+
+  void MusicPlayer::update( const long long timeMs )
+  {
+    _time = timeMs;
+    if( _nextRequested && !_next.opening && _phase != FadingOut )
+    {
+      beginTransition();
+    }
+    if( _phase == FadingOut || _phase == FadingIn )
+    {
+      float position = _phaseDuration > 0 ? (float) ( timeMs - _phaseStart ) / _phaseDuration : 1.0f;
+      if( position > 1.0f )
+      {
+        position = 1.0f;
+      }
+      if( _phase == FadingOut )
+      {
+        setGain( _fadeOutFrom * getGain( _curve, 1.0f - position ) );
+        if( position >= 1.0f && _nextRequested && _next.opening )
+        {
+          // the next track was asked for during the fade, wait for it in silence and start it once open
+          Mix_HaltMusic();
+          _current = Track();
+          setPhase( Idle, 0 );
+        }
+        else if( position >= 1.0f )
+        {
+          startNext();
+        }
+      }
+      else
+      {
+        setGain( getGain( _curve, position ) );
+        if( position >= 1.0f )
+        {
+          setPhase( Playing, 0 );
+        }
+      }
+    }
+  }
+
+  void MusicPlayer::open( const string &name )
+  {
+    Uint32 request = ++_requestCount;
+    _next.opening = true;
+    _next.request = request;
+    util::JobSystem::getInstance()->runAsync( [this, name, request]()
+    {
+      SDL_RWops *rw = Game::getInstance()->openResource( name + ".mp3" );
+      Sint64 size = rw ? SDL_RWsize( rw ) : 0;
+      // only the headers are read here, the mixer streams the rest on the audio thread
+      Mix_Music *music = rw ? Mix_LoadMUS_RW( rw, 1 ) : NULL;
+      util::JobSystem::getInstance()->runOnMainThread( [this, name, request, music, size]()
+      {
+        opened( name, request, music, size > 0 ? (size_t) size : 0 );
+      } );
+    } );
+  }
+
+  void MusicPlayer::opened( const string &name, const Uint32 request, Mix_Music *music, const size_t bytes )
+  {
+    // resident from now on even if no longer wanted, as if loaded by name
+    MusicHandle handle = Game::getInstance()->getResources()->addMusic( name, music, bytes );
+    if( !_next.opening || _next.request != request )
+    {
+      return;
+    }
+    _next.opening = false;
+    _next.music = handle;
+    if( !handle.isValid() )
+    {
+      Log::error() << "[MusicPlayer] Can't open music " << name << std::endl;
+      _next = Track();
+      _nextRequested = false;
+    }
+  }
+
+  void MusicPlayer::beginTransition()
+  {
+    if( _phase == Idle || !Mix_PlayingMusic() )
+    {
+      startNext();
+    }
+    else
+    {
+      _fadeOutFrom = _gain;
+      setPhase( FadingOut, _fadeOutMs );
+    }
+  }
+
+  void MusicPlayer::startNext()
+  {
+    _nextRequested = false;
+    _current = _next;
+    _next = Track();
+    if( _current.music.isValid() )
+    {
+      setGain( 0.0f );
+      if( Mix_PlayMusic( _current.music.get(), -1 ) == 0 )
+      {
+        setPhase( FadingIn, _fadeInMs );
+        return;
+      }
+      Log::error() << "[MusicPlayer] Can't play music " << _current.name << ": " << Mix_GetError() << std::endl;
+    }
+    Mix_HaltMusic();
+    _current = Track();
+    setGain( 1.0f );
+    setPhase( Idle, 0 );
+  }
+
+  void MusicPlayer::setPhase( const Phase phase, const long long duration )
+  {
+    _phase = phase;
+    _phaseStart = _time;
+    _phaseDuration = duration;
+  }
+
+  void MusicPlayer::setGain( const float gain )
+  {
+    _gain = gain;
+    _mixer->setMusicGain( gain );
+  }
+
+  float MusicPlayer::getGain( const FadeCurve curve, const float position )
+  {
+    switch( curve )
+    {
+      case EqualPowerFade:
+        return (float) sin( position * M_PI / 2.0 );
+
+      case SmoothFade:
+        return position * position * ( 3.0f - 2.0f * position );
+
+      default:
+        return position;
+    }
+  }
+
+  void MusicPlayer::postMix( void *player, Uint8 *stream, int length )
+  {
+    // runs on the audio thread for every mixed buffer, which is late if it comes after the previous one was played
+    MusicPlayer *self = static_cast<MusicPlayer *>( player );
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 last = self->_lastMixCounter.exchange( now );
+    if( last != 0 && length > 0 )
+    {
+      Uint64 bufferTicks = (Uint64) length * SDL_GetPerformanceFrequency() / self->_bytesPerSecond;
+      // the device keeps a second buffer queued, so only a gap over two buffers left it without data
+      if( now - last > 2 * bufferTicks )
+      {
+        self->_underrunCount++;
+      }
+    }
+  }
+
+}
@@ -0,0 +1,194 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __MusicPlayer_H_
+#define __MusicPlayer_H_
+
+#include <atomic>
+#include <string>
+#include <stddef.h>
+#include <SDL2/SDL.h>
+#include <SDL2_mixer/SDL_mixer.h>
+#include "ResourceManager.h"
+
+namespace cocosdl {
+
+  class SoundMixer;
+
+  /**
+   * Gain curves for music transitions.
+   */
+  enum FadeCurve
+  {
+    LinearFade,       // constant rate
+    EqualPowerFade,   // sine and cosine, keeps the perceived loudness of the transition even
+    SmoothFade        // eases in and out of the transition
+  };
+
+  /**
+   * Streams the background music. Tracks are opened from the resource folder or a mounted archive on the job system
+   * workers, so the game thread never reads music files; the next track can be prefetched before it is needed, and
+   * tracks are switched with a fade following one of the FadeCurve curves.<br/>
+   * SDL_mixer streams a single music track at a time: the playing track fades out over the first half of the
+   * transition, and the next one starts already open and fades in over the second half.<br/>
+   * The player also counts audio buffer underruns, detected when the mixer runs late for the audio device.<br/>
+   * The player belongs to the Game (see Game::getMusicPlayer), and must only be used from the game thread.
+   *
+   * @author narciso.cerezo@gmail.com
+   * @version 1.0
+   */
+  class MusicPlayer
+  {
+
+  public:
+    MusicPlayer( SoundMixer *mixer );
+
+    virtual ~MusicPlayer();
+
+    /**
+     * Start counting underruns. Called by the game once the audio device is open.
+     */
+    void start();
+
+    /**
+     * Open a track in the background, so that playing it later starts without waiting. It replaces the track
+     * previously prefetched, unless that one is waiting to be played.
+     *
+     * @param name music file name, not including the .mp3 extension
+     */
+    void prefetch( const std::string &name );
+
+    /**
+     * Switch to a track, looping it. If it is not open yet, the current track keeps playing until it is.
+     *
+     * @param name music file name, not including the .mp3 extension
+     * @param fadeMs duration of the transition in milliseconds
+     * @param curve gain curve of the transition
+     */
+    void play( const std::string &name, const long long fadeMs, const FadeCurve curve = EqualPowerFade );
+
+    /**
+     * Fade out and stop the music.
+     *
+     * @param fadeMs fade duration in milliseconds
+     * @param curve gain curve of the fade
+     * @return true if some music was playing
+     */
+    bool stop( const long long fadeMs, const FadeCurve curve = EqualPowerFade );
+
+    /**
+     * Get the name of the track playing, or to be played once open.
+     *
+     * @return track name, empty if none
+     */
+    const std::string &getTrack() const;
+
+    /**
+     * Check if a track is open and ready to play.
+     *
+     * @param name music file name
+     * @return true if ready
+     */
+    bool isReady( const std::string &name ) const;
+
+    /**
+     * Advance the transitions and start tracks opened in the background. Called by the game once per frame.
+     *
+     * @param timeMs current engine time in milliseconds
+     */
+    void update( const long long timeMs );
+
+    /**
+     * Get the number of times the audio device ran out of mixed data since start.
+     */
+    size_t getUnderrunCount() const
+    {
+      return _underrunCount;
+    }
+
+    /**
+     * Get the number of tracks that were not prefetched when asked to play, and had to be waited for.
+     */
+    size_t getPrefetchMissCount() const
+    {
+      return _prefetchMissCount;
+    }
+
+  private:
+    enum Phase
+    {
+      Idle,
+      FadingOut,
+      FadingIn,
+      Playing
+    };
+
+    struct Track
+    {
+      std::string name;
+      MusicHandle music;
+      bool        opening;
+      Uint32      request;  // identifies the background open in progress
+
+      Track() : opening( false ), request( 0 )
+      {
+      }
+    };
+
+    SoundMixer          *_mixer;
+    Track               _current;
+    Track               _next;
+    bool                _nextRequested;   // _next is to be played as soon as it is open
+    Phase               _phase;
+    long long           _phaseStart;
+    long long           _phaseDuration;
+    FadeCurve           _curve;
+    long long           _fadeOutMs;
+    long long           _fadeInMs;
+    float               _gain;
+    float               _fadeOutFrom;     // gain when the fade out started
+    long long           _time;
+    Uint32              _requestCount;
+    size_t              _prefetchMissCount;
+    bool                _started;
+    Uint64              _bytesPerSecond;  // of the mixed output
+    std::atomic<size_t> _underrunCount;
+    std::atomic<Uint64> _lastMixCounter;
+
+    MusicPlayer( const MusicPlayer &other );
+
+    MusicPlayer &operator = ( const MusicPlayer &other );
+
+    void open( const std::string &name );
+
+    void opened( const std::string &name, const Uint32 request, Mix_Music *music, const size_t bytes );
+
+    void beginTransition();
+
+    void startNext();
+
+    void setPhase( const Phase phase, const long long duration );
+
+    void setGain( const float gain );
+
+    static float getGain( const FadeCurve curve, const float position );
+
+    static void postMix( void *player, Uint8 *stream, int length );
+  };
+
+}
+
+#endif //__MusicPlayer_H_
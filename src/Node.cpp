@@ -14,16 +14,55 @@
    limitations under the License.
 */
 
+#include <algorithm>
+#include <limits.h>
+#include <math.h>
 #include "Node.h"
 #include "Game.h"
 #include "Rect.h"
 #include "Renderer.h"
+#include "ActionEventQueue.h"
+#include "JobSystem.h"
+#include "SpatialGrid.h"
+#include "CollisionWorld.h"
+#include "NodeIndex.h"
+#include "NodeArena.h"
+#include "BlockPool.h"
+#include "BitmapCache.h"
 
 using namespace std;
 using namespace cocosdl::action;
+using namespace cocosdl::util;
 
 namespace cocosdl {
 
+  static const size_t DEFAULT_PARALLEL_ACTION_THRESHOLD = 2048;
+
+  // nodes per chunk handed to each worker, small enough to balance uneven action costs
+  static const size_t PARALLEL_ACTION_GRAIN = 256;
+
+  static size_t _parallelActionThreshold = DEFAULT_PARALLEL_ACTION_THRESHOLD;
+  static bool _eagerInheritance = false;
+
+  // set while actions run on the workers, spatial grids are only updated from the game thread
+  static bool _deferSpatialIndex = false;
+
+  // set while the game thread applies the actions collected for a parallel run, the collected nodes must outlive it
+  static bool _deferChildDeletion = false;
+  static bool _childrenRemoved = false;
+  static vector<Node *> _deletedChildren;
+
+  // each block starts with the arena it belongs to, NULL for the shared pools, padded to keep nodes aligned
+  static const size_t NODE_HEADER_SIZE = sizeof( long double ) > sizeof( NodeArena * ) ? sizeof( long double ) :
+                                         sizeof( NodeArena * );
+  size_t Node::_bitmapCacheCount = 0;
+  size_t Node::_spatialGridCount = 0;
+  int Node::_drawOffsetX = 0;
+  int Node::_drawOffsetY = 0;
+
+  static vector<Node *> _actionNodes;
+  static vector<char> _concurrentActionNodes;
+
   Node::Node() :
   _anchorX( 0.5f ),
   _anchorY( 0.5f ),
@@ -35,7 +74,19 @@ namespace cocosdl {
   _rotationAngle( 0.0 ),
   _clipping( false ),
   _parent( NULL ),
-  _name( "" )
+  _drawOpacity( 1.0f ),
+  _drawRotationAngle( 0.0 ),
+  _childWidthDelta( 0 ),
+  _childHeightDelta( 0 ),
+  _name(),
+  _tag( NO_TAG ),
+  _childIndex( NodeVector::NO_INDEX ),
+  _zOrder( 0 ),
+  _spatialGrid( NULL ),
+  _spatialIndexPending( false ),
+  _collisionWorld( NULL ),
+  _nameIndex( NULL ),
+  _bitmapCache( NULL )
   {
   }
 
@@ -50,7 +101,19 @@ namespace cocosdl {
   _rotationAngle( 0.0 ),
   _clipping( false ),
   _parent( NULL ),
-  _name( name )
+  _drawOpacity( 1.0f ),
+  _drawRotationAngle( 0.0 ),
+  _childWidthDelta( 0 ),
+  _childHeightDelta( 0 ),
+  _name( name ),
+  _tag( NO_TAG ),
+  _childIndex( NodeVector::NO_INDEX ),
+  _zOrder( 0 ),
+  _spatialGrid( NULL ),
+  _spatialIndexPending( false ),
+  _collisionWorld( NULL ),
+  _nameIndex( NULL ),
+  _bitmapCache( NULL )
   {
 
   }
@@ -67,20 +130,41 @@ namespace cocosdl {
   _rotationAngle( other._rotationAngle ),
   _clipping( other._clipping ),
   _parent( NULL ),
-  _name( std::string( other._name ) )
+  _drawOpacity( other._opacity ),
+  _drawRotationAngle( other._rotationAngle ),
+  _childWidthDelta( other._childWidthDelta ),
+  _childHeightDelta( other._childHeightDelta ),
+  _name( other._name ),
+  _tag( other._tag ),
+  _childIndex( NodeVector::NO_INDEX ),
+  _zOrder( other._zOrder ),
+  _spatialGrid( other._spatialGrid ? new SpatialGrid( other._spatialGrid->getCellSize() ) : NULL ),
+  _spatialIndexPending( false ),
+  _collisionWorld( NULL ),
+  _nameIndex( other._nameIndex ? new NodeIndex() : NULL ),
+  _bitmapCache( NULL )
   {
+    if( _spatialGrid )
+    {
+      _spatialGridCount++;
+    }
+    setCacheAsBitmap( other._bitmapCache != NULL );
     size_t count = other._children.size();
     for( size_t i = 0; i < count; i++ )
     {
       Node *child = other._children.at( i );
-      addChild( child->copy() );
+      if( child )
+      {
+        addChild( child->copy() );
+      }
     }
   }
 
   Node &Node::operator = ( const Node &other )
   {
     removeAll();
-    _name = std::string( other._name );
+    setName( other._name );
+    setTag( other._tag );
     _anchorX = other._anchorX;
     _anchorY = other._anchorY;
     _x = other._x;
@@ -89,7 +173,14 @@ namespace cocosdl {
     _height = other._height;
     _opacity = other._opacity;
     _rotationAngle = other._rotationAngle;
+    _childWidthDelta = other._childWidthDelta;
+    _childHeightDelta = other._childHeightDelta;
     _clipping = other._clipping;
+    _zOrder = other._zOrder;
+    setSpatialIndex( other._spatialGrid ? other._spatialGrid->getCellSize() : 0 );
+    setNameIndex( other._nameIndex != NULL );
+    setCacheAsBitmap( other._bitmapCache != NULL );
+    contentChanged();
     if( _parent )
     {
       _parent->removeChild( this, false );
@@ -99,18 +190,79 @@ namespace cocosdl {
     for( size_t i = 0; i < count; i++ )
     {
       Node *child = other._children.at( i );
-      addChild( child->copy() );
+      if( child )
+      {
+        addChild( child->copy() );
+      }
     }
     return *this;
   }
 
+  void *Node::operator new( size_t size )
+  {
+    NodeArena *arena = NodeArena::getCurrent();
+    size_t blockSize = size + NODE_HEADER_SIZE;
+    char *block = static_cast<char *>( arena ? arena->allocate( blockSize ) : BlockPool::allocateSized( blockSize ) );
+    *reinterpret_cast<NodeArena **>( block ) = arena;
+    return block + NODE_HEADER_SIZE;
+  }
+
+  void Node::operator delete( void *node, size_t size )
+  {
+    if( !node )
+    {
+      return;
+    }
+    char *block = static_cast<char *>( node ) - NODE_HEADER_SIZE;
+    NodeArena *arena = *reinterpret_cast<NodeArena **>( block );
+    if( arena )
+    {
+      arena->deallocate( block, size + NODE_HEADER_SIZE );
+    }
+    else
+    {
+      BlockPool::deallocateSized( block, size + NODE_HEADER_SIZE );
+    }
+  }
+
   Node::~Node()
   {
-    removeAll();
+    if( _collisionWorld )
+    {
+      _collisionWorld->removeBody( this );
+    }
+    // a deleted node is already out of any index above, the parent may even be gone
+    delete _nameIndex;
+    _nameIndex = NULL;
+    ActionEventQueue::forget( this );
+    deleteChildren();
+    setSpatialIndex( 0 );
+    setCacheAsBitmap( false );
   }
 
   void Node::removeAll()
   {
+    NodeIndex *index = findNameIndex();
+    if( index )
+    {
+      _children.compact();
+      size_t count = _children.size();
+      for( size_t i = 0; i < count; i++ )
+      {
+        unindexChild( index, _children[i] );
+      }
+    }
+    deleteChildren();
+    contentChanged();
+  }
+
+  void Node::deleteChildren()
+  {
+    if( _spatialGrid )
+    {
+      _spatialGrid->clear();
+    }
+    _children.compact();
     while( _children.size() > 0 )
     {
       Node *child = _children.back();
@@ -125,29 +277,56 @@ namespace cocosdl {
     {
       _children.push( node );
       node->_parent = this;
+      if( _spatialGrid )
+      {
+        indexChild( node );
+      }
+      NodeIndex *index = findNameIndex();
+      if( index )
+      {
+        index->add( node );
+        if( !node->_nameIndex )
+        {
+          node->indexTree( index, true );
+        }
+      }
+      contentChanged();
     }
   }
 
   void Node::insertChild( const unsigned position, Node *node )
   {
-    if( !node )
+    if( node )
     {
-      return;
+      _children.insert( position, node );
+      node->_parent = this;
+      if( _spatialGrid )
+      {
+        indexChild( node );
+      }
+      NodeIndex *index = findNameIndex();
+      if( index )
+      {
+        index->add( node );
+        if( !node->_nameIndex )
+        {
+          node->indexTree( index, true );
+        }
+      }
+      contentChanged();
     }
+  }
 
-    if( position >= _children.size() )
-    {
-      addChild( node );
-    }
-    else
+  void Node::setZOrder( const int zOrder )
+  {
+    if( zOrder != _zOrder )
     {
-      vector<Node *>::iterator pos = _children.begin();
-      if( position > 0 )
+      _zOrder = zOrder;
+      if( _parent )
       {
-        advance( pos, position );
+        _parent->_children.invalidateOrder();
+        _parent->contentChanged();
       }
-      _children.insert( pos, node );
-      node->_parent = this;
     }
   }
 
@@ -158,26 +337,71 @@ namespace cocosdl {
       return;
     }
 
+    NodeIndex *index = findNameIndex();
+    if( index && _children.contains( node ) )
+    {
+      unindexChild( index, node );
+    }
     _children.remove( node );
+    if( _spatialGrid )
+    {
+      _spatialGrid->remove( node );
+    }
+    contentChanged();
+    if( _deferChildDeletion )
+    {
+      _childrenRemoved = true;
+    }
     if( cleanUp )
     {
-      delete node;
+      if( _deferChildDeletion )
+      {
+        _deletedChildren.push_back( node );
+      }
+      else
+      {
+        delete node;
+      }
     }
   }
 
   void Node::getDestinationRect( Rect &rect ) const
   {
-    rect.setOrigin( getScreenX(), getScreenY() );
-    rect.setDimension( _width, _height );
+    int x, y, widthDelta, heightDelta;
+    getScreenOrigin( x, y, widthDelta, heightDelta );
+    rect.setOrigin( x, y );
+    rect.setDimension( _width + widthDelta, _height + heightDelta );
   }
 
   void Node::draw() const
   {
+    // the parent composed its own values just before drawing its children
+    if( _parent && !_eagerInheritance )
+    {
+      _drawOpacity = _parent->_drawOpacity * _opacity;
+      _drawRotationAngle = _parent->_drawRotationAngle + _rotationAngle;
+    }
+    else
+    {
+      _drawOpacity = _opacity;
+      _drawRotationAngle = _rotationAngle;
+    }
+
+    if( _bitmapCache && _bitmapCache->draw( *this ) )
+    {
+      return;
+    }
+    drawNode();
+  }
 
+  void Node::drawNode() const
+  {
     Rect destinationRect;
     Rect currentClippingRect;
 
     getDestinationRect( destinationRect );
+    // relative to the bitmap cache being rendered, if any
+    destinationRect.setOrigin( destinationRect.getX() - _drawOffsetX, destinationRect.getY() - _drawOffsetY );
 
     Renderer *renderer = Game::getInstance()->getRenderer();
     if( _clipping )
@@ -188,11 +412,16 @@ namespace cocosdl {
 
     drawBeforeChildren( destinationRect );
 
+    _children.sort();
+
     size_t count = _children.size();
     for( size_t i = 0; i < count; i++ )
     {
       Node *child = _children.at( i );
-      child->draw();
+      if( child )
+      {
+        child->draw();
+      }
     }
 
     drawAfterChildren( destinationRect );
@@ -206,7 +435,28 @@ namespace cocosdl {
   void Node::setOpacity( const float opacity )
   {
     float correctedOpacity = opacity < 0.0f ? 0.0f : opacity > 1.0f ? 1.0f : opacity;
+    if( !_eagerInheritance )
+    {
+      _opacity = correctedOpacity;
+      // a cache of the node itself is drawn with the new opacity
+      if( _parent )
+      {
+        _parent->contentChanged();
+      }
+      return;
+    }
     blendOpacity( _opacity != 0 ? correctedOpacity / _opacity : correctedOpacity );
+    contentChanged();
+  }
+
+  float Node::getEffectiveOpacity() const
+  {
+    float opacity = _opacity;
+    for( const Node *node = _parent; node && !_eagerInheritance; node = node->_parent )
+    {
+      opacity *= node->_opacity;
+    }
+    return opacity;
   }
 
   void Node::blendOpacity( const float factor )
@@ -219,22 +469,147 @@ namespace cocosdl {
     {
       _opacity = factor;
     }
+    if( _bitmapCache )
+    {
+      _bitmapCache->invalidate();
+    }
     size_t count = _children.size();
     for( size_t i = 0; i < count; i++ )
     {
       Node *child = _children.at( i );
-      child->blendOpacity( factor );
+      if( child )
+      {
+        child->blendOpacity( factor );
+      }
     }
   }
 
   void Node::setRotationAngle( const double rotationAngle )
   {
     _rotationAngle = rotationAngle;
+    contentChanged();
+    if( !_eagerInheritance )
+    {
+      return;
+    }
     size_t count = _children.size();
     for( size_t i = 0; i < count; i++ )
     {
       Node *child = _children.at( i );
-      child->setRotationAngle( rotationAngle );
+      if( child )
+      {
+        child->setRotationAngle( rotationAngle );
+      }
+    }
+  }
+
+  double Node::getEffectiveRotationAngle() const
+  {
+    double rotationAngle = _rotationAngle;
+    for( const Node *node = _parent; node && !_eagerInheritance; node = node->_parent )
+    {
+      rotationAngle += node->_rotationAngle;
+    }
+    return rotationAngle;
+  }
+
+  int Node::getEffectiveWidth() const
+  {
+    int widthDelta, heightDelta;
+    getInheritedDelta( widthDelta, heightDelta );
+    return _width + widthDelta;
+  }
+
+  int Node::getEffectiveHeight() const
+  {
+    int widthDelta, heightDelta;
+    getInheritedDelta( widthDelta, heightDelta );
+    return _height + heightDelta;
+  }
+
+  void Node::setCacheAsBitmap( const bool enabled )
+  {
+    if( enabled && !_bitmapCache )
+    {
+      _bitmapCache = new BitmapCache();
+      _bitmapCacheCount++;
+    }
+    else if( !enabled && _bitmapCache )
+    {
+      delete _bitmapCache;
+      _bitmapCache = NULL;
+      _bitmapCacheCount--;
+    }
+  }
+
+  void Node::invalidateBitmapCaches() const
+  {
+    for( const Node *node = this; node; node = node->_parent )
+    {
+      // a cache already invalidated had the ones above invalidated along with it
+      if( node->_bitmapCache && !node->_bitmapCache->invalidate() )
+      {
+        return;
+      }
+    }
+  }
+
+  bool Node::getTreeBounds( int &left, int &top, int &right, int &bottom ) const
+  {
+    left = top = INT_MAX;
+    right = bottom = INT_MIN;
+    addTreeBounds( left, top, right, bottom, _drawRotationAngle );
+    return left < right && top < bottom;
+  }
+
+  void Node::addTreeBounds( int &left, int &top, int &right, int &bottom, const double rotationAngle ) const
+  {
+    Rect rect;
+    getDestinationRect( rect );
+    if( rect.getWidth() > 0 && rect.getHeight() > 0 )
+    {
+      double rectLeft = rect.getX();
+      double rectTop = rect.getY();
+      double rectRight = rect.getX() + rect.getWidth();
+      double rectBottom = rect.getY() + rect.getHeight();
+      if( rotationAngle != 0.0 )
+      {
+        // bounding box of the rectangle rotated around the anchor, as drawn
+        double radians = rotationAngle * M_PI / 180.0;
+        double cosine = fabs( cos( radians ) );
+        double sine = fabs( sin( radians ) );
+        double pivotX = rectLeft + _anchorX * rect.getWidth();
+        double pivotY = rectTop + _anchorY * rect.getHeight();
+        double leftExtent = pivotX - rectLeft;
+        double rightExtent = rectRight - pivotX;
+        double topExtent = pivotY - rectTop;
+        double bottomExtent = rectBottom - pivotY;
+        double halfWidth = ( leftExtent > rightExtent ? leftExtent : rightExtent );
+        double halfHeight = ( topExtent > bottomExtent ? topExtent : bottomExtent );
+        double extentX = halfWidth * cosine + halfHeight * sine;
+        double extentY = halfWidth * sine + halfHeight * cosine;
+        rectLeft = pivotX - extentX;
+        rectRight = pivotX + extentX;
+        rectTop = pivotY - extentY;
+        rectBottom = pivotY + extentY;
+      }
+      // a pixel of margin for the rounding of rotated drawing
+      int margin = rotationAngle != 0.0 ? 1 : 0;
+      left = std::min( left, (int) floor( rectLeft ) - margin );
+      top = std::min( top, (int) floor( rectTop ) - margin );
+      right = std::max( right, (int) ceil( rectRight ) + margin );
+      bottom = std::max( bottom, (int) ceil( rectBottom ) + margin );
+    }
+
+    size_t count = _children.size();
+    for( size_t i = 0; i < count; i++ )
+    {
+      Node *child = _children.at( i );
+      if( child )
+      {
+        child->addTreeBounds( left, top, right, bottom,
+                              _eagerInheritance ? child->_rotationAngle : rotationAngle + child->_rotationAngle );
+      }
     }
   }
 
@@ -244,6 +619,116 @@ namespace cocosdl {
   }
 
   void Node::runActions()
+  {
+    if( _parallelActionThreshold > 0 )
+    {
+      _actionNodes.clear();
+      collectNodes( _actionNodes );
+      if( _actionNodes.size() >= _parallelActionThreshold )
+      {
+        // on a single core machine there are no workers to share the load with
+        if( JobSystem::getInstance()->getThreadCount() > 0 )
+        {
+          runActionsInParallel( _actionNodes );
+          return;
+        }
+      }
+    }
+    runActionsSerially();
+  }
+
+  void Node::runActionsSerially()
+  {
+    _children.compact();
+    runCurrentAction();
+    size_t count = _children.size();
+    for( size_t i = 0; i < count; i++ )
+    {
+      Node *child = _children.at( i );
+      if( child )
+      {
+        child->runActionsSerially();
+      }
+    }
+    removePendingNodes();
+  }
+
+  void Node::runActionsInParallel( vector<Node *> &nodes )
+  {
+    size_t count = nodes.size();
+    _concurrentActionNodes.assign( count, 0 );
+
+    // evaluate phase: actions that only modify their own node, on every core
+    _deferSpatialIndex = true;
+    JobSystem::getInstance()->parallelFor( count, PARALLEL_ACTION_GRAIN, [&nodes]( size_t begin, size_t end )
+    {
+      for( size_t i = begin; i < end; i++ )
+      {
+        Node *node = nodes[i];
+        if( node->_actions.size() > 0 && node->_actions.front()->isConcurrent() )
+        {
+          _concurrentActionNodes[i] = 1;
+          node->runCurrentAction();
+        }
+      }
+    } );
+    _deferSpatialIndex = false;
+
+    // apply phase: everything else in tree order on this thread, then structural changes bottom up; like the serial
+    // run, nodes removed meanwhile are skipped, and deleted once done
+    _deferChildDeletion = true;
+    _childrenRemoved = false;
+    for( size_t i = 0; i < count; i++ )
+    {
+      Node *node = nodes[i];
+      if( _childrenRemoved && !node->isBelow( this ) )
+      {
+        continue;
+      }
+      if( !_concurrentActionNodes[i] )
+      {
+        node->runCurrentAction();
+      }
+      else if( node->_spatialIndexPending )
+      {
+        node->_spatialIndexPending = false;
+        if( node->_parent && node->_parent->_spatialGrid )
+        {
+          node->_parent->indexChild( node );
+        }
+      }
+    }
+    for( size_t i = count; i > 0; i-- )
+    {
+      Node *node = nodes[i - 1];
+      if( !_childrenRemoved || node->isBelow( this ) )
+      {
+        node->removePendingNodes();
+      }
+    }
+    _deferChildDeletion = false;
+    for( size_t i = 0; i < _deletedChildren.size(); i++ )
+    {
+      delete _deletedChildren[i];
+    }
+    _deletedChildren.clear();
+  }
+
+  bool Node::isBelow( const Node *ancestor ) const
+  {
+    const Node *node = this;
+    while( node != ancestor )
+    {
+      if( !node->_parent || !node->_parent->_children.contains( node ) )
+      {
+        return false;
+      }
+      node = node->_parent;
+    }
+    return true;
+  }
+
+  void Node::runCurrentAction()
   {
     if( _actions.size() > 0 )
     {
@@ -254,23 +739,21 @@ namespace cocosdl {
         if( action->getActionStatus() == Finished )
         {
           _actions.pop();
-          DESTROY_ACTION( action );
+          ActionEventQueue::retire( action );
         }
       }
       else
       {
         _actions.pop();
-        DESTROY_ACTION( action );
+        ActionEventQueue::retire( action );
       }
     }
-    size_t count = _children.size();
-    for( size_t i = 0; i < count; i++ )
-    {
-      Node *child = _children.at( i );
-      child->runActions();
-    }
+  }
+
+  void Node::removePendingNodes()
+  {
     // the RemoveFromParentAction adds the nodes to remove to the _nodesToRemove queue, we have to remove them here
-    // (we can't remove them on the previous loop or it will crash because contents of children will have changed)
+    // (we can't remove them while running actions or it will crash because contents of children will have changed)
     while( _nodesToRemove.size() > 0 )
     {
       Node *node = _nodesToRemove.front();
@@ -279,6 +762,37 @@ namespace cocosdl {
     }
   }
 
+  void Node::collectNodes( vector<Node *> &nodes )
+  {
+    nodes.push_back( this );
+    _children.compact();
+    size_t count = _children.size();
+    for( size_t i = 0; i < count; i++ )
+    {
+      _children.at( i )->collectNodes( nodes );
+    }
+  }
+
+  void Node::setEagerInheritance( const bool eager )
+  {
+    _eagerInheritance = eager;
+  }
+
+  bool Node::isEagerInheritance()
+  {
+    return _eagerInheritance;
+  }
+
+  void Node::setParallelActionThreshold( const size_t threshold )
+  {
+    _parallelActionThreshold = threshold;
+  }
+
+  size_t Node::getParallelActionThreshold()
+  {
+    return _parallelActionThreshold;
+  }
+
   bool Node::hasActions() const
   {
     bool actions = _actions.size() > 0;
@@ -286,7 +800,10 @@ namespace cocosdl {
     for( size_t i = 0; !actions && i < count; i++ )
     {
       Node *child = _children.at( i );
-      actions |= child->hasActions();
+      if( child )
+      {
+        actions |= child->hasActions();
+      }
     }
     return actions;
   }
@@ -297,19 +814,24 @@ namespace cocosdl {
     {
       Action *action = _actions.front();
       _actions.pop();
-      DESTROY_ACTION( action );
+      ActionEventQueue::retire( action );
     }
     size_t count = _children.size();
     for( size_t i = 0; i < count; i++ )
     {
       Node *child = _children.at( i );
-      child->stopAllActions( restoreInitialStatus );
+      if( child )
+      {
+        child->stopAllActions( restoreInitialStatus );
+      }
     }
   }
 
   void Node::getCenter( Point &point ) const
   {
-    point.setLocation( _width / 2, _height / 2 );
+    int widthDelta, heightDelta;
+    getInheritedDelta( widthDelta, heightDelta );
+    point.setLocation( ( _width + widthDelta ) / 2, ( _height + heightDelta ) / 2 );
   }
 
   bool Node::isPointInside( const int absoluteX, const int absoluteY ) const
@@ -337,23 +859,39 @@ namespace cocosdl {
     getDestinationRect( rect );
     if( rect.isPointInside( x, y ) )
     {
-      size_t count = _children.size();
-      for( long i = count - 1; i >= 0; i-- )
+      // topmost first, in the order they are drawn; the children are not sorted here, the caller may be iterating them
+      Node *child = NULL;
+      if( _spatialGrid )
       {
-        Node *child = _children.at( (size_t) i );
-        if( child->isPointInside( x, y ) )
+        vector<Node *> candidates;
+        _spatialGrid->findAt( x - rect.getX(), y - rect.getY(), candidates );
+        for( size_t i = 0; i < candidates.size(); i++ )
         {
-          Node *result = child->getChildAtPoint( x, y );
-          if( result )
+          if( !child || isDrawnBelow( child, candidates[i] ) )
           {
-            return result;
+            child = candidates[i];
           }
-          else
+        }
+      }
+      else
+      {
+        // when sorted the first hit from the top is the topmost one
+        bool sorted = _children.isSorted();
+        size_t count = _children.size();
+        for( long i = count - 1; i >= 0 && !( child && sorted ); i-- )
+        {
+          Node *candidate = _children.at( (size_t) i );
+          if( candidate && candidate->isPointInside( x, y ) && ( !child || isDrawnBelow( child, candidate ) ) )
           {
-            return child;
+            child = candidate;
           }
         }
       }
+      if( child )
+      {
+        Node *result = child->getChildAtPoint( x, y );
+        return result ? result : child;
+      }
       return NULL; // should never get this far
     }
     else
@@ -362,6 +900,287 @@ namespace cocosdl {
     }
   }
 
+  void Node::getChildrenInRect( const Rect &rect, vector<Node *> &nodes ) const
+  {
+    int x = rect.getX() - getScreenX();
+    int y = rect.getY() - getScreenY();
+    size_t first = nodes.size();
+    if( _spatialGrid )
+    {
+      _spatialGrid->findIn( x, y, rect.getWidth(), rect.getHeight(), nodes );
+      sort( nodes.begin() + first, nodes.end(), isDrawnBelow );
+    }
+    else
+    {
+      // what the children inherit, the same for all of them
+      int widthDelta, heightDelta;
+      getInheritedDelta( widthDelta, heightDelta );
+      widthDelta += _childWidthDelta;
+      heightDelta += _childHeightDelta;
+      size_t count = _children.size();
+      for( size_t i = 0; i < count; i++ )
+      {
+        Node *child = _children.at( i );
+        if( child )
+        {
+          int width = child->_width + widthDelta;
+          int height = child->_height + heightDelta;
+          int left = child->_x - (int) ( child->_anchorX * width );
+          int top = child->_y - (int) ( child->_anchorY * height );
+          if( left < x + rect.getWidth() && x < left + width && top < y + rect.getHeight() && y < top + height )
+          {
+            nodes.push_back( child );
+          }
+        }
+      }
+      if( !_children.isSorted() )
+      {
+        stable_sort( nodes.begin() + first, nodes.end(), isDrawnBelow );
+      }
+    }
+  }
+
+  void Node::setSpatialIndex( const int cellSize )
+  {
+    if( _spatialGrid )
+    {
+      delete _spatialGrid;
+      _spatialGrid = NULL;
+      _spatialGridCount--;
+    }
+    if( cellSize > 0 )
+    {
+      _spatialGrid = new SpatialGrid( cellSize );
+      _spatialGridCount++;
+      size_t count = _children.size();
+      for( size_t i = 0; i < count; i++ )
+      {
+        Node *child = _children.at( i );
+        if( child )
+        {
+          indexChild( child );
+        }
+      }
+    }
+  }
+
+  void Node::indexChild( Node *child )
+  {
+    if( _deferSpatialIndex )
+    {
+      // only the worker running the child's actions writes the flag
+      child->_spatialIndexPending = true;
+      return;
+    }
+    // a removed node still points to its former parent
+    if( _children.contains( child ) )
+    {
+      _spatialGrid->update( child, child->translateX( 0 ), child->translateY( 0 ), child->getEffectiveWidth(),
+                            child->getEffectiveHeight() );
+    }
+  }
+
+  void Node::setName( const util::Name &name )
+  {
+    if( name == _name )
+    {
+      return;
+    }
+    NodeIndex *index = isChild() ? _parent->findNameIndex() : NULL;
+    if( index )
+    {
+      index->remove( this );
+    }
+    _name = name;
+    if( index )
+    {
+      index->add( this );
+    }
+  }
+
+  void Node::setTag( const int tag )
+  {
+    if( tag == _tag )
+    {
+      return;
+    }
+    NodeIndex *index = isChild() ? _parent->findNameIndex() : NULL;
+    if( index )
+    {
+      index->remove( this );
+    }
+    _tag = tag;
+    if( index )
+    {
+      index->add( this );
+    }
+  }
+
+  Node *Node::getChildByName( const util::Name &name ) const
+  {
+    if( name.empty() )
+    {
+      return NULL;
+    }
+    NodeIndex *index = findNameIndex();
+    return index ? index->findByName( this, name ) : findChildByName( name );
+  }
+
+  Node *Node::getChildByTag( const int tag ) const
+  {
+    if( tag == NO_TAG )
+    {
+      return NULL;
+    }
+    NodeIndex *index = findNameIndex();
+    if( index )
+    {
+      return index->findByTag( this, tag );
+    }
+    size_t count = _children.size();
+    for( size_t i = 0; i < count; i++ )
+    {
+      Node *child = _children.at( i );
+      if( child && child->_tag == tag )
+      {
+        return child;
+      }
+    }
+    return NULL;
+  }
+
+  Node *Node::getChildByPath( const std::string &path ) const
+  {
+    const Node *node = this;
+    NodeIndex *index = findNameIndex();
+    size_t start = 0;
+    while( node && start < path.size() )
+    {
+      size_t end = path.find( '/', start );
+      if( end == string::npos )
+      {
+        end = path.size();
+      }
+      if( end > start )
+      {
+        // a name never interned is no node's name
+        util::Name name;
+        if( !util::Name::find( path.data() + start, end - start, name ) )
+        {
+          return NULL;
+        }
+        if( node->_nameIndex )
+        {
+          index = node->_nameIndex;
+        }
+        node = index ? index->findByName( node, name ) : node->findChildByName( name );
+      }
+      start = end + 1;
+    }
+    return const_cast<Node *>( node );
+  }
+
+  void Node::setNameIndex( const bool enabled )
+  {
+    if( enabled == ( _nameIndex != NULL ) )
+    {
+      return;
+    }
+    // the tree moves between this index and the one above
+    NodeIndex *outerIndex = isChild() ? _parent->findNameIndex() : NULL;
+    if( enabled )
+    {
+      if( outerIndex )
+      {
+        indexTree( outerIndex, false );
+      }
+      _nameIndex = new NodeIndex();
+      indexTree( _nameIndex, true );
+    }
+    else
+    {
+      delete _nameIndex;
+      _nameIndex = NULL;
+      if( outerIndex )
+      {
+        indexTree( outerIndex, true );
+      }
+    }
+  }
+
+  NodeIndex *Node::findNameIndex() const
+  {
+    for( const Node *node = this; node; node = node->_parent )
+    {
+      if( node->_nameIndex )
+      {
+        return node->_nameIndex;
+      }
+      if( !node->isChild() )
+      {
+        return NULL;
+      }
+    }
+    return NULL;
+  }
+
+  bool Node::isChild() const
+  {
+    return _parent && _parent->_children.contains( this );
+  }
+
+  Node *Node::findChildByName( const util::Name &name ) const
+  {
+    size_t count = _children.size();
+    for( size_t i = 0; i < count; i++ )
+    {
+      Node *child = _children.at( i );
+      if( child && child->_name == name )
+      {
+        return child;
+      }
+    }
+    return NULL;
+  }
+
+  void Node::indexTree( NodeIndex *index, const bool add )
+  {
+    size_t count = _children.size();
+    for( size_t i = 0; i < count; i++ )
+    {
+      Node *child = _children.at( i );
+      if( !child )
+      {
+        continue;
+      }
+      if( add )
+      {
+        index->add( child );
+      }
+      else
+      {
+        index->remove( child );
+      }
+      // a child with its own index covers its tree
+      if( !child->_nameIndex )
+      {
+        child->indexTree( index, add );
+      }
+    }
+  }
+
+  void Node::unindexChild( NodeIndex *index, Node *child )
+  {
+    if( child )
+    {
+      index->remove( child );
+      if( !child->_nameIndex )
+      {
+        child->indexTree( index, false );
+      }
+    }
+  }
+
   void Node::drawBeforeChildren( Rect &destinationRect ) const
   {
 
@@ -374,12 +1193,42 @@ namespace cocosdl {
 
   int Node::getScreenX() const
   {
-    return ( _parent ? _parent->getScreenX() : 0 ) + _x - (int) ( _anchorX * _width );
+    int x, y, widthDelta, heightDelta;
+    getScreenOrigin( x, y, widthDelta, heightDelta );
+    return x;
   }
 
   int Node::getScreenY() const
   {
-    return ( _parent ? _parent->getScreenY() : 0 ) + _y - (int) ( _anchorY * _height );
+    int x, y, widthDelta, heightDelta;
+    getScreenOrigin( x, y, widthDelta, heightDelta );
+    return y;
+  }
+
+  void Node::getScreenOrigin( int &x, int &y, int &widthDelta, int &heightDelta ) const
+  {
+    if( _parent )
+    {
+      _parent->getScreenOrigin( x, y, widthDelta, heightDelta );
+      widthDelta += _parent->_childWidthDelta;
+      heightDelta += _parent->_childHeightDelta;
+    }
+    else
+    {
+      x = y = widthDelta = heightDelta = 0;
+    }
+    x += _x - (int) ( _anchorX * ( _width + widthDelta ) );
+    y += _y - (int) ( _anchorY * ( _height + heightDelta ) );
+  }
+
+  void Node::getInheritedDelta( int &widthDelta, int &heightDelta ) const
+  {
+    widthDelta = heightDelta = 0;
+    for( const Node *node = _parent; node; node = node->_parent )
+    {
+      widthDelta += node->_childWidthDelta;
+      heightDelta += node->_childHeightDelta;
+    }
   }
 
   void Node::addNodeToRemove( Node *node )
@@ -389,30 +1238,62 @@ namespace cocosdl {
 
   int Node::translateX( const int x ) const
   {
-    return _x - (int) ( _anchorX * _width ) + x;
+    return _x - (int) ( _anchorX * getEffectiveWidth() ) + x;
   }
 
   int Node::translateY( const int y ) const
   {
-    return _y - (int) ( _anchorY * _height ) + y;
+    return _y - (int) ( _anchorY * getEffectiveHeight() ) + y;
   }
 
   void Node::setDimension( const int width, const int height )
   {
     _width = width;
     _height = height;
-
+    boundsChanged();
   }
 
   void Node::resizeBy( int widthDelta, int heightDelta )
   {
     _width += widthDelta;
     _height += heightDelta;
+    boundsChanged();
+    if( !_eagerInheritance )
+    {
+      _childWidthDelta += widthDelta;
+      _childHeightDelta += heightDelta;
+      // every descendant keeps its size but not its bounds
+      if( _spatialGridCount > 0 )
+      {
+        rebuildSpatialIndexes();
+      }
+      return;
+    }
+    size_t count = _children.size();
+    for( size_t i = 0; i < count; i++ )
+    {
+      Node *child = _children.at( i );
+      if( child )
+      {
+        child->resizeBy( widthDelta, heightDelta );
+      }
+    }
+  }
+
+  void Node::rebuildSpatialIndexes()
+  {
+    if( _spatialGrid )
+    {
+      setSpatialIndex( _spatialGrid->getCellSize() );
+    }
     size_t count = _children.size();
     for( size_t i = 0; i < count; i++ )
     {
       Node *child = _children.at( i );
-      child->resizeBy( widthDelta, heightDelta );
+      if( child )
+      {
+        child->rebuildSpatialIndexes();
+      }
     }
   }
 }
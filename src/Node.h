@@ -21,22 +21,33 @@
 #include <queue>
 #include <string>
 #include <map>
+#include <utility>
 #include "Action.h"
 #include "Point.h"
 #include "Rect.h"
 #include "NodeVector.h"
+#include "Name.h"
 
 namespace cocosdl
 {
   class Game;
   class Rect;
   class Point;
+  class CollisionWorld;
+
+  namespace util
+  {
+    class SpatialGrid;
+    class NodeIndex;
+    class BitmapCache;
+  }
 
   /**
    * Node is the base class for all graphical objects. A node represents an item or layer in the game "scene". It
    * can contain other nodes, effectively creating a tree of nodes.<br/>
    * All actions and settings applied to a node are in turn applied to all its children.<br/>
-   * Children are drawn in the order they are added to the parent, so last added nodes draw on top of earlier nodes.<br/>
+   * Children are drawn by ascending z order and, when equal, in the order they are added to the parent, so last added
+   * nodes draw on top of earlier nodes.<br/>
    * Nodes are positioned relative to their parent.
    *
    * @author narciso.cerezo@gmail.com
@@ -46,8 +57,15 @@ namespace cocosdl
   {
 
     friend class Game;
+    friend class util::NodeVector;
+    friend class util::NodeIndex;
+    friend class util::BitmapCache;
+    friend class CollisionWorld;
+    friend class Prefab;
 
   public:
+    static const int NO_TAG = -1;
+
     /**
      * Create a new empty node.
      */
@@ -66,6 +84,28 @@ namespace cocosdl
 
     Node &operator = ( const Node &other );
 
+    /**
+     * Nodes of every class are allocated from pooled memory: the current util::NodeArena if any, otherwise the shared
+     * size class pools of util::BlockPool, so spawning and deleting nodes reuses the same blocks instead of going to
+     * the heap. Nodes are still created with new and deleted by their parents as usual.
+     */
+    static void *operator new( size_t size );
+
+    static void operator delete( void *node, size_t size );
+
+    /**
+     * Create a node of any class in the current arena (see util::NodeArena::Scope), or the shared pools when there is
+     * none. The same as new T( args ), named so allocation sites can be found.
+     *
+     * @param args arguments for the constructor of T
+     * @return the new node
+     */
+    template<class T, class... Args>
+    static T *create( Args &&... args )
+    {
+      return new T( std::forward<Args>( args )... );
+    }
+
     /**
      * Draw the node on the screen. This method can be overridden by subclasses, but they must also call it first.
      * The preferred way to implement custom drawing is to override drawBeforeChildren or drawAfterChildren.
@@ -96,7 +136,7 @@ namespace cocosdl
      */
     const std::string &getName() const
     {
-      return _name;
+      return _name.getString();
     }
 
     /**
@@ -104,11 +144,25 @@ namespace cocosdl
      *
      * @param name node name
      */
-    void setName( const std::string &name )
+    void setName( const util::Name &name );
+
+    /**
+     * Get the node tag.
+     *
+     * @return node tag, NO_TAG if none
+     */
+    int getTag() const
     {
-      _name = name;
+      return _tag;
     }
 
+    /**
+     * Set the node tag, an application defined number to find the node by.
+     *
+     * @param tag node tag, NO_TAG for none
+     */
+    void setTag( const int tag );
+
     /**
      * Add a child node. Nodes are managed by their parents, so when a node is destroyed it automatically destroys all
      * its children in turn. So if you add a node to another node, you just have to take care of the parent.
@@ -118,13 +172,32 @@ namespace cocosdl
     void addChild( Node *node );
 
     /**
-     * Insert a node into the given position.
+     * Insert a node into the given position. Nodes are still drawn by z order, position only orders the children with
+     * the same z order; use setZOrder to move nodes up and down instead, which does not shift the children.
      *
      * @param position position to add the node to, moving the resto of the nodes (if any) forward (top)
      * @param node child to add
      */
     void insertChild( const unsigned position, Node *node );
 
+    /**
+     * Set the z order of the node among its siblings. Nodes with greater values are drawn on top, and the parent
+     * sorts its children once before drawing them, however many of them changed.
+     *
+     * @param zOrder z order, 0 by default
+     */
+    void setZOrder( const int zOrder );
+
+    /**
+     * Get the z order of the node.
+     *
+     * @return z order
+     */
+    int getZOrder() const
+    {
+      return _zOrder;
+    }
+
     /**
      * Remove a given child node.
      *
@@ -151,6 +224,7 @@ namespace cocosdl
     void setX( const int x )
     {
       _x = x;
+      positionChanged();
     }
 
     /**
@@ -171,6 +245,7 @@ namespace cocosdl
     void setY( const int y )
     {
       _y = y;
+      positionChanged();
     }
 
     /**
@@ -183,6 +258,7 @@ namespace cocosdl
     {
       _x = x;
       _y = y;
+      positionChanged();
     }
 
     /**
@@ -194,6 +270,7 @@ namespace cocosdl
     {
       _x = point.getX();
       _y = point.getY();
+      positionChanged();
     }
 
     /**
@@ -214,6 +291,7 @@ namespace cocosdl
     void setWidth( const int width )
     {
       _width = width;
+      boundsChanged();
     }
 
     /**
@@ -234,6 +312,7 @@ namespace cocosdl
     void setHeight( const int height )
     {
       _height = height;
+      boundsChanged();
     }
 
     /**
@@ -247,6 +326,7 @@ namespace cocosdl
       _y = rect.getY();
       _width = rect.getWidth();
       _height = rect.getHeight();
+      boundsChanged();
     }
 
     /**
@@ -271,6 +351,7 @@ namespace cocosdl
     void setAnchorX( const float anchorX )
     {
       _anchorX = anchorX < 0.0f ? 0.0f : anchorX > 1.0f ? 1.0f : anchorX;
+      boundsChanged();
     }
 
     /**
@@ -287,6 +368,7 @@ namespace cocosdl
     void setAnchorY( const float anchorY )
     {
       _anchorY = anchorY < 0.0f ? 0.0f : anchorY > 1.0f ? 1.0f : anchorY;
+      boundsChanged();
     }
 
     /**
@@ -299,10 +381,12 @@ namespace cocosdl
     {
       _anchorX = x < 0.0f ? 0.0f : x > 1.0f ? 1.0f : x;
       _anchorY = y < 0.0f ? 0.0f : y > 1.0f ? 1.0f : y;
+      boundsChanged();
     }
 
     /**
-     * Get node opacity, from 0.0 (transparent) to 1.0.
+     * Get node opacity, from 0.0 (transparent) to 1.0. The node draws with its opacity times its ancestors', see
+     * getEffectiveOpacity.
      *
      * @return node opacity
      */
@@ -314,7 +398,15 @@ namespace cocosdl
     void setOpacity( const float opacity );
 
     /**
-     * Get the rotation angle in degrees.
+     * Get the opacity the node draws with, its own times its ancestors'.
+     *
+     * @return effective opacity
+     */
+    float getEffectiveOpacity() const;
+
+    /**
+     * Get the rotation angle in degrees. The node draws rotated by its angle plus its ancestors', see
+     * getEffectiveRotationAngle.
      *
      * @return rotation angle in degrees
      */
@@ -325,6 +417,27 @@ namespace cocosdl
 
     void setRotationAngle( const double rotationAngle );
 
+    /**
+     * Get the angle the node draws rotated by, its own plus its ancestors'.
+     *
+     * @return effective rotation angle in degrees
+     */
+    double getEffectiveRotationAngle() const;
+
+    /**
+     * Get the width the node draws and hit tests with, its own plus what its ancestors were resized by.
+     *
+     * @return effective width
+     */
+    int getEffectiveWidth() const;
+
+    /**
+     * Get the height the node draws and hit tests with, its own plus what its ancestors were resized by.
+     *
+     * @return effective height
+     */
+    int getEffectiveHeight() const;
+
     /**
      * Check if the node is performing clipping to its rectangle when drawing.
      *
@@ -338,6 +451,7 @@ namespace cocosdl
     void setClipping( const bool clipping )
     {
       _clipping = clipping;
+      contentChanged();
     }
 
     /**
@@ -351,7 +465,8 @@ namespace cocosdl
     }
 
     /**
-     * Get the node children.
+     * Get the node children, in drawing order as of the last time they were drawn. Children removed since then leave
+     * empty (NULL) slots until the game loop visits the node.
      *
      * @return node chilren
      */
@@ -369,6 +484,91 @@ namespace cocosdl
      */
     virtual Node *getChildAtPoint( const int x, const int y ) const;
 
+    /**
+     * Get the children overlapping an area, in drawing order.
+     *
+     * @param rect area in absolute screen coordinates
+     * @param nodes filled with the children found
+     */
+    void getChildrenInRect( const Rect &rect, std::vector<Node *> &nodes ) const;
+
+    /**
+     * Index the children in a uniform grid, so getChildAtPoint and getChildrenInRect only test the children near the
+     * point or area instead of all of them. The grid follows the children as they move and resize; children moved by
+     * actions running in parallel are reindexed on the game thread once the workers are done. Worth it for nodes
+     * with many children, such as the markers of a map.
+     *
+     * @param cellSize grid cell size in pixels, about the size of the children; 0 to remove the index
+     */
+    void setSpatialIndex( const int cellSize );
+
+    /**
+     * Get the first child with a name. Names are compared by pointer, see util::Name.
+     *
+     * @param name child name
+     * @return the child, NULL if none has that name
+     */
+    Node *getChildByName( const util::Name &name ) const;
+
+    /**
+     * Get the first child with a tag.
+     *
+     * @param tag child tag
+     * @return the child, NULL if none has that tag
+     */
+    Node *getChildByTag( const int tag ) const;
+
+    /**
+     * Get a descendant by the names along the way from this node, separated by slashes, as in "hud/score". Resolving
+     * the path does not allocate, and costs one lookup per name under a name index.
+     *
+     * @param path child names separated by '/'
+     * @return the descendant, NULL if there is none at that path
+     */
+    Node *getChildByPath( const std::string &path ) const;
+
+    /**
+     * Index the names and tags of every node in this tree in a hash table, kept up to date as nodes are added,
+     * removed, renamed and retagged, so name, tag and path lookups don't scan the children. Usually set on the scene.
+     *
+     * @param enabled true to create the index, false to remove it
+     */
+    void setNameIndex( const bool enabled );
+
+    bool hasNameIndex() const
+    {
+      return _nameIndex != NULL;
+    }
+
+    /**
+     * Cache the node and its children as a bitmap: the subtree is rendered once into a target texture, which is drawn
+     * instead until something in it changes. Setters mark the caches above the node changed, and the subtree is
+     * rendered again on the next draw. Moving the node, and changing the opacity of the node or its ancestors, only
+     * changes how the texture is drawn; the node opacity applies to the cached subtree as a whole. Worth it for
+     * static panels made of many nodes; see util::BitmapCache for the cache statistics.
+     *
+     * @param enabled true to cache the subtree, false to draw it node by node
+     */
+    void setCacheAsBitmap( const bool enabled );
+
+    bool isCacheAsBitmap() const
+    {
+      return _bitmapCache != NULL;
+    }
+
+    /**
+     * Notify that what the node draws changed, so the bitmap caches holding it render again. The setters of the
+     * engine nodes already call it; call it after changing a node in a way they don't see, such as moving the sprites
+     * of a SpriteBatchNode below a cached node.
+     */
+    void contentChanged() const
+    {
+      if( _bitmapCacheCount > 0 )
+      {
+        invalidateBitmapCaches();
+      }
+    }
+
     /**
      * Create a copy of the object with the same class and deep copied properties.
      *
@@ -452,6 +652,29 @@ namespace cocosdl
 
     void resizeBy( int widthDelta, int heightDelta );
 
+    /**
+     * Set the minimum number of nodes in the scene for actions to be evaluated in parallel. Above it, the actions
+     * that only touch their own node (see Action::isConcurrent) run at the same time on worker threads, and then the
+     * rest run on the game thread in the usual order. Smaller scenes run every action on the game thread.
+     *
+     * @param threshold node count, 0 to never run actions in parallel
+     */
+    static void setParallelActionThreshold( const size_t threshold );
+
+    static size_t getParallelActionThreshold();
+
+    /**
+     * Choose how opacity, rotation and resizing reach the children. By default a node keeps its own values, and the
+     * ones it draws with are composed with its ancestors' during drawing, so changing a container costs the same
+     * whatever its size. Eager inheritance is the former behavior: setOpacity, setRotationAngle and resizeBy rewrite
+     * every node below, and nodes draw with their own values. Set it before building any scene.
+     *
+     * @param eager true to propagate the changes to the children
+     */
+    static void setEagerInheritance( const bool eager );
+
+    static bool isEagerInheritance();
+
   protected:
     float     _anchorX;
     float     _anchorY;
@@ -464,6 +687,34 @@ namespace cocosdl
     bool      _clipping;
     Node      *_parent;
 
+    /**
+     * Get the opacity to draw with, composed by draw before calling drawBeforeChildren.
+     */
+    float getDrawOpacity() const
+    {
+      return _drawOpacity;
+    }
+
+    /**
+     * Get the rotation angle to draw with, composed by draw before calling drawBeforeChildren.
+     */
+    double getDrawRotationAngle() const
+    {
+      return _drawRotationAngle;
+    }
+
+    /**
+     * Notify that the position or dimension of the node changed. Subclasses setting the fields directly must call it.
+     */
+    void boundsChanged()
+    {
+      if( _parent && _parent->_spatialGrid )
+      {
+        _parent->indexChild( this );
+      }
+      contentChanged();
+    }
+
     /**
      * Perform custom drawing before the node draws its children, so they are drawn on top.
      *
@@ -480,17 +731,127 @@ namespace cocosdl
 
 
   private:
-    std::string                   _name;
-    util::NodeVector              _children;
+    mutable float                 _drawOpacity;
+    mutable double                _drawRotationAngle;
+    int                           _childWidthDelta;   // resized by, inherited by the children
+    int                           _childHeightDelta;
+    util::Name                    _name;
+    int                           _tag;
+    mutable util::NodeVector      _children;    // may have empty slots until compacted, see util::NodeVector
+    size_t                        _childIndex;  // position in the parent's children
+    int                           _zOrder;
+    util::SpatialGrid             *_spatialGrid;
+    bool                          _spatialIndexPending;   // moved by a parallel action, reindexed on the game thread
+    CollisionWorld                *_collisionWorld;   // the world the node is a body of
+    util::NodeIndex               *_nameIndex;        // names and tags of the tree below, unless a child has its own
+    util::BitmapCache             *_bitmapCache;
     std::queue<action::Action *>  _actions;
     std::queue<Node *>            _nodesToRemove;
 
+    static size_t                 _bitmapCacheCount;  // nodes caching as bitmap, to skip invalidation when none
+    static size_t                 _spatialGridCount;  // nodes indexing their children, to skip rebuilding when none
+    static int                    _drawOffsetX;       // screen origin of the bitmap cache being rendered
+    static int                    _drawOffsetY;
+
     /**
-     * Run this nodes actions. This is only invoked from Game.
+     * Run the actions of this node and its children. This is only invoked from Game.
      */
     void runActions();
 
+    void runActionsSerially();
+
+    void runActionsInParallel( std::vector<Node *> &nodes );
+
+    /**
+     * Run one step of the current action, moving on to the next one when it finishes.
+     */
+    void runCurrentAction();
+
+    void removePendingNodes();
+
+    void collectNodes( std::vector<Node *> &nodes );
+
+    /**
+     * Check if the node is still attached to the tree of an ancestor, or is the ancestor itself.
+     */
+    bool isBelow( const Node *ancestor ) const;
+
     void blendOpacity( float const factor );
+
+    void indexChild( Node *child );
+
+    /**
+     * Rebuild the spatial grids of this node and its descendants, after a lazy resize changed their children bounds.
+     */
+    void rebuildSpatialIndexes();
+
+    /**
+     * Compare two siblings by drawing order, z order first and then position, without sorting the children.
+     */
+    static bool isDrawnBelow( const Node *node, const Node *other )
+    {
+      return node->_zOrder < other->_zOrder ||
+          ( node->_zOrder == other->_zOrder && node->_childIndex < other->_childIndex );
+    }
+
+    /**
+     * Notify the parent that the node moved, which leaves the bitmap cache of the node itself valid.
+     */
+    void positionChanged()
+    {
+      if( _parent )
+      {
+        if( _parent->_spatialGrid )
+        {
+          _parent->indexChild( this );
+        }
+        _parent->contentChanged();
+      }
+    }
+
+    void invalidateBitmapCaches() const;
+
+    /**
+     * Draw the node and its children, skipping its bitmap cache.
+     */
+    void drawNode() const;
+
+    /**
+     * Get the screen area drawn by the node and its children, rotated by their draw angles.
+     *
+     * @return false if the area is empty
+     */
+    bool getTreeBounds( int &left, int &top, int &right, int &bottom ) const;
+
+    void addTreeBounds( int &left, int &top, int &right, int &bottom, const double rotationAngle ) const;
+
+    /**
+     * Get the screen position of the node and the resizing it inherits from its ancestors, in one walk up the tree.
+     */
+    void getScreenOrigin( int &x, int &y, int &widthDelta, int &heightDelta ) const;
+
+    void getInheritedDelta( int &widthDelta, int &heightDelta ) const;
+
+    void deleteChildren();
+
+    /**
+     * Check if the node is in its parent's children, a removed node still points to its former parent.
+     */
+    bool isChild() const;
+
+    /**
+     * Find the name index covering the children of this node, its own or the nearest above.
+     */
+    util::NodeIndex *findNameIndex() const;
+
+    Node *findChildByName( const util::Name &name ) const;
+
+    /**
+     * Add or remove the nodes below this one to or from an index, except the trees having their own.
+     */
+    void indexTree( util::NodeIndex *index, const bool add );
+
+    void unindexChild( util::NodeIndex *index, Node *child );
   };
 
 }
@@ -0,0 +1,86 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "Prefab.h"
+#include "Node.h"
+#include "Action.h"
+
+namespace cocosdl {
+
+  Prefab::Prefab( Node *root ) : _root( root )
+  {
+    if( _root )
+    {
+      std::vector<size_t> path;
+      takeActions( _root, path );
+    }
+  }
+
+  Prefab::~Prefab()
+  {
+    for( size_t i = 0; i < _actions.size(); i++ )
+    {
+      DESTROY_ACTION( _actions[i].action );
+    }
+    delete _root;
+  }
+
+  Node *Prefab::instantiate() const
+  {
+    if( !_root )
+    {
+      return NULL;
+    }
+    Node *instance = _root->copy();
+    for( size_t i = 0; i < _actions.size(); i++ )
+    {
+      const ActionTemplate &actionTemplate = _actions[i];
+      Node *node = instance;
+      for( size_t j = 0; j < actionTemplate.path.size() && node; j++ )
+      {
+        // a fresh copy, compact and in the template order
+        const std::vector<Node *> &children = node->_children;
+        size_t position = actionTemplate.path[j];
+        node = position < children.size() ? children[position] : NULL;
+      }
+      if( node )
+      {
+        node->addAction( actionTemplate.action->copy() );
+      }
+    }
+    return instance;
+  }
+
+  void Prefab::takeActions( Node *node, std::vector<size_t> &path )
+  {
+    while( !node->_actions.empty() )
+    {
+      ActionTemplate actionTemplate = { path, node->_actions.front() };
+      _actions.push_back( actionTemplate );
+      node->_actions.pop();
+    }
+    // paths are positions in the compacted children, as copies have them
+    node->_children.sort();
+    const std::vector<Node *> &children = node->_children;
+    for( size_t i = 0; i < children.size(); i++ )
+    {
+      path.push_back( i );
+      takeActions( children[i], path );
+      path.pop_back();
+    }
+  }
+
+}
@@ -0,0 +1,103 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __Prefab_H_
+#define __Prefab_H_
+
+#include <vector>
+#include <stddef.h>
+
+namespace cocosdl {
+
+  class Node;
+
+  namespace action
+  {
+    class Action;
+  }
+
+  /**
+   * A frozen node subtree stamped out as many times as needed, such as an enemy with its sprites, labels and
+   * animations.<br/>
+   * The prefab keeps the subtree it is given and the actions queued on its nodes, which become templates: every
+   * instance is a copy of the subtree, sharing with it the immutable data (textures, rendered label text, interned
+   * names), with a pooled copy of each template action added to the matching node. An instance only renders text or
+   * loads a texture of its own when it changes them, and it does not depend on the prefab once created.
+   *
+   * @author narciso.cerezo@gmail.com
+   * @version 1.0
+   */
+  class Prefab
+  {
+
+  public:
+    /**
+     * Create a prefab from a subtree, which it takes ownership of. The subtree must not be part of a scene, its
+     * actions are not run but copied to each instance.
+     *
+     * @param root root of the subtree
+     */
+    Prefab( Node *root );
+
+    virtual ~Prefab();
+
+    /**
+     * Create an instance of the prefab, ready to be added to a scene.
+     *
+     * @return the new subtree, owned by the caller
+     */
+    Node *instantiate() const;
+
+    /**
+     * Get the frozen subtree. It must not be modified.
+     *
+     * @return the root of the subtree
+     */
+    const Node *getRoot() const
+    {
+      return _root;
+    }
+
+    /**
+     * Get the number of template actions copied to each instance.
+     *
+     * @return action count
+     */
+    size_t getActionCount() const
+    {
+      return _actions.size();
+    }
+
+  private:
+    struct ActionTemplate
+    {
+      std::vector<size_t> path;     // child positions from the root to the node
+      action::Action      *action;
+    };
+
+    Node                        *_root;
+    std::vector<ActionTemplate> _actions;
+
+    Prefab( const Prefab &other );
+
+    Prefab &operator = ( const Prefab &other );
+
+    void takeActions( Node *node, std::vector<size_t> &path );
+  };
+
+}
+
+#endif //__Prefab_H_
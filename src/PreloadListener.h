@@ -0,0 +1,59 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __PreloadListener_H_
+#define __PreloadListener_H_
+
+#include <stddef.h>
+
+namespace cocosdl {
+
+  class PreloadManifest;
+
+  /**
+   * PreloadListener is an interface / protocol to follow the progress of a preload started with Game::preload, for
+   * instance to show it on a loading scene. Notifications are always delivered on the game thread.
+   *
+   * @author narciso.cerezo@gmail.com
+   * @version 1.0
+   */
+  class PreloadListener
+  {
+
+  public:
+    /**
+     * An asset of the manifest has finished loading (or failed to).
+     *
+     * @param manifest the manifest being loaded
+     * @param finishedCount assets finished so far
+     * @param totalCount assets in the manifest
+     */
+    virtual void preloadProgress( const PreloadManifest &manifest, const size_t finishedCount,
+                                  const size_t totalCount ) = 0;
+
+    /**
+     * Every asset of the manifest has finished loading.
+     *
+     * @param manifest the manifest
+     * @param success true if every asset was loaded, false if any failed
+     */
+    virtual void preloadFinished( const PreloadManifest &manifest, const bool success ) = 0;
+
+  };
+
+}
+
+#endif //__PreloadListener_H_
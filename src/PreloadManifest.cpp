@@ -0,0 +1,151 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "PreloadManifest.h"
+#include "PreloadListener.h"
+#include "Log.h"
+#include <algorithm>
+
+namespace cocosdl {
+
+  static const char *const ASSET_TYPE_NAMES[] = { "texture", "font", "sound", "music" };
+
+  static bool slowerFirst( const PreloadAsset *a, const PreloadAsset *b )
+  {
+    return a->loadMs > b->loadMs;
+  }
+
+  PreloadManifest::PreloadManifest() :
+  _listener( NULL ), _finishedCount( 0 ), _failedCount( 0 ), _startCounter( 0 ), _endCounter( 0 )
+  {
+  }
+
+  PreloadManifest::~PreloadManifest()
+  {
+  }
+
+  void PreloadManifest::addTexture( const std::string &fileName )
+  {
+    addAsset( TextureAsset, fileName, 0 );
+  }
+
+  void PreloadManifest::addFont( const std::string &name, const int fontSize )
+  {
+    addAsset( FontAsset, name, fontSize );
+  }
+
+  void PreloadManifest::addSound( const std::string &name )
+  {
+    addAsset( SoundAsset, name, 0 );
+  }
+
+  void PreloadManifest::addMusic( const std::string &name )
+  {
+    addAsset( MusicAsset, name, 0 );
+  }
+
+  void PreloadManifest::addAsset( const AssetType type, const std::string &name, const int fontSize )
+  {
+    PreloadAsset asset;
+    asset.type = type;
+    asset.name = name;
+    asset.fontSize = fontSize;
+    asset.finished = false;
+    asset.loaded = false;
+    asset.loadMs = 0.0;
+    asset.readyMs = 0.0;
+    _assets.push_back( asset );
+  }
+
+  double PreloadManifest::getElapsedMs() const
+  {
+    if( _startCounter == 0 )
+    {
+      return 0.0;
+    }
+    Uint64 end = isFinished() && _endCounter > 0 ? _endCounter : SDL_GetPerformanceCounter();
+    return ( end - _startCounter ) * 1000.0 / (double) SDL_GetPerformanceFrequency();
+  }
+
+  void PreloadManifest::logTimings() const
+  {
+    std::vector<const PreloadAsset *> assets;
+    for( size_t i = 0; i < _assets.size(); i++ )
+    {
+      assets.push_back( &_assets.at( i ) );
+    }
+    std::sort( assets.begin(), assets.end(), slowerFirst );
+    Log::info() << "[Preload] " << _assets.size() << " assets in " << getElapsedMs() << " ms" << std::endl;
+    for( size_t i = 0; i < assets.size(); i++ )
+    {
+      const PreloadAsset *asset = assets.at( i );
+      Log::info() << "[Preload]   " << ASSET_TYPE_NAMES[asset->type] << " " << asset->name;
+      if( asset->type == FontAsset )
+      {
+        Log::info() << " " << asset->fontSize;
+      }
+      Log::info() << ": " << ( asset->finished ? ( asset->loaded ? "" : "FAILED " ) : "PENDING " ) << "load "
+                  << asset->loadMs << " ms, ready at " << asset->readyMs << " ms" << std::endl;
+    }
+  }
+
+  void PreloadManifest::start( PreloadListener *listener )
+  {
+    _listener = listener;
+    _finishedCount = 0;
+    _failedCount = 0;
+    _startCounter = SDL_GetPerformanceCounter();
+    _endCounter = 0;
+    for( size_t i = 0; i < _assets.size(); i++ )
+    {
+      _assets.at( i ).finished = false;
+      _assets.at( i ).loaded = false;
+      _assets.at( i ).loadMs = 0.0;
+      _assets.at( i ).readyMs = 0.0;
+    }
+  }
+
+  void PreloadManifest::assetFinished( const size_t index, const bool loaded, const double loadMs )
+  {
+    PreloadAsset &asset = _assets.at( index );
+    if( asset.finished )
+    {
+      return;
+    }
+    asset.finished = true;
+    asset.loaded = loaded;
+    asset.readyMs = getElapsedMs();
+    asset.loadMs = loadMs >= 0.0 ? loadMs : asset.readyMs;
+    _finishedCount++;
+    if( !loaded )
+    {
+      _failedCount++;
+    }
+    if( isFinished() )
+    {
+      _endCounter = SDL_GetPerformanceCounter();
+    }
+    if( _listener )
+    {
+      _listener->preloadProgress( *this, _finishedCount, _assets.size() );
+      if( isFinished() )
+      {
+        _listener->preloadFinished( *this, _failedCount == 0 );
+      }
+    }
+  }
+
+}
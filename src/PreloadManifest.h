@@ -0,0 +1,151 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __PreloadManifest_H_
+#define __PreloadManifest_H_
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+#include "ResourceManager.h"
+
+namespace cocosdl {
+
+  class PreloadListener;
+  class PreloadTextureListener;
+
+  /**
+   * Asset types that can be preloaded.
+   */
+  enum AssetType
+  {
+    TextureAsset, FontAsset, SoundAsset, MusicAsset
+  };
+
+  /**
+   * An asset in a preload manifest, with the result of loading it.
+   */
+  struct PreloadAsset
+  {
+    AssetType     type;
+    std::string   name;
+    int           fontSize;
+    bool          finished;
+    bool          loaded;
+    double        loadMs;     // reading and decoding time (for textures, the same as readyMs)
+    double        readyMs;    // from the start of the preload until the asset was available
+    TextureHandle texture;    // the loaded asset, held while the manifest lives
+    FontHandle    font;
+    SoundHandle   sound;
+    MusicHandle   music;
+  };
+
+  /**
+   * A list of assets (textures, fonts at given sizes, sounds and music) to be loaded together with Game::preload.
+   * Names follow the conventions of the matching Game load methods: textures are resource file names with
+   * extension, fonts, sounds and music are names without it.<br/>
+   * The manifest also keeps the progress and timings of the preload, it must be kept alive until it is finished. It
+   * holds a handle to every asset it loaded, keeping them resident while it lives.
+   *
+   * @author narciso.cerezo@gmail.com
+   * @version 1.0
+   */
+  class PreloadManifest
+  {
+    friend class Game;
+    friend class PreloadTextureListener;
+
+  public:
+    PreloadManifest();
+
+    virtual ~PreloadManifest();
+
+    void addTexture( const std::string &fileName );
+
+    void addFont( const std::string &name, const int fontSize );
+
+    void addSound( const std::string &name );
+
+    void addMusic( const std::string &name );
+
+    size_t getCount() const
+    {
+      return _assets.size();
+    }
+
+    const PreloadAsset &getAsset( const size_t index ) const
+    {
+      return _assets.at( index );
+    }
+
+    size_t getFinishedCount() const
+    {
+      return _finishedCount;
+    }
+
+    /**
+     * Get the fraction of assets already finished.
+     *
+     * @return progress from 0.0f to 1.0f
+     */
+    float getProgress() const
+    {
+      return _assets.empty() ? 1.0f : (float) _finishedCount / (float) _assets.size();
+    }
+
+    bool isFinished() const
+    {
+      return _finishedCount == _assets.size();
+    }
+
+    /**
+     * Check if every finished asset was loaded.
+     */
+    bool isSuccessful() const
+    {
+      return _failedCount == 0;
+    }
+
+    /**
+     * Get the time since the preload started, or the total time it took if finished.
+     *
+     * @return elapsed milliseconds
+     */
+    double getElapsedMs() const;
+
+    /**
+     * Log the load times of every asset and the total, slowest assets first.
+     */
+    void logTimings() const;
+
+  private:
+    std::vector<PreloadAsset> _assets;
+    PreloadListener           *_listener;
+    size_t                    _finishedCount;
+    size_t                    _failedCount;
+    Uint64                    _startCounter;
+    Uint64                    _endCounter;
+
+    void addAsset( const AssetType type, const std::string &name, const int fontSize );
+
+    void start( PreloadListener *listener );
+
+    void assetFinished( const size_t index, const bool loaded, const double loadMs = -1.0 );
+  };
+
+}
+
+#endif //__PreloadManifest_H_
@@ -72,6 +72,26 @@ void cocosdl::Renderer::renderCopy( cocosdl::Texture    *texture,
   }
 }
 
+void cocosdl::Renderer::renderGeometry( cocosdl::Texture  *texture,
+                                        const SDL_Vertex  *vertices,
+                                        const int         vertexCount,
+                                        const int         *indices,
+                                        const int         indexCount
+) const
+{
+  if( _renderer )
+  {
+    SDL_RenderGeometry(
+        _renderer,
+        texture ? texture->getTexture() : NULL,
+        vertices,
+        vertexCount,
+        indices,
+        indexCount
+    );
+  }
+}
+
 void cocosdl::Renderer::clear() const
 {
   if( _renderer )
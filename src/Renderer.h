@@ -21,6 +21,11 @@
 #include <string>
 #include "Rect.h"
 
+// SDL_Vertex and SDL_RenderGeometry, used to draw sprite batches, first appeared in SDL 2.0.18
+#if !SDL_VERSION_ATLEAST( 2, 0, 18 )
+#error "CocosDL requires SDL 2.0.18 or later"
+#endif
+
 namespace cocosdl
 {
   class Rect;
@@ -45,6 +50,22 @@ namespace cocosdl
                      const RendererFlip flip
     ) const;
 
+    /**
+     * Draw indexed triangles textured with the given texture in a single call.
+     *
+     * @param texture the texture
+     * @param vertices vertex array
+     * @param vertexCount number of vertices
+     * @param indices vertex indexes, three per triangle
+     * @param indexCount number of indexes
+     */
+    void renderGeometry( Texture *texture,
+                         const SDL_Vertex *vertices,
+                         const int vertexCount,
+                         const int *indices,
+                         const int indexCount
+    ) const;
+
     void clear() const;
     void present() const;
 
@@ -0,0 +1,394 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <stdio.h>
+#include "ResourceManager.h"
+#include "Game.h"
+#include "Texture.h"
+#include "Log.h"
+
+using namespace std;
+
+namespace cocosdl {
+
+  static char const *const TYPE_NAMES[RESOURCE_TYPE_COUNT] = { "textures", "fonts", "sounds", "music" };
+
+  static size_t getTextureBytes( const Texture *texture )
+  {
+    return texture->isReady() ? (size_t) texture->getWidth() * texture->getHeight() * 4 : 0;
+  }
+
+  ResourceManager::ResourceManager()
+  {
+    for( int i = 0; i < RESOURCE_TYPE_COUNT; i++ )
+    {
+      _budgets[i] = 0;
+      _residentBytes[i] = 0;
+    }
+  }
+
+  ResourceManager::~ResourceManager()
+  {
+    for( int i = 0; i < RESOURCE_TYPE_COUNT; i++ )
+    {
+      while( !_entries[i].empty() )
+      {
+        detach( _entries[i].begin()->second );
+      }
+    }
+  }
+
+  TextureHandle ResourceManager::loadTexture( const string &fileName )
+  {
+    ResourceEntry *entry = find( TextureResource, fileName );
+    if( entry )
+    {
+      return TextureHandle( entry );
+    }
+    Texture *texture = new Texture();
+    if( !texture->loadTexture( fileName ) )
+    {
+      Log::error() << "Can't load texture " << fileName << std::endl;
+      delete texture;
+      return TextureHandle();
+    }
+    return TextureHandle( add( TextureResource, fileName, texture, getTextureBytes( texture ) ) );
+  }
+
+  TextureHandle ResourceManager::loadTextureAsync( const string &fileName )
+  {
+    ResourceEntry *entry = find( TextureResource, fileName );
+    if( entry )
+    {
+      return TextureHandle( entry );
+    }
+    Texture *texture = new Texture();
+    entry = add( TextureResource, fileName, texture, 0 );
+    _loadingTextures.insert( make_pair( texture, entry ) );
+    texture->loadTextureAsync( fileName, this );
+    return TextureHandle( entry );
+  }
+
+  FontHandle ResourceManager::loadFont( const string &name, const int fontSize )
+  {
+    ResourceEntry *entry = find( FontResource, getFontKey( name, fontSize ) );
+    if( entry )
+    {
+      return FontHandle( entry );
+    }
+    SDL_RWops *rw = Game::getInstance()->openResource( name + ".ttf" );
+    if( !rw )
+    {
+      return FontHandle();
+    }
+    Sint64 size = SDL_RWsize( rw );
+    TTF_Font *font = TTF_OpenFontRW( rw, 1, fontSize );
+    return font ? addFont( name, fontSize, font, NULL, size > 0 ? (size_t) size : 0 ) : FontHandle();
+  }
+
+  SoundHandle ResourceManager::loadSound( const string &name )
+  {
+    ResourceEntry *entry = find( SoundResource, name );
+    if( entry )
+    {
+      return SoundHandle( entry );
+    }
+    SDL_RWops *rw = Game::getInstance()->openResource( name + ".ogg" );
+    return addSound( name, rw ? Mix_LoadWAV_RW( rw, 1 ) : NULL );
+  }
+
+  MusicHandle ResourceManager::loadMusic( const string &name )
+  {
+    ResourceEntry *entry = find( MusicResource, name );
+    if( entry )
+    {
+      return MusicHandle( entry );
+    }
+    SDL_RWops *rw = Game::getInstance()->openResource( name + ".mp3" );
+    if( !rw )
+    {
+      return MusicHandle();
+    }
+    Sint64 size = SDL_RWsize( rw );
+    return addMusic( name, Mix_LoadMUS_RW( rw, 1 ), size > 0 ? (size_t) size : 0 );
+  }
+
+  TextureHandle ResourceManager::findTexture( const string &fileName )
+  {
+    return TextureHandle( find( TextureResource, fileName ) );
+  }
+
+  FontHandle ResourceManager::findFont( const string &name, const int fontSize )
+  {
+    return FontHandle( find( FontResource, getFontKey( name, fontSize ) ) );
+  }
+
+  SoundHandle ResourceManager::findSound( const string &name )
+  {
+    return SoundHandle( find( SoundResource, name ) );
+  }
+
+  MusicHandle ResourceManager::findMusic( const string &name )
+  {
+    return MusicHandle( find( MusicResource, name ) );
+  }
+
+  FontHandle ResourceManager::addFont( const string &name, const int fontSize, TTF_Font *font, vector<Uint8> *data,
+                                       const size_t bytes )
+  {
+    const string key = getFontKey( name, fontSize );
+    ResourceEntry *entry = find( FontResource, key );
+    if( entry )
+    {
+      TTF_CloseFont( font );
+      delete data;
+      return FontHandle( entry );
+    }
+    entry = add( FontResource, key, font, bytes );
+    entry->data = data;
+    return FontHandle( entry );
+  }
+
+  SoundHandle ResourceManager::addSound( const string &name, Mix_Chunk *sound )
+  {
+    if( !sound )
+    {
+      return SoundHandle();
+    }
+    ResourceEntry *entry = find( SoundResource, name );
+    if( entry )
+    {
+      Mix_FreeChunk( sound );
+      return SoundHandle( entry );
+    }
+    return SoundHandle( add( SoundResource, name, sound, sound->alen ) );
+  }
+
+  MusicHandle ResourceManager::addMusic( const string &name, Mix_Music *music, const size_t bytes )
+  {
+    if( !music )
+    {
+      return MusicHandle();
+    }
+    ResourceEntry *entry = find( MusicResource, name );
+    if( entry )
+    {
+      Mix_FreeMusic( music );
+      return MusicHandle( entry );
+    }
+    return MusicHandle( add( MusicResource, name, music, bytes ) );
+  }
+
+  void ResourceManager::setBudget( const ResourceType type, const size_t bytes )
+  {
+    _budgets[type] = bytes;
+    enforceBudget( type );
+  }
+
+  size_t ResourceManager::evictUnused( const ResourceType type )
+  {
+    size_t before = _residentBytes[type];
+    list<ResourceEntry *> unused( _unused[type] );
+    for( list<ResourceEntry *>::iterator i = unused.begin(); i != unused.end(); ++i )
+    {
+      if( !isPlaying( *i ) )
+      {
+        detach( *i );
+      }
+    }
+    return before - _residentBytes[type];
+  }
+
+  void ResourceManager::enforceBudgets()
+  {
+    for( int i = 0; i < RESOURCE_TYPE_COUNT; i++ )
+    {
+      enforceBudget( (ResourceType) i );
+    }
+  }
+
+  void ResourceManager::enforceBudget( const ResourceType type )
+  {
+    if( _budgets[type] == 0 )
+    {
+      return;
+    }
+    list<ResourceEntry *>::iterator i = _unused[type].begin();
+    while( _residentBytes[type] > _budgets[type] && i != _unused[type].end() )
+    {
+      ResourceEntry *entry = *i++;
+      if( !isPlaying( entry ) )
+      {
+        detach( entry );
+      }
+    }
+  }
+
+  bool ResourceManager::isPlaying( const ResourceEntry *entry ) const
+  {
+    // freeing a chunk or music track halts it, let what is playing finish
+    if( entry->type == SoundResource )
+    {
+      int channels = Mix_AllocateChannels( -1 );
+      for( int channel = 0; channel < channels; channel++ )
+      {
+        if( Mix_Playing( channel ) && Mix_GetChunk( channel ) == entry->object )
+        {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  void ResourceManager::logUsage() const
+  {
+    for( int i = 0; i < RESOURCE_TYPE_COUNT; i++ )
+    {
+      Log::info() << "[Resources] " << TYPE_NAMES[i] << ": " << _entries[i].size() << " resident ("
+                  << _unused[i].size() << " unused), " << _residentBytes[i] / 1024 << " KB";
+      if( _budgets[i] > 0 )
+      {
+        Log::info() << " of " << _budgets[i] / 1024 << " KB";
+      }
+      Log::info() << std::endl;
+    }
+  }
+
+  void ResourceManager::textureLoaded( Texture *texture, const bool success )
+  {
+    map<Texture *, ResourceEntry *>::iterator position = _loadingTextures.find( texture );
+    if( position == _loadingTextures.end() )
+    {
+      return;
+    }
+    ResourceEntry *entry = position->second;
+    _loadingTextures.erase( position );
+    if( success )
+    {
+      entry->bytes = getTextureBytes( texture );
+      _residentBytes[TextureResource] += entry->bytes;
+    }
+    else
+    {
+      // a later load must try again
+      detach( entry );
+    }
+  }
+
+  ResourceEntry *ResourceManager::find( const ResourceType type, const string &key ) const
+  {
+    map<string, ResourceEntry *>::const_iterator position = _entries[type].find( key );
+    return position != _entries[type].end() ? position->second : NULL;
+  }
+
+  ResourceEntry *ResourceManager::add( const ResourceType type, const string &key, void *object, const size_t bytes )
+  {
+    ResourceEntry *entry = new ResourceEntry();
+    entry->manager = this;
+    entry->type = type;
+    entry->key = key;
+    entry->object = object;
+    entry->data = NULL;
+    entry->bytes = bytes;
+    entry->references = 0;
+    entry->priority = 0;
+    entry->maxInstances = 0;
+    entry->bus = 0;
+    // unused until the caller wraps it in a handle
+    entry->unusedPosition = _unused[type].insert( _unused[type].end(), entry );
+    _entries[type].insert( make_pair( key, entry ) );
+    _residentBytes[type] += bytes;
+    return entry;
+  }
+
+  void ResourceManager::detach( ResourceEntry *entry )
+  {
+    _entries[entry->type].erase( entry->key );
+    _residentBytes[entry->type] -= entry->bytes;
+    if( entry->type == TextureResource )
+    {
+      Texture *texture = static_cast<Texture *>( entry->object );
+      texture->removeListener( this );
+      _loadingTextures.erase( texture );
+    }
+    entry->manager = NULL;
+    if( entry->references == 0 )
+    {
+      _unused[entry->type].erase( entry->unusedPosition );
+      destroy( entry );
+    }
+    // otherwise it lives on until its last handle is gone
+  }
+
+  void ResourceManager::destroy( ResourceEntry *entry )
+  {
+    switch( entry->type )
+    {
+      case TextureResource:
+        delete static_cast<Texture *>( entry->object );
+        break;
+
+      case FontResource:
+        TTF_CloseFont( static_cast<TTF_Font *>( entry->object ) );
+        break;
+
+      case SoundResource:
+        Mix_FreeChunk( static_cast<Mix_Chunk *>( entry->object ) );
+        break;
+
+      case MusicResource:
+        Mix_FreeMusic( static_cast<Mix_Music *>( entry->object ) );
+        break;
+    }
+    delete entry->data;
+    delete entry;
+  }
+
+  void ResourceManager::retain( ResourceEntry *entry )
+  {
+    if( entry && entry->references++ == 0 && entry->manager )
+    {
+      entry->manager->_unused[entry->type].erase( entry->unusedPosition );
+    }
+  }
+
+  void ResourceManager::release( ResourceEntry *entry )
+  {
+    if( !entry || --entry->references > 0 )
+    {
+      return;
+    }
+    if( entry->manager )
+    {
+      // most recently used, evicted last
+      std::list<ResourceEntry *> &unused = entry->manager->_unused[entry->type];
+      entry->unusedPosition = unused.insert( unused.end(), entry );
+    }
+    else
+    {
+      destroy( entry );
+    }
+  }
+
+  string ResourceManager::getFontKey( const string &name, const int fontSize )
+  {
+    char sizeString[20];
+    snprintf( sizeString, 20, "%d", fontSize );
+    return name + sizeString;
+  }
+
+}
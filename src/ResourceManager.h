@@ -0,0 +1,369 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __ResourceManager_H_
+#define __ResourceManager_H_
+
+#include <string>
+#include <map>
+#include <list>
+#include <vector>
+#include <stddef.h>
+#include <SDL2/SDL.h>
+#include <SDL2_ttf/SDL_ttf.h>
+#include <SDL2_mixer/SDL_mixer.h>
+#include "TextureListener.h"
+
+namespace cocosdl {
+
+  class Texture;
+  class ResourceManager;
+  class SoundMixer;
+
+  /**
+   * Resource categories, each one with its own memory budget.
+   */
+  enum ResourceType
+  {
+    TextureResource, FontResource, SoundResource, MusicResource
+  };
+
+  static const int RESOURCE_TYPE_COUNT = 4;
+
+  /**
+   * A resource tracked by the ResourceManager, only to be used through a ResourceHandle.
+   */
+  struct ResourceEntry
+  {
+    ResourceManager                       *manager;     // NULL once detached from the manager
+    ResourceType                          type;
+    std::string                           key;
+    void                                  *object;
+    std::vector<Uint8>                    *data;        // contents the object reads from, if owned
+    size_t                                bytes;
+    int                                   references;
+    std::list<ResourceEntry *>::iterator  unusedPosition;
+    int                                   priority;     // playback settings of sounds, see SoundMixer
+    int                                   maxInstances;
+    int                                   bus;
+  };
+
+  /**
+   * A counted reference to a resource of the ResourceManager. While any handle to a resource exists it stays loaded;
+   * once the last one is gone the resource is kept as unused, to be evicted when its category exceeds its budget.
+   * Handles must only be used from the game thread.
+   *
+   * @author narciso.cerezo@gmail.com
+   * @version 1.0
+   */
+  template <class T> class ResourceHandle
+  {
+    friend class ResourceManager;
+    friend class SoundMixer;
+
+  public:
+    ResourceHandle() : _entry( NULL )
+    {
+    }
+
+    ResourceHandle( const ResourceHandle &other );
+
+    ~ResourceHandle();
+
+    ResourceHandle &operator = ( const ResourceHandle &other );
+
+    /**
+     * Get the resource.
+     *
+     * @return the resource, NULL for empty handles
+     */
+    T *get() const
+    {
+      return _entry ? static_cast<T *>( _entry->object ) : NULL;
+    }
+
+    T *operator -> () const
+    {
+      return get();
+    }
+
+    bool isValid() const
+    {
+      return get() != NULL;
+    }
+
+    bool operator == ( const ResourceHandle &other ) const
+    {
+      return _entry == other._entry;
+    }
+
+    bool operator != ( const ResourceHandle &other ) const
+    {
+      return _entry != other._entry;
+    }
+
+    /**
+     * Drop the reference, leaving the handle empty.
+     */
+    void reset();
+
+  private:
+    ResourceEntry *_entry;
+
+    explicit ResourceHandle( ResourceEntry *entry );
+  };
+
+  typedef ResourceHandle<Texture> TextureHandle;
+  typedef ResourceHandle<TTF_Font> FontHandle;
+  typedef ResourceHandle<Mix_Chunk> SoundHandle;
+  typedef ResourceHandle<Mix_Music> MusicHandle;
+
+  /**
+   * The ResourceManager owns every texture, font, sound and music loaded by name, shared through ResourceHandle.<br/>
+   * Each category can be given a memory budget: resources no longer referenced by any handle stay loaded for reuse,
+   * and at the end of every frame the least recently used ones are evicted until the category fits its budget again.
+   * Budgets are unlimited by default, so nothing is evicted unless asked to. Resident sizes are estimates: textures
+   * count 4 bytes per pixel, sounds their decoded samples, fonts and music the size of their source file.<br/>
+   * The manager belongs to the Game (see Game::getResources) and must only be used from the game thread.
+   *
+   * @author narciso.cerezo@gmail.com
+   * @version 1.0
+   */
+  class ResourceManager : public TextureListener
+  {
+    template <class T> friend class ResourceHandle;
+
+  public:
+    ResourceManager();
+
+    virtual ~ResourceManager();
+
+    /**
+     * Get a texture, loading it if not resident.
+     *
+     * @param fileName resource file name (including extension)
+     * @return the texture, empty if it can't be loaded
+     */
+    TextureHandle loadTexture( const std::string &fileName );
+
+    /**
+     * Get a texture, starting to load it in the background if not resident (see Texture::loadTextureAsync).
+     *
+     * @param fileName resource file name (including extension)
+     * @return the texture, which may still be loading
+     */
+    TextureHandle loadTextureAsync( const std::string &fileName );
+
+    /**
+     * Get a font, loading it if not resident.
+     *
+     * @param name font name (without extension, .ttf is appended)
+     * @param fontSize font size
+     * @return the font, empty if it can't be loaded
+     */
+    FontHandle loadFont( const std::string &name, const int fontSize );
+
+    /**
+     * Get a sound effect, loading it if not resident.
+     *
+     * @param name sound name (without extension, .ogg is appended)
+     * @return the sound, empty if it can't be loaded
+     */
+    SoundHandle loadSound( const std::string &name );
+
+    /**
+     * Get a music track, loading it if not resident.
+     *
+     * @param name music name (without extension, .mp3 is appended)
+     * @return the music, empty if it can't be loaded
+     */
+    MusicHandle loadMusic( const std::string &name );
+
+    TextureHandle findTexture( const std::string &fileName );
+
+    FontHandle findFont( const std::string &name, const int fontSize );
+
+    SoundHandle findSound( const std::string &name );
+
+    MusicHandle findMusic( const std::string &name );
+
+    /**
+     * Add a font loaded elsewhere. If the font is already resident the new one is closed and the resident one
+     * returned.
+     *
+     * @param name font name
+     * @param fontSize font size
+     * @param font the font, the manager takes ownership of it
+     * @param data the contents the font was opened from, if it reads from memory the manager owns, or NULL
+     * @param bytes source size
+     * @return the font
+     */
+    FontHandle addFont( const std::string &name, const int fontSize, TTF_Font *font, std::vector<Uint8> *data,
+                        const size_t bytes );
+
+    /**
+     * Add a sound effect loaded elsewhere. If the sound is already resident the new one is freed and the resident one
+     * returned.
+     *
+     * @param name sound name
+     * @param sound the sound, the manager takes ownership of it
+     * @return the sound, empty if sound is NULL
+     */
+    SoundHandle addSound( const std::string &name, Mix_Chunk *sound );
+
+    /**
+     * Add a music track loaded elsewhere. If the track is already resident the new one is freed and the resident one
+     * returned.
+     *
+     * @param name music name
+     * @param music the music, the manager takes ownership of it
+     * @param bytes source size
+     * @return the music, empty if music is NULL
+     */
+    MusicHandle addMusic( const std::string &name, Mix_Music *music, const size_t bytes );
+
+    /**
+     * Set the memory budget of a category. Unused resources over it are evicted right away.
+     *
+     * @param type resource category
+     * @param bytes budget in bytes, 0 for no limit
+     */
+    void setBudget( const ResourceType type, const size_t bytes );
+
+    size_t getBudget( const ResourceType type ) const
+    {
+      return _budgets[type];
+    }
+
+    /**
+     * Get the estimated memory used by the resident resources of a category.
+     *
+     * @param type resource category
+     * @return resident bytes
+     */
+    size_t getResidentBytes( const ResourceType type ) const
+    {
+      return _residentBytes[type];
+    }
+
+    /**
+     * Get the number of resident resources of a category.
+     *
+     * @param type resource category
+     * @return resident resources, used or not
+     */
+    size_t getResidentCount( const ResourceType type ) const
+    {
+      return _entries[type].size();
+    }
+
+    /**
+     * Get the number of resident resources of a category no handle refers to.
+     *
+     * @param type resource category
+     * @return unused resources
+     */
+    size_t getUnusedCount( const ResourceType type ) const
+    {
+      return _unused[type].size();
+    }
+
+    /**
+     * Evict every unused resource of a category, regardless of its budget.
+     *
+     * @param type resource category
+     * @return bytes freed
+     */
+    size_t evictUnused( const ResourceType type );
+
+    /**
+     * Evict unused resources of every category over its budget, least recently used first. Called by the game loop
+     * once per frame.
+     */
+    void enforceBudgets();
+
+    /**
+     * Log the resident resources and bytes of every category.
+     */
+    void logUsage() const;
+
+    virtual void textureLoaded( Texture *texture, const bool success );
+
+  private:
+    std::map<std::string, ResourceEntry *>  _entries[RESOURCE_TYPE_COUNT];
+    std::list<ResourceEntry *>              _unused[RESOURCE_TYPE_COUNT];   // least recently used first
+    size_t                                  _budgets[RESOURCE_TYPE_COUNT];
+    size_t                                  _residentBytes[RESOURCE_TYPE_COUNT];
+    std::map<Texture *, ResourceEntry *>    _loadingTextures;
+
+    ResourceManager( const ResourceManager &other );
+
+    ResourceManager &operator = ( const ResourceManager &other );
+
+    ResourceEntry *find( const ResourceType type, const std::string &key ) const;
+
+    ResourceEntry *add( const ResourceType type, const std::string &key, void *object, const size_t bytes );
+
+    void enforceBudget( const ResourceType type );
+
+    bool isPlaying( const ResourceEntry *entry ) const;
+
+    void detach( ResourceEntry *entry );
+
+    static void destroy( ResourceEntry *entry );
+
+    static void retain( ResourceEntry *entry );
+
+    static void release( ResourceEntry *entry );
+
+    static std::string getFontKey( const std::string &name, const int fontSize );
+  };
+
+  template <class T> ResourceHandle<T>::ResourceHandle( ResourceEntry *entry ) : _entry( entry )
+  {
+    ResourceManager::retain( _entry );
+  }
+
+  template <class T> ResourceHandle<T>::ResourceHandle( const ResourceHandle &other ) : _entry( other._entry )
+  {
+    ResourceManager::retain( _entry );
+  }
+
+  template <class T> ResourceHandle<T>::~ResourceHandle()
+  {
+    ResourceManager::release( _entry );
+  }
+
+  template <class T> ResourceHandle<T> &ResourceHandle<T>::operator = ( const ResourceHandle &other )
+  {
+    if( _entry != other._entry )
+    {
+      ResourceManager::retain( other._entry );
+      ResourceManager::release( _entry );
+      _entry = other._entry;
+    }
+    return *this;
+  }
+
+  template <class T> void ResourceHandle<T>::reset()
+  {
+    ResourceManager::release( _entry );
+    _entry = NULL;
+  }
+
+}
+
+#endif //__ResourceManager_H_
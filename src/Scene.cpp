@@ -23,7 +23,8 @@ namespace cocosdl {
   const double SWIPE_MIN_SPEED = 0.015;
   const unsigned SWIPE_MAX_AXIS_DELTA = 20;
 
-  Scene::Scene() : Node(), _xDelta( 0 ), _yDelta( 0 ), _swipeStart( 0 ), _button( NULL ), _swipeStatus( SceneSwipeNone )
+  Scene::Scene() : Node(), _xDelta( 0 ), _yDelta( 0 ), _swipeStart( 0 ), _button( NULL ), _swipeStatus( SceneSwipeNone ),
+  _arena( NULL )
   {
     Rect rect = Game::getInstance()->getWindowRect();
     setClipping( true );
@@ -37,7 +38,8 @@ namespace cocosdl {
   _yDelta( other._yDelta ),
   _swipeStart( 0 ),
   _button( NULL ),
-  _swipeStatus( SceneSwipeNone )
+  _swipeStatus( SceneSwipeNone ),
+  _arena( NULL )
   {
     setDimension( other.getWidth(), other.getHeight() );
     setPosition( other.getX(), other.getY() );
@@ -46,6 +48,12 @@ namespace cocosdl {
 
   Scene::~Scene()
   {
+    if( _arena )
+    {
+      // the nodes must go before the memory under them, detached ones keep the arena alive until deleted
+      removeAll();
+      _arena->release();
+    }
   }
 
 
@@ -61,6 +69,20 @@ namespace cocosdl {
   }
 
 
+  void Scene::useArena( const size_t nodesPerSlab )
+  {
+    if( !_arena )
+    {
+      _arena = new util::NodeArena( nodesPerSlab );
+    }
+  }
+
+  bool Scene::resetArena()
+  {
+    removeAll();
+    return !_arena || _arena->reset();
+  }
+
   Node *Scene::copy() const
   {
     return new Scene( *this );
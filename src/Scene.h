@@ -18,6 +18,7 @@
 #define __Scene_H_
 
 #include "Node.h"
+#include "NodeArena.h"
 #include <SDL2/SDL.h>
 
 namespace cocosdl {
@@ -70,6 +71,42 @@ namespace cocosdl {
      */
     virtual Node *copy() const;
 
+    /**
+     * Give the scene its own node arena, so the nodes created with create are kept apart from other scenes and their
+     * memory is released in one go when the scene is deleted or resetArena is called. Nodes of the arena removed
+     * from the scene without being deleted keep it alive after the scene is deleted, until the last one is deleted.
+     *
+     * @param nodesPerSlab nodes allocated at once when a size class runs out of free blocks
+     */
+    void useArena( const size_t nodesPerSlab = util::NodeArena::DEFAULT_NODES_PER_SLAB );
+
+    util::NodeArena *getArena() const
+    {
+      return _arena;
+    }
+
+    /**
+     * Create a node of any class in the scene arena, or the shared pools when the scene has none. Nodes created by
+     * its constructor, such as the label of a button, go to the arena too.
+     *
+     * @param args arguments for the constructor of T
+     * @return the new node, to be added to the scene or one of its nodes
+     */
+    template<class T, class... Args>
+    T *create( Args &&... args )
+    {
+      util::NodeArena::Scope scope( _arena );
+      return new T( std::forward<Args>( args )... );
+    }
+
+    /**
+     * Delete every node of the scene and release the arena memory at once. Nodes of the arena that were removed from
+     * the scene without being deleted keep it from being released.
+     *
+     * @return true if the memory was released
+     */
+    bool resetArena();
+
   protected:
     /**
      * Called when the mouse is pressed.<br/>
@@ -147,6 +184,7 @@ namespace cocosdl {
     SDL_Event         _downEvent;
     Button            *_button;
     SceneSwipeStatus  _swipeStatus;
+    util::NodeArena   *_arena;
 
     void mouseDown( const SDL_Event &event );
 
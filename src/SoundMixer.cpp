@@ -0,0 +1,354 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "SoundMixer.h"
+#include "Log.h"
+
+namespace cocosdl {
+
+  SoundMixer::SoundMixer() : _soundVolume( 1.0f ), _musicGain( 1.0f ), _time( 0 ), _sequence( 0 ), _stolenCount( 0 ),
+  _droppedCount( 0 )
+  {
+    for( int i = 0; i < AUDIO_BUS_COUNT; i++ )
+    {
+      Bus &bus = _buses[i];
+      bus.volume = 1.0f;
+      bus.muted = false;
+      bus.fadeFrom = bus.fadeTo = 1.0f;
+      bus.fadeStart = bus.fadeDuration = 0;
+      bus.duckTrigger = -1;
+      bus.duckLevel = bus.duckGain = 1.0f;
+      bus.duckRampMs = 0;
+    }
+  }
+
+  SoundMixer::~SoundMixer()
+  {
+  }
+
+  void SoundMixer::setVoiceCount( const int voiceCount )
+  {
+    // SDL_mixer halts the channels it drops
+    int allocated = Mix_AllocateChannels( voiceCount > 0 ? voiceCount : 1 );
+    Voice voice = { NULL, 0, 0.0f, 0, EffectsBus };
+    _voices.resize( (size_t) allocated, voice );
+  }
+
+  int SoundMixer::play( const SoundHandle &sound, const float volume, const int loops )
+  {
+    const ResourceEntry *entry = sound._entry;
+    if( !entry || _voices.empty() )
+    {
+      return -1;
+    }
+    Mix_Chunk *chunk = static_cast<Mix_Chunk *>( entry->object );
+
+    int target = -1;
+    bool stealing = true;
+    if( entry->maxInstances > 0 && getInstanceCount( sound ) >= entry->maxInstances )
+    {
+      // at its limit, restart one of its own instances
+      for( int i = 0; i < (int) _voices.size(); i++ )
+      {
+        if( _voices[i].chunk == chunk && isBusy( i ) && ( target == -1 || isBetterVictim( i, target ) ) )
+        {
+          target = i;
+        }
+      }
+    }
+    else
+    {
+      for( int i = 0; i < (int) _voices.size() && target == -1; i++ )
+      {
+        if( !isBusy( i ) )
+        {
+          target = i;
+          stealing = false;
+        }
+      }
+      if( target == -1 )
+      {
+        for( int i = 0; i < (int) _voices.size(); i++ )
+        {
+          if( _voices[i].priority <= entry->priority && ( target == -1 || isBetterVictim( i, target ) ) )
+          {
+            target = i;
+          }
+        }
+        if( target == -1 )
+        {
+          _droppedCount++;
+          return -1;
+        }
+      }
+    }
+    if( stealing )
+    {
+      _stolenCount++;
+    }
+
+    Voice &voice = _voices[target];
+    voice.chunk = chunk;
+    voice.priority = entry->priority;
+    voice.volume = volume;
+    voice.sequence = ++_sequence;
+    voice.bus = entry->bus;
+    // the channel group lets SDL_mixer halt or count a whole bus
+    Mix_GroupChannel( target, voice.bus );
+    Mix_Volume( target, getVoiceVolume( target ) );
+    if( Mix_PlayChannel( target, chunk, loops ) == -1 )
+    {
+      Log::error() << "[SoundMixer] Can't play sound " << entry->key << ": " << Mix_GetError() << std::endl;
+      return -1;
+    }
+    return target;
+  }
+
+  void SoundMixer::stop( const int voice )
+  {
+    if( voice >= 0 && voice < (int) _voices.size() )
+    {
+      Mix_HaltChannel( voice );
+    }
+  }
+
+  void SoundMixer::stopAll()
+  {
+    Mix_HaltChannel( -1 );
+  }
+
+  void SoundMixer::setSoundPriority( const SoundHandle &sound, const int priority )
+  {
+    if( sound._entry )
+    {
+      sound._entry->priority = priority;
+    }
+  }
+
+  void SoundMixer::setSoundMaxInstances( const SoundHandle &sound, const int maxInstances )
+  {
+    if( sound._entry )
+    {
+      sound._entry->maxInstances = maxInstances > 0 ? maxInstances : 0;
+    }
+  }
+
+  void SoundMixer::setSoundBus( const SoundHandle &sound, const AudioBus bus )
+  {
+    if( sound._entry && bus != MusicBus )
+    {
+      sound._entry->bus = bus;
+    }
+  }
+
+  void SoundMixer::setSoundVolume( const float volume )
+  {
+    _soundVolume = volume;
+    for( int i = 0; i < AUDIO_BUS_COUNT; i++ )
+    {
+      if( i != MusicBus )
+      {
+        applyBus( i );
+      }
+    }
+  }
+
+  void SoundMixer::setBusVolume( const AudioBus bus, const float volume )
+  {
+    _buses[bus].volume = volume;
+    _buses[bus].fadeDuration = 0;
+    applyBus( bus );
+  }
+
+  void SoundMixer::fadeBusVolume( const AudioBus bus, const float volume, const long long durationMs )
+  {
+    if( durationMs <= 0 )
+    {
+      setBusVolume( bus, volume );
+      return;
+    }
+    Bus &state = _buses[bus];
+    state.fadeFrom = state.volume;
+    state.fadeTo = volume;
+    state.fadeStart = _time;
+    state.fadeDuration = durationMs;
+  }
+
+  void SoundMixer::setBusMuted( const AudioBus bus, const bool muted )
+  {
+    _buses[bus].muted = muted;
+    applyBus( bus );
+  }
+
+  void SoundMixer::setBusDucking( const AudioBus bus, const AudioBus triggerBus, const float level,
+                                  const long long rampMs )
+  {
+    Bus &state = _buses[bus];
+    state.duckTrigger = level < 1.0f && triggerBus != bus ? triggerBus : -1;
+    state.duckLevel = level;
+    state.duckRampMs = rampMs > 0 ? rampMs : 0;
+  }
+
+  void SoundMixer::stopBus( const AudioBus bus )
+  {
+    if( bus == MusicBus )
+    {
+      Mix_HaltMusic();
+    }
+    else
+    {
+      Mix_HaltGroup( bus );
+    }
+  }
+
+  void SoundMixer::update( const long long timeMs )
+  {
+    long long elapsed = _time > 0 && timeMs > _time ? timeMs - _time : 0;
+    _time = timeMs;
+
+    bool triggered[AUDIO_BUS_COUNT] = { false };
+    for( int i = 0; i < (int) _voices.size(); i++ )
+    {
+      if( isBusy( i ) )
+      {
+        triggered[_voices[i].bus] = true;
+      }
+    }
+    triggered[MusicBus] = Mix_PlayingMusic() != 0;
+
+    for( int i = 0; i < AUDIO_BUS_COUNT; i++ )
+    {
+      Bus &bus = _buses[i];
+      bool changed = false;
+      if( bus.fadeDuration > 0 )
+      {
+        long long fadeTime = timeMs - bus.fadeStart;
+        if( fadeTime >= bus.fadeDuration )
+        {
+          bus.volume = bus.fadeTo;
+          bus.fadeDuration = 0;
+        }
+        else
+        {
+          bus.volume = bus.fadeFrom + ( bus.fadeTo - bus.fadeFrom ) * fadeTime / bus.fadeDuration;
+        }
+        changed = true;
+      }
+      float duckTarget = bus.duckTrigger >= 0 && triggered[bus.duckTrigger] ? bus.duckLevel : 1.0f;
+      if( bus.duckGain != duckTarget )
+      {
+        // linear ramp covering the whole range in duckRampMs
+        float step = bus.duckRampMs > 0 ? (float) elapsed / bus.duckRampMs : 1.0f;
+        if( bus.duckGain < duckTarget )
+        {
+          bus.duckGain = bus.duckGain + step < duckTarget ? bus.duckGain + step : duckTarget;
+        }
+        else
+        {
+          bus.duckGain = bus.duckGain - step > duckTarget ? bus.duckGain - step : duckTarget;
+        }
+        changed = true;
+      }
+      if( changed )
+      {
+        applyBus( i );
+      }
+    }
+  }
+
+  int SoundMixer::getActiveVoiceCount() const
+  {
+    int count = 0;
+    for( int i = 0; i < (int) _voices.size(); i++ )
+    {
+      if( isBusy( i ) )
+      {
+        count++;
+      }
+    }
+    return count;
+  }
+
+  int SoundMixer::getInstanceCount( const SoundHandle &sound ) const
+  {
+    int count = 0;
+    if( sound._entry )
+    {
+      for( int i = 0; i < (int) _voices.size(); i++ )
+      {
+        if( _voices[i].chunk == sound._entry->object && isBusy( i ) )
+        {
+          count++;
+        }
+      }
+    }
+    return count;
+  }
+
+  bool SoundMixer::isBusy( const int voice ) const
+  {
+    return Mix_Playing( voice ) != 0;
+  }
+
+  float SoundMixer::getBusGain( const int bus ) const
+  {
+    const Bus &state = _buses[bus];
+    return state.muted ? 0.0f : state.volume * state.duckGain;
+  }
+
+  int SoundMixer::getVoiceVolume( const int voice ) const
+  {
+    return (int) ( MIX_MAX_VOLUME * _voices[voice].volume * getBusGain( _voices[voice].bus ) * _soundVolume );
+  }
+
+  void SoundMixer::applyBus( const int bus )
+  {
+    if( bus == MusicBus )
+    {
+      Mix_VolumeMusic( (int) ( MIX_MAX_VOLUME * getBusGain( bus ) * _musicGain ) );
+      return;
+    }
+    for( int i = 0; i < (int) _voices.size(); i++ )
+    {
+      if( _voices[i].bus == bus && isBusy( i ) )
+      {
+        Mix_Volume( i, getVoiceVolume( i ) );
+      }
+    }
+  }
+
+  void SoundMixer::setMusicGain( const float gain )
+  {
+    _musicGain = gain;
+    applyBus( MusicBus );
+  }
+
+  bool SoundMixer::isBetterVictim( const int voice, const int other ) const
+  {
+    const Voice &a = _voices[voice];
+    const Voice &b = _voices[other];
+    if( a.priority != b.priority )
+    {
+      return a.priority < b.priority;
+    }
+    if( a.volume != b.volume )
+    {
+      return a.volume < b.volume;
+    }
+    return a.sequence < b.sequence;
+  }
+
+}
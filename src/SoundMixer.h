@@ -0,0 +1,277 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __SoundMixer_H_
+#define __SoundMixer_H_
+
+#include <vector>
+#include <stddef.h>
+#include <SDL2/SDL.h>
+#include <SDL2_mixer/SDL_mixer.h>
+#include "ResourceManager.h"
+
+namespace cocosdl {
+
+  static const int DEFAULT_VOICE_COUNT = 16;
+
+  /**
+   * Mixer buses. Every sound plays on a bus, EffectsBus unless set with SoundMixer::setSoundBus; background music
+   * plays on MusicBus.
+   */
+  enum AudioBus
+  {
+    EffectsBus = 0,
+    InterfaceBus,
+    VoiceBus,
+    MusicBus,
+    AUDIO_BUS_COUNT
+  };
+
+  /**
+   * The SoundMixer plays sound effects on a fixed set of voices (mixer channels).<br/>
+   * Sounds are played through a SoundHandle resolved once, so playing them does not look anything up. Each sound can
+   * be given a priority and a maximum number of simultaneous instances. When a sound reaches its limit its quietest,
+   * oldest instance is restarted. When every voice is busy, the voice with the lowest priority is stolen, choosing the
+   * quietest and then the oldest among equals; a sound only steals voices of its own priority or lower, and is dropped
+   * otherwise.<br/>
+   * Sounds play on buses with their own volume, mute and ducking. Their gain is applied to the voices when played and
+   * to the voices already playing on a bus when it changes, no loaded sound is touched. Bus fades and ducking ramps
+   * advance with the engine clock on every update.<br/>
+   * The mixer belongs to the Game (see Game::getMixer) and must only be used from the game thread.
+   *
+   * @author narciso.cerezo@gmail.com
+   * @version 1.0
+   */
+  class SoundMixer
+  {
+    friend class MusicPlayer;
+
+  public:
+    SoundMixer();
+
+    virtual ~SoundMixer();
+
+    /**
+     * Set the number of voices, allocating the mixer channels. Voices beyond the new count are stopped.
+     *
+     * @param voiceCount number of sounds that can play at once
+     */
+    void setVoiceCount( const int voiceCount );
+
+    int getVoiceCount() const
+    {
+      return (int) _voices.size();
+    }
+
+    /**
+     * Play a sound.
+     *
+     * @param sound the sound
+     * @param volume volume of this instance, from 0.0 to 1.0, relative to the sound volume
+     * @param loops times to repeat the sound, -1 to loop until stopped
+     * @return the voice playing the sound, -1 if it was dropped
+     */
+    int play( const SoundHandle &sound, const float volume = 1.0f, const int loops = 0 );
+
+    /**
+     * Stop a voice.
+     *
+     * @param voice voice returned by play
+     */
+    void stop( const int voice );
+
+    void stopAll();
+
+    /**
+     * Set the priority of a sound, 0 by default. Sounds with higher priorities take voices from lower ones when every
+     * voice is busy. Settings belong to the loaded sound, keep a handle to it so they are not lost to eviction.
+     *
+     * @param sound the sound
+     * @param priority priority
+     */
+    void setSoundPriority( const SoundHandle &sound, const int priority );
+
+    /**
+     * Limit the instances of a sound playing at once.
+     *
+     * @param sound the sound
+     * @param maxInstances most instances playing at once, 0 for no limit
+     */
+    void setSoundMaxInstances( const SoundHandle &sound, const int maxInstances );
+
+    /**
+     * Set the bus a sound plays on, EffectsBus by default. Applies to the instances played afterwards.
+     *
+     * @param sound the sound
+     * @param bus the bus, other than MusicBus
+     */
+    void setSoundBus( const SoundHandle &sound, const AudioBus bus );
+
+    /**
+     * Set the volume applied to every sound, on top of their bus volume. Does not apply to the music.
+     *
+     * @param volume volume, from 0.0 to 1.0
+     */
+    void setSoundVolume( const float volume );
+
+    float getSoundVolume() const
+    {
+      return _soundVolume;
+    }
+
+    /**
+     * Set the volume of a bus, cancelling any fade in progress.
+     *
+     * @param bus the bus
+     * @param volume volume, from 0.0 to 1.0
+     */
+    void setBusVolume( const AudioBus bus, const float volume );
+
+    float getBusVolume( const AudioBus bus ) const
+    {
+      return _buses[bus].volume;
+    }
+
+    /**
+     * Fade the volume of a bus over time.
+     *
+     * @param bus the bus
+     * @param volume final volume, from 0.0 to 1.0
+     * @param durationMs fade duration in milliseconds
+     */
+    void fadeBusVolume( const AudioBus bus, const float volume, const long long durationMs );
+
+    /**
+     * Mute or unmute a bus, keeping its volume.
+     *
+     * @param bus the bus
+     * @param muted true to mute it
+     */
+    void setBusMuted( const AudioBus bus, const bool muted );
+
+    bool isBusMuted( const AudioBus bus ) const
+    {
+      return _buses[bus].muted;
+    }
+
+    /**
+     * Duck a bus while sounds play on another one, such as lowering the music and effects under dialogue.
+     *
+     * @param bus the bus to duck
+     * @param triggerBus the bus whose sounds duck it
+     * @param level gain of the ducked bus while the trigger plays, 1.0 to disable ducking
+     * @param rampMs time to reach the ducked level, and to recover from it, in milliseconds
+     */
+    void setBusDucking( const AudioBus bus, const AudioBus triggerBus, const float level, const long long rampMs );
+
+    /**
+     * Stop every sound playing on a bus.
+     *
+     * @param bus the bus
+     */
+    void stopBus( const AudioBus bus );
+
+    /**
+     * Advance bus fades and ducking. Called by the game once per frame.
+     *
+     * @param timeMs current engine time in milliseconds
+     */
+    void update( const long long timeMs );
+
+    /**
+     * Get the number of voices playing.
+     *
+     * @return busy voices
+     */
+    int getActiveVoiceCount() const;
+
+    /**
+     * Get the number of instances of a sound playing.
+     *
+     * @param sound the sound
+     * @return playing instances
+     */
+    int getInstanceCount( const SoundHandle &sound ) const;
+
+    /**
+     * Get the number of playing voices cut short to play another sound since start.
+     */
+    size_t getStolenCount() const
+    {
+      return _stolenCount;
+    }
+
+    /**
+     * Get the number of sounds not played since start, because every voice was busy with more important ones.
+     */
+    size_t getDroppedCount() const
+    {
+      return _droppedCount;
+    }
+
+  private:
+    struct Voice
+    {
+      Mix_Chunk *chunk;
+      int       priority;
+      float     volume;
+      Uint64    sequence;   // play order, the lowest is the oldest
+      int       bus;
+    };
+
+    struct Bus
+    {
+      float     volume;
+      bool      muted;
+      float     fadeFrom;
+      float     fadeTo;
+      long long fadeStart;
+      long long fadeDuration;   // 0 when not fading
+      int       duckTrigger;    // -1 when not ducked
+      float     duckLevel;
+      long long duckRampMs;
+      float     duckGain;       // current ducking gain
+    };
+
+    std::vector<Voice>  _voices;
+    Bus                 _buses[AUDIO_BUS_COUNT];
+    float               _soundVolume;
+    float               _musicGain;   // transition gain of the music player
+    long long           _time;
+    Uint64              _sequence;
+    size_t              _stolenCount;
+    size_t              _droppedCount;
+
+    SoundMixer( const SoundMixer &other );
+
+    SoundMixer &operator = ( const SoundMixer &other );
+
+    bool isBusy( const int voice ) const;
+
+    bool isBetterVictim( const int voice, const int other ) const;
+
+    float getBusGain( const int bus ) const;
+
+    int getVoiceVolume( const int voice ) const;
+
+    void applyBus( const int bus );
+
+    void setMusicGain( const float gain );
+  };
+
+}
+
+#endif //__SoundMixer_H_
@@ -21,43 +21,46 @@
 
 namespace cocosdl {
 
-  Sprite::Sprite() : _texture( NULL ), _cleanTexture( true )
+  static Texture *_placeholderTexture = NULL;
+
+  Sprite::Sprite() : _texture( NULL ), _cleanTexture( true ), _awaitingTexture( false )
   {
 
   }
 
-  Sprite::Sprite( Texture *texture ) : _texture( NULL ), _cleanTexture( false )
+  Sprite::Sprite( Texture *texture ) : _texture( NULL ), _cleanTexture( false ), _awaitingTexture( false )
   {
     setTexture( texture );
   }
 
-  Sprite::Sprite( const std::string &fileName ) : _texture( NULL ), _cleanTexture( true )
+  Sprite::Sprite( const std::string &fileName ) : _texture( NULL ), _cleanTexture( true ), _awaitingTexture( false )
   {
     setTexture( fileName );
   }
 
-  Sprite::Sprite( const Sprite &other ) : Node( other ), _texture( NULL ), _cleanTexture( other._cleanTexture )
+  Sprite::Sprite( const Sprite &other ) :
+  Node( other ), _texture( NULL ), _cleanTexture( other._cleanTexture ), _awaitingTexture( false ),
+  _textureHandle( other._textureHandle )
   {
     if( other._texture )
     {
       if( other._cleanTexture )
       {
-        _texture = new Texture( *other._texture );
+        // never modified once created, so copies share it
+        _ownedTexture = other._ownedTexture;
+        bindTexture( other._texture, true, false );
       }
       else
       {
-        _texture = other._texture;
-        _cleanTexture = false;
+        bindTexture( other._texture, false, false );
       }
+      _awaitingTexture = other._awaitingTexture;
     }
   }
 
   Sprite::~Sprite()
   {
-    if( _texture && _cleanTexture )
-    {
-      delete _texture;
-    }
+    releaseTexture();
   }
 
 
@@ -65,72 +68,145 @@ namespace cocosdl {
   {
     Node::operator=( other );
 
-    if( _texture && _cleanTexture )
-    {
-      delete _texture;
-      _texture = NULL;
-    }
+    releaseTexture();
 
+    _textureHandle = other._textureHandle;
     if( other._texture )
     {
       if( other._cleanTexture )
       {
-        _texture = new Texture( *other._texture );
+        // never modified once created, so copies share it
+        _ownedTexture = other._ownedTexture;
+        bindTexture( other._texture, true, false );
       }
       else
       {
-        _texture = other._texture;
-        _cleanTexture = false;
+        bindTexture( other._texture, false, false );
       }
+      _awaitingTexture = other._awaitingTexture;
     }
     return *this;
   }
 
   void Sprite::setTexture( const std::string &fileName )
   {
-    if( _texture && _cleanTexture )
+    releaseTexture();
+    _textureHandle = Game::getInstance()->getResources()->loadTexture( fileName );
+    if( _textureHandle.isValid() )
     {
-      delete _texture;
-      _texture = NULL;
+      bindTexture( _textureHandle.get(), false, true );
     }
-    _texture = new Texture( fileName );
-    if( _texture )
+    contentChanged();
+  }
+
+  void Sprite::setTexture( Texture *texture )
+  {
+    releaseTexture();
+    if( texture )
+    {
+      bindTexture( texture, false, true );
+    }
+    contentChanged();
+  }
+
+  void Sprite::setOwnedTexture( Texture *texture )
+  {
+    releaseTexture();
+    if( texture )
+    {
+      _ownedTexture.reset( texture );
+      bindTexture( texture, true, true );
+    }
+    contentChanged();
+  }
+
+  void Sprite::setTextureAsync( const std::string &fileName )
+  {
+    releaseTexture();
+    _textureHandle = Game::getInstance()->getResources()->loadTextureAsync( fileName );
+    bindTexture( _textureHandle.get(), false, true );
+    contentChanged();
+  }
+
+  void Sprite::bindTexture( Texture *texture, const bool cleanTexture, const bool adoptSize )
+  {
+    _texture = texture;
+    _cleanTexture = cleanTexture;
+    if( _texture->getStatus() == TextureLoading )
+    {
+      _texture->addListener( this );
+      _awaitingTexture = adoptSize;
+      if( adoptSize && !_texture->isReady() )
+      {
+        bool placeholder = _placeholderTexture && _placeholderTexture->isReady();
+        _width = placeholder ? _placeholderTexture->getWidth() : 0;
+        _height = placeholder ? _placeholderTexture->getHeight() : 0;
+        boundsChanged();
+      }
+    }
+    else if( adoptSize )
     {
-      _cleanTexture = true;
       _width = _texture->getWidth();
       _height = _texture->getHeight();
+      boundsChanged();
     }
   }
 
-  void Sprite::setTexture( Texture *texture )
+  void Sprite::releaseTexture()
   {
-    if( _texture && _cleanTexture )
+    if( _texture )
     {
-      delete _texture;
+      _texture->removeListener( this );
       _texture = NULL;
     }
-    _texture = texture;
-    if( _texture )
+    _textureHandle.reset();
+    _ownedTexture.reset();
+    _awaitingTexture = false;
+  }
+
+  void Sprite::textureLoaded( Texture *texture, const bool success )
+  {
+    if( texture == _texture && _awaitingTexture && success )
     {
-      _cleanTexture = false;
       _width = _texture->getWidth();
       _height = _texture->getHeight();
+      boundsChanged();
+    }
+    _awaitingTexture = false;
+    if( texture == _texture )
+    {
+      contentChanged();
     }
   }
 
+  void Sprite::setPlaceholderTexture( Texture *texture )
+  {
+    _placeholderTexture = texture;
+  }
+
+  Texture *Sprite::getPlaceholderTexture()
+  {
+    return _placeholderTexture;
+  }
+
   void Sprite::drawBeforeChildren( Rect &destinationRect ) const
   {
     Node::drawBeforeChildren( destinationRect );
 
-    if( _texture )
+    Texture *texture = _texture;
+    if( texture && !texture->isReady() && texture->getStatus() == TextureLoading )
+    {
+      texture = _placeholderTexture;
+    }
+    if( texture && texture->isReady() )
     {
       Point center( (int) ( _anchorX * destinationRect.getWidth() ), (int) ( _anchorY * destinationRect.getHeight()) );
-      _texture->setOpacity( _opacity );
+      texture->setOpacity( getDrawOpacity() );
       Game::getInstance()->getRenderer()->renderCopy(
-          _texture,
+          texture,
           NULL,
           &destinationRect,
-          (float const) _rotationAngle,
+          (float const) getDrawRotationAngle(),
           center,
           SDL_FLIP_NONE
       );
@@ -145,10 +221,11 @@ namespace cocosdl {
   void Sprite::stopAllActions( const bool restoreInitialStatus )
   {
     Node::stopAllActions( restoreInitialStatus );
-    if( restoreInitialStatus && _texture != NULL )
+    if( restoreInitialStatus && _texture != NULL && _texture->isReady() )
     {
       _width = _texture->getWidth();
       _height = _texture->getHeight();
+      boundsChanged();
     }
   }
 
@@ -18,19 +18,25 @@
 #define __Sprite_H_
 
 #include "Node.h"
+#include "TextureListener.h"
+#include "ResourceManager.h"
 #include <string>
+#include <memory>
 
 namespace cocosdl {
 
   class Texture;
 
   /**
-   * A Sprite is the basic subclass of Node that provides texture (image) drawing.
+   * A Sprite is the basic subclass of Node that provides texture (image) drawing.<br/>
+   * A sprite can be bound to a texture that is still loading asynchronously: it draws the placeholder texture (if
+   * any) with the placeholder size meanwhile, and takes the texture size once it is loaded.<br/>
+   * Textures set by file name come from the ResourceManager and are shared by every sprite using the same file.
    *
    * @author narciso.cerezo@gmail.com
    * @version 1.0
    */
-  class Sprite : public Node
+  class Sprite : public Node, public TextureListener
   {
 
   public:
@@ -50,6 +56,29 @@ namespace cocosdl {
 
     void setTexture( Texture *texture );
 
+    /**
+     * Load the texture from a resource file in the background, see Texture::loadTextureAsync.
+     *
+     * @param textureFilePath resource file name (including extension, png or jpg).
+     */
+    void setTextureAsync( const std::string &textureFilePath );
+
+    Texture *getTexture() const
+    {
+      return _texture;
+    }
+
+    virtual void textureLoaded( Texture *texture, const bool success );
+
+    /**
+     * Set the texture drawn by sprites whose texture is still loading.
+     *
+     * @param texture the placeholder texture, NULL to draw nothing. It is not owned by sprites.
+     */
+    static void setPlaceholderTexture( Texture *texture );
+
+    static Texture *getPlaceholderTexture();
+
     /**
      * Create a copy of the object with the same class and deep copied properties.
      *
@@ -68,8 +97,25 @@ namespace cocosdl {
   protected:
     Texture   *_texture;
     bool      _cleanTexture;
+    bool      _awaitingTexture;
 
     virtual void drawBeforeChildren( Rect &destinationRect ) const;
+
+    /**
+     * Use a texture made for this sprite alone, such as rendered text, which the sprite deletes when no longer used.
+     * Copies of the sprite share it instead of making their own, until they set another texture.
+     *
+     * @param texture the texture
+     */
+    void setOwnedTexture( Texture *texture );
+
+  private:
+    TextureHandle             _textureHandle;
+    std::shared_ptr<Texture>  _ownedTexture;    // set for clean textures, shared with copies
+
+    void bindTexture( Texture *texture, const bool cleanTexture, const bool adoptSize );
+
+    void releaseTexture();
   };
 
 }
@@ -0,0 +1,349 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include <math.h>
+#include "SpriteBatchNode.h"
+#include "Game.h"
+#include "Log.h"
+#include "Texture.h"
+#include "Renderer.h"
+
+namespace cocosdl
+{
+  static char const *const CLASS_NAME = "SpriteBatchNode";
+
+  // frame indexes are stored in 16 bits
+  static const size_t MAX_FRAMES = 0xFFFF;
+
+  static const float DEGREES_TO_RADIANS = (float) ( M_PI / 180.0 );
+
+  SpriteBatchNode::SpriteBatchNode( Texture *texture, const size_t capacity ) :
+  _texture( texture ), _coordinatesWidth( 0 ), _coordinatesHeight( 0 )
+  {
+    reserve( capacity );
+  }
+
+  SpriteBatchNode::SpriteBatchNode( const std::string &textureFilePath, const size_t capacity ) :
+  _texture( NULL ), _coordinatesWidth( 0 ), _coordinatesHeight( 0 )
+  {
+    _textureHandle = Game::getInstance()->getResources()->loadTexture( textureFilePath );
+    _texture = _textureHandle.get();
+    if( !_texture )
+    {
+      Log::error() << CLASS_NAME << ": can't load texture " << textureFilePath << std::endl;
+    }
+    reserve( capacity );
+  }
+
+  SpriteBatchNode::SpriteBatchNode( const SpriteBatchNode &other ) :
+  Node( other ), _textureHandle( other._textureHandle ), _texture( other._texture ), _frames( other._frames ),
+  _spriteX( other._spriteX ), _spriteY( other._spriteY ), _spriteWidth( other._spriteWidth ),
+  _spriteHeight( other._spriteHeight ), _spriteRotation( other._spriteRotation ), _spriteOpacity( other._spriteOpacity ),
+  _spriteFrame( other._spriteFrame ), _ids( other._ids ), _slots( other._slots ), _freeIds( other._freeIds ),
+  _coordinatesWidth( 0 ), _coordinatesHeight( 0 )
+  {
+  }
+
+  SpriteBatchNode::~SpriteBatchNode()
+  {
+  }
+
+  SpriteBatchNode &SpriteBatchNode::operator = ( const SpriteBatchNode &other )
+  {
+    Node::operator=( other );
+    _textureHandle = other._textureHandle;
+    _texture = other._texture;
+    _frames = other._frames;
+    _spriteX = other._spriteX;
+    _spriteY = other._spriteY;
+    _spriteWidth = other._spriteWidth;
+    _spriteHeight = other._spriteHeight;
+    _spriteRotation = other._spriteRotation;
+    _spriteOpacity = other._spriteOpacity;
+    _spriteFrame = other._spriteFrame;
+    _ids = other._ids;
+    _slots = other._slots;
+    _freeIds = other._freeIds;
+    _coordinatesWidth = 0;
+    _coordinatesHeight = 0;
+    return *this;
+  }
+
+  size_t SpriteBatchNode::addFrame( const Rect &source )
+  {
+    if( _frames.size() >= MAX_FRAMES )
+    {
+      Log::error() << CLASS_NAME << ": too many frames" << std::endl;
+      return 0;
+    }
+    _frames.push_back( source );
+    _coordinatesWidth = 0;
+    contentChanged();
+    return _frames.size();
+  }
+
+  void SpriteBatchNode::reserve( const size_t capacity )
+  {
+    _spriteX.reserve( capacity );
+    _spriteY.reserve( capacity );
+    _spriteWidth.reserve( capacity );
+    _spriteHeight.reserve( capacity );
+    _spriteRotation.reserve( capacity );
+    _spriteOpacity.reserve( capacity );
+    _spriteFrame.reserve( capacity );
+    _ids.reserve( capacity );
+    _slots.reserve( capacity );
+  }
+
+  Uint32 SpriteBatchNode::addSprite( const float x, const float y, const size_t frame )
+  {
+    size_t validFrame = frame < getFrameCount() ? frame : 0;
+    float width, height;
+    getFrameSize( validFrame, width, height );
+
+    Uint32 id;
+    if( _freeIds.empty() )
+    {
+      id = (Uint32) _slots.size();
+      _slots.resize( id + 1 );
+    }
+    else
+    {
+      id = _freeIds.back();
+      _freeIds.pop_back();
+    }
+    _slots[id] = (Uint32) _spriteX.size();
+
+    _spriteX.push_back( x );
+    _spriteY.push_back( y );
+    _spriteWidth.push_back( width );
+    _spriteHeight.push_back( height );
+    _spriteRotation.push_back( 0 );
+    _spriteOpacity.push_back( 1 );
+    _spriteFrame.push_back( (Uint16) validFrame );
+    _ids.push_back( id );
+    contentChanged();
+    return id;
+  }
+
+  void SpriteBatchNode::removeSprite( const Uint32 id )
+  {
+    if( !hasSprite( id ) )
+    {
+      return;
+    }
+    Uint32 index = _slots[id];
+    Uint32 last = (Uint32) _spriteX.size() - 1;
+    if( index != last )
+    {
+      _spriteX[index] = _spriteX[last];
+      _spriteY[index] = _spriteY[last];
+      _spriteWidth[index] = _spriteWidth[last];
+      _spriteHeight[index] = _spriteHeight[last];
+      _spriteRotation[index] = _spriteRotation[last];
+      _spriteOpacity[index] = _spriteOpacity[last];
+      _spriteFrame[index] = _spriteFrame[last];
+      _ids[index] = _ids[last];
+      _slots[_ids[index]] = index;
+    }
+    _spriteX.pop_back();
+    _spriteY.pop_back();
+    _spriteWidth.pop_back();
+    _spriteHeight.pop_back();
+    _spriteRotation.pop_back();
+    _spriteOpacity.pop_back();
+    _spriteFrame.pop_back();
+    _ids.pop_back();
+    _slots[id] = NO_SPRITE;
+    _freeIds.push_back( id );
+    contentChanged();
+  }
+
+  void SpriteBatchNode::removeAllSprites()
+  {
+    _spriteX.clear();
+    _spriteY.clear();
+    _spriteWidth.clear();
+    _spriteHeight.clear();
+    _spriteRotation.clear();
+    _spriteOpacity.clear();
+    _spriteFrame.clear();
+    _ids.clear();
+    _slots.clear();
+    _freeIds.clear();
+    contentChanged();
+  }
+
+  void SpriteBatchNode::setSpriteFrame( const Uint32 id, const size_t frame )
+  {
+    if( !hasSprite( id ) )
+    {
+      Log::error() << CLASS_NAME << ": no sprite " << id << std::endl;
+    }
+    else if( frame < getFrameCount() )
+    {
+      _spriteFrame[_slots[id]] = (Uint16) frame;
+    }
+    else
+    {
+      Log::error() << CLASS_NAME << ": no frame " << frame << std::endl;
+    }
+  }
+
+  void SpriteBatchNode::getFrameSize( const size_t frame, float &width, float &height ) const
+  {
+    if( frame > 0 )
+    {
+      width = _frames[frame - 1].getWidth();
+      height = _frames[frame - 1].getHeight();
+    }
+    else if( _texture && _texture->isReady() )
+    {
+      width = _texture->getWidth();
+      height = _texture->getHeight();
+    }
+    else
+    {
+      width = 0;
+      height = 0;
+    }
+  }
+
+  void SpriteBatchNode::updateFrameCoordinates() const
+  {
+    int textureWidth = _texture->getWidth();
+    int textureHeight = _texture->getHeight();
+    if( textureWidth == _coordinatesWidth && textureHeight == _coordinatesHeight )
+    {
+      return;
+    }
+    _coordinatesWidth = textureWidth;
+    _coordinatesHeight = textureHeight;
+
+    float scaleX = textureWidth > 0 ? 1.0f / textureWidth : 0;
+    float scaleY = textureHeight > 0 ? 1.0f / textureHeight : 0;
+    _frameCoordinates.resize( getFrameCount() );
+    _frameCoordinates[0] = { 0, 0, 1, 1 };
+    for( size_t i = 0; i < _frames.size(); i++ )
+    {
+      const Rect &frame = _frames[i];
+      FrameCoordinates &coordinates = _frameCoordinates[i + 1];
+      coordinates.left = frame.getX() * scaleX;
+      coordinates.top = frame.getY() * scaleY;
+      coordinates.right = ( frame.getX() + frame.getWidth() ) * scaleX;
+      coordinates.bottom = ( frame.getY() + frame.getHeight() ) * scaleY;
+    }
+  }
+
+  void SpriteBatchNode::drawBeforeChildren( Rect &destinationRect ) const
+  {
+    Node::drawBeforeChildren( destinationRect );
+
+    size_t count = _spriteX.size();
+    if( count == 0 || !_texture || !_texture->isReady() )
+    {
+      return;
+    }
+    updateFrameCoordinates();
+
+    // the index buffer only depends on the sprite count, it is extended when the batch grows
+    size_t indexCount = _indices.size() / 6;
+    if( indexCount < count )
+    {
+      _indices.resize( count * 6 );
+      for( size_t i = indexCount; i < count; i++ )
+      {
+        int vertex = (int) ( i * 4 );
+        int *index = &_indices[i * 6];
+        index[0] = vertex;
+        index[1] = vertex + 1;
+        index[2] = vertex + 2;
+        index[3] = vertex;
+        index[4] = vertex + 2;
+        index[5] = vertex + 3;
+      }
+    }
+    _vertices.resize( count * 4 );
+
+    const float originX = (float) destinationRect.getX();
+    const float originY = (float) destinationRect.getY();
+    const float alphaScale = getDrawOpacity() * 255.0f;
+    const FrameCoordinates *frames = _frameCoordinates.data();
+    SDL_Vertex *vertex = _vertices.data();
+    for( size_t i = 0; i < count; i++, vertex += 4 )
+    {
+      const float centerX = originX + _spriteX[i];
+      const float centerY = originY + _spriteY[i];
+      const float halfWidth = _spriteWidth[i] * 0.5f;
+      const float halfHeight = _spriteHeight[i] * 0.5f;
+
+      // corner offsets from the center: top left is -a - b, top right a - b, bottom right a + b, bottom left b - a
+      float ax = halfWidth, ay = 0, bx = 0, by = halfHeight;
+      if( _spriteRotation[i] != 0 )
+      {
+        const float angle = _spriteRotation[i] * DEGREES_TO_RADIANS;
+        const float cosine = cosf( angle );
+        const float sine = sinf( angle );
+        ax = halfWidth * cosine;
+        ay = halfWidth * sine;
+        bx = -halfHeight * sine;
+        by = halfHeight * cosine;
+      }
+      vertex[0].position.x = centerX - ax - bx;
+      vertex[0].position.y = centerY - ay - by;
+      vertex[1].position.x = centerX + ax - bx;
+      vertex[1].position.y = centerY + ay - by;
+      vertex[2].position.x = centerX + ax + bx;
+      vertex[2].position.y = centerY + ay + by;
+      vertex[3].position.x = centerX - ax + bx;
+      vertex[3].position.y = centerY - ay + by;
+
+      const FrameCoordinates &frame = frames[_spriteFrame[i]];
+      vertex[0].tex_coord.x = frame.left;
+      vertex[0].tex_coord.y = frame.top;
+      vertex[1].tex_coord.x = frame.right;
+      vertex[1].tex_coord.y = frame.top;
+      vertex[2].tex_coord.x = frame.right;
+      vertex[2].tex_coord.y = frame.bottom;
+      vertex[3].tex_coord.x = frame.left;
+      vertex[3].tex_coord.y = frame.bottom;
+
+      float opacity = _spriteOpacity[i];
+      opacity = opacity < 0 ? 0 : ( opacity > 1 ? 1 : opacity );
+      const SDL_Color color = { 255, 255, 255, (Uint8) ( opacity * alphaScale ) };
+      vertex[0].color = color;
+      vertex[1].color = color;
+      vertex[2].color = color;
+      vertex[3].color = color;
+    }
+
+    // the texture may be shared with sprites that leave their own opacity set on it
+    _texture->setOpacity( 1 );
+    Game::getInstance()->getRenderer()->renderGeometry(
+        _texture,
+        _vertices.data(),
+        (int) _vertices.size(),
+        _indices.data(),
+        (int) ( count * 6 )
+    );
+  }
+
+  Node *SpriteBatchNode::copy() const
+  {
+    return new SpriteBatchNode( *this );
+  }
+}
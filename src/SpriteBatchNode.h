@@ -0,0 +1,278 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __SpriteBatchNode_H_
+#define __SpriteBatchNode_H_
+
+#include <assert.h>
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+#include "Node.h"
+#include "ResourceManager.h"
+
+namespace cocosdl
+{
+  class Texture;
+
+  /**
+   * A node that draws a large number of lightweight sprites from a single texture or atlas in one geometry batch.<br/>
+   * Batched sprites are not nodes: each one is just a slot in contiguous arrays of position, size, rotation, opacity
+   * and frame, identified by the id returned by addSprite. Adding and removing are O(1): removal moves the last
+   * sprite into the freed slot, so the drawing order of batched sprites is not preserved and must not matter.<br/>
+   * Positions are the sprite centers relative to the top left corner of the batch node, rotation is in degrees
+   * around the center. Frames are source rectangles in the texture; frame 0 is the whole texture. The inline sprite
+   * getters and setters only assert that the id is in use, see hasSprite.<br/>
+   * The batch opacity is applied to every sprite, the batch rotation is not. Below a node cached as bitmap, adding and
+   * removing sprites renders the cache again, changing them does not until contentChanged is called; the batch node
+   * must also be sized to cover its sprites, since caches only capture the rectangles of the nodes.
+   *
+   * @author narciso.cerezo@gmail.com
+   * @version 1.0
+   */
+  class SpriteBatchNode : public Node
+  {
+
+  public:
+    static const Uint32 NO_SPRITE = 0xFFFFFFFF;
+
+    SpriteBatchNode( Texture *texture, const size_t capacity = 0 );
+
+    SpriteBatchNode( const std::string &textureFilePath, const size_t capacity = 0 );
+
+    SpriteBatchNode( const SpriteBatchNode &other );
+
+    virtual ~SpriteBatchNode();
+
+    SpriteBatchNode &operator = ( const SpriteBatchNode &other );
+
+    Texture *getTexture() const
+    {
+      return _texture;
+    }
+
+    /**
+     * Add an atlas frame.
+     *
+     * @param source rectangle of the frame in the texture, in pixels
+     * @return the frame index, 0 if the batch already has the maximum of 65535 frames
+     */
+    size_t addFrame( const Rect &source );
+
+    size_t getFrameCount() const
+    {
+      return _frames.size() + 1;
+    }
+
+    /**
+     * Reserve room for a number of sprites, so adding them does not reallocate the arrays.
+     *
+     * @param capacity number of sprites
+     */
+    void reserve( const size_t capacity );
+
+    /**
+     * Add a sprite, sized as its frame.
+     *
+     * @param x center x relative to the batch node
+     * @param y center y relative to the batch node
+     * @param frame frame index
+     * @return the sprite id, reused once the sprite is removed
+     */
+    Uint32 addSprite( const float x, const float y, const size_t frame = 0 );
+
+    /**
+     * Remove a sprite. The last sprite takes its place in the arrays.
+     *
+     * @param id sprite id
+     */
+    void removeSprite( const Uint32 id );
+
+    void removeAllSprites();
+
+    bool hasSprite( const Uint32 id ) const
+    {
+      return id < _slots.size() && _slots[id] != NO_SPRITE;
+    }
+
+    size_t getSpriteCount() const
+    {
+      return _spriteX.size();
+    }
+
+    /**
+     * Get the array index of a sprite, valid until a sprite is added or removed.
+     *
+     * @param id sprite id
+     * @return the index in the arrays returned by getXs, getYs, etc.
+     */
+    size_t getIndex( const Uint32 id ) const
+    {
+      assert( hasSprite( id ) );
+      return _slots[id];
+    }
+
+    Uint32 getSpriteId( const size_t index ) const
+    {
+      return _ids[index];
+    }
+
+    void setSpritePosition( const Uint32 id, const float x, const float y )
+    {
+      assert( hasSprite( id ) );
+      Uint32 index = _slots[id];
+      _spriteX[index] = x;
+      _spriteY[index] = y;
+    }
+
+    void setSpriteSize( const Uint32 id, const float width, const float height )
+    {
+      assert( hasSprite( id ) );
+      Uint32 index = _slots[id];
+      _spriteWidth[index] = width;
+      _spriteHeight[index] = height;
+    }
+
+    void setSpriteRotation( const Uint32 id, const float rotationAngle )
+    {
+      assert( hasSprite( id ) );
+      _spriteRotation[_slots[id]] = rotationAngle;
+    }
+
+    void setSpriteOpacity( const Uint32 id, const float opacity )
+    {
+      assert( hasSprite( id ) );
+      _spriteOpacity[_slots[id]] = opacity;
+    }
+
+    void setSpriteFrame( const Uint32 id, const size_t frame );
+
+    float getSpriteX( const Uint32 id ) const
+    {
+      assert( hasSprite( id ) );
+      return _spriteX[_slots[id]];
+    }
+
+    float getSpriteY( const Uint32 id ) const
+    {
+      assert( hasSprite( id ) );
+      return _spriteY[_slots[id]];
+    }
+
+    float getSpriteWidth( const Uint32 id ) const
+    {
+      assert( hasSprite( id ) );
+      return _spriteWidth[_slots[id]];
+    }
+
+    float getSpriteHeight( const Uint32 id ) const
+    {
+      assert( hasSprite( id ) );
+      return _spriteHeight[_slots[id]];
+    }
+
+    float getSpriteRotation( const Uint32 id ) const
+    {
+      assert( hasSprite( id ) );
+      return _spriteRotation[_slots[id]];
+    }
+
+    float getSpriteOpacity( const Uint32 id ) const
+    {
+      assert( hasSprite( id ) );
+      return _spriteOpacity[_slots[id]];
+    }
+
+    size_t getSpriteFrame( const Uint32 id ) const
+    {
+      assert( hasSprite( id ) );
+      return _spriteFrame[_slots[id]];
+    }
+
+    /**
+     * Direct access to the sprite arrays, getSpriteCount() long, for systems that update every sprite in a tight
+     * loop. Pointers are invalidated when sprites are added or removed.
+     */
+    float *getXs()
+    {
+      return _spriteX.data();
+    }
+
+    float *getYs()
+    {
+      return _spriteY.data();
+    }
+
+    float *getRotations()
+    {
+      return _spriteRotation.data();
+    }
+
+    float *getOpacities()
+    {
+      return _spriteOpacity.data();
+    }
+
+    /**
+     * Create a copy of the object with the same class and deep copied properties.
+     *
+     * @return a new node deep copied from this one with the same class
+     */
+    virtual Node *copy() const;
+
+  protected:
+    virtual void drawBeforeChildren( Rect &destinationRect ) const;
+
+  private:
+    struct FrameCoordinates
+    {
+      float left;
+      float top;
+      float right;
+      float bottom;
+    };
+
+    TextureHandle         _textureHandle;
+    Texture               *_texture;
+    std::vector<Rect>     _frames;        // atlas frames after the implicit whole texture frame 0
+
+    // sprite arrays, indexed by slot
+    std::vector<float>    _spriteX;
+    std::vector<float>    _spriteY;
+    std::vector<float>    _spriteWidth;
+    std::vector<float>    _spriteHeight;
+    std::vector<float>    _spriteRotation;
+    std::vector<float>    _spriteOpacity;
+    std::vector<Uint16>   _spriteFrame;
+    std::vector<Uint32>   _ids;           // slot to id
+
+    std::vector<Uint32>   _slots;         // id to slot, NO_SPRITE when free
+    std::vector<Uint32>   _freeIds;
+
+    // draw buffers, kept between frames
+    mutable std::vector<FrameCoordinates> _frameCoordinates;
+    mutable int                           _coordinatesWidth;
+    mutable int                           _coordinatesHeight;
+    mutable std::vector<SDL_Vertex>       _vertices;
+    mutable std::vector<int>              _indices;
+
+    void getFrameSize( const size_t frame, float &width, float &height ) const;
+
+    void updateFrameCoordinates() const;
+  };
+}
+
+#endif //__SpriteBatchNode_H_
@@ -15,45 +15,74 @@
 */
 
 #include "Texture.h"
+#include "TextureListener.h"
 #include "Game.h"
-#include <SDL2_image/SDL_image.h>
 #include <iostream>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
 #include "Renderer.h"
+#include "JobSystem.h"
+#include "TextureCache.h"
 
 namespace cocosdl {
 
-  Texture::Texture() : _texture( NULL ), _width( 0 ), _height( 0 ), _fileName( "" )
+  /**
+   * An image being loaded in the background. The decoding job fills the surface, the game thread uploads it.
+   */
+  struct AsyncTextureLoad
+  {
+    Texture     *texture;   // NULL once cancelled, only accessed from the game thread
+    std::string fileName;
+    SDL_Surface *surface;
+  };
+
+  static const Uint32 DEFAULT_UPLOAD_BUDGET_MS = 4;
+
+  static Uint32 _uploadBudgetMs = DEFAULT_UPLOAD_BUDGET_MS;
+  static std::mutex _decodedMutex;
+  static std::deque<std::shared_ptr<AsyncTextureLoad> > _decodedLoads;
+  static std::atomic<size_t> _pendingLoads( 0 );
+
+  Texture::Texture() : _texture( NULL ), _width( 0 ), _height( 0 ), _fileName( "" ), _status( TextureEmpty )
   {
   }
 
-  Texture::Texture( const std::string &fileName )
+  Texture::Texture( const std::string &fileName ) :
+  _texture( NULL ), _width( 0 ), _height( 0 ), _fileName( "" ), _status( TextureEmpty )
   {
     loadTexture( fileName );
   }
 
 
-  Texture::Texture( SDL_Texture *_texture ) : _texture( _texture )
+  Texture::Texture( SDL_Texture *_texture ) :
+  _texture( _texture ), _width( 0 ), _height( 0 ), _fileName( "" ), _status( TextureEmpty )
   {
     if( _texture != NULL )
     {
       SDL_QueryTexture( _texture, NULL, NULL, &_width, &_height );
+      _status = TextureLoaded;
     }
   }
 
-  Texture::Texture( const Texture &other ) : _width( other._width ), _height( other._height ), _fileName( other._fileName )
+  Texture::Texture( const Texture &other ) :
+  _texture( NULL ), _width( other._width ), _height( other._height ), _fileName( other._fileName ),
+  _status( TextureEmpty )
   {
-    if( other._texture != NULL )
+    if( other._asyncLoad )
     {
-      loadTexture( _fileName );
+      loadTextureAsync( other._asyncLoad->fileName );
     }
-    else
+    else if( other._texture != NULL )
     {
-      _texture = NULL;
+      loadTexture( _fileName );
     }
   }
 
   Texture::~Texture()
   {
+    cancelAsyncLoad();
     if( _texture )
     {
       SDL_DestroyTexture( _texture );
@@ -63,35 +92,188 @@ namespace cocosdl {
 
   Texture &Texture::operator = ( const Texture &other )
   {
-    if( _texture )
-    {
-      SDL_DestroyTexture( _texture );
-    }
+    cancelAsyncLoad();
+    setTexture( NULL );
     _fileName = other._fileName;
-    if( other._texture != NULL )
+    _status = TextureEmpty;
+    _width = 0;
+    _height = 0;
+    if( other._asyncLoad )
     {
-      loadTexture( _fileName );
+      loadTextureAsync( other._asyncLoad->fileName );
     }
-    else
+    else if( other._texture != NULL )
     {
-      _texture = NULL;
-      _width = 0;
-      _height = 0;
+      loadTexture( _fileName );
     }
     return *this;
   }
 
   bool Texture::loadTexture( const std::string &fileName )
   {
+    // the listeners of a load in progress get the result of this one
+    detachAsyncLoad();
     Game *game = Game::getInstance();
-    const std::string resPath = game->getResourcePath() + fileName;
-    _texture = IMG_LoadTexture( game->getRenderer()->getSDL_Renderer(), resPath.c_str() );
-    if( _texture != NULL )
+    SDL_Surface *surface = util::TextureCache::loadSurface( fileName );
+    SDL_Texture *texture = NULL;
+    if( surface )
     {
-      SDL_QueryTexture( _texture, NULL, NULL, &_width, &_height );
+      texture = SDL_CreateTextureFromSurface( game->getRenderer()->getSDL_Renderer(), surface );
+      SDL_FreeSurface( surface );
+    }
+    if( texture != NULL )
+    {
+      setTexture( texture );
+      _fileName = fileName;
+      _status = TextureLoaded;
+    }
+    else if( !_texture )
+    {
+      _status = TextureFailed;
+    }
+    notifyListeners( texture != NULL );
+    return texture != NULL;
+  }
+
+  void Texture::loadTextureAsync( const std::string &fileName, TextureListener *listener )
+  {
+    // the listeners of a load in progress wait for this one instead
+    detachAsyncLoad();
+    if( listener )
+    {
+      addListener( listener );
+    }
+    std::shared_ptr<AsyncTextureLoad> load( new AsyncTextureLoad() );
+    load->texture = this;
+    load->fileName = fileName;
+    load->surface = NULL;
+    _asyncLoad = load;
+    _status = TextureLoading;
+    _pendingLoads++;
+
+    util::JobSystem::getInstance()->runAsync( [load]()
+    {
+      load->surface = util::TextureCache::loadSurface( load->fileName );
+      std::lock_guard<std::mutex> lock( _decodedMutex );
+      _decodedLoads.push_back( load );
+    } );
+  }
+
+  void Texture::cancelAsyncLoad()
+  {
+    if( _asyncLoad )
+    {
+      detachAsyncLoad();
+      notifyListeners( false );
+    }
+  }
+
+  void Texture::detachAsyncLoad()
+  {
+    if( _asyncLoad )
+    {
+      // the decoding job still owns the load, it is dropped when its turn to upload comes
+      _asyncLoad->texture = NULL;
+      _asyncLoad.reset();
+      _status = _texture ? TextureLoaded : TextureEmpty;
+    }
+  }
+
+  void Texture::notifyListeners( const bool success )
+  {
+    std::vector<TextureListener *> listeners;
+    listeners.swap( _listeners );
+    for( size_t i = 0; i < listeners.size(); i++ )
+    {
+      listeners.at( i )->textureLoaded( this, success );
+    }
+  }
+
+  void Texture::finishAsyncLoad( SDL_Texture *texture, const std::string &fileName )
+  {
+    _asyncLoad.reset();
+    if( texture )
+    {
+      setTexture( texture );
       _fileName = fileName;
+      _status = TextureLoaded;
+    }
+    else
+    {
+      SDL_Log( "Can't load texture: %s", fileName.c_str() );
+      _status = _texture ? TextureLoaded : TextureFailed;
+    }
+    notifyListeners( texture != NULL );
+  }
+
+  void Texture::addListener( TextureListener *listener )
+  {
+    if( std::find( _listeners.begin(), _listeners.end(), listener ) == _listeners.end() )
+    {
+      _listeners.push_back( listener );
+    }
+  }
+
+  void Texture::removeListener( TextureListener *listener )
+  {
+    std::vector<TextureListener *>::iterator position = std::find( _listeners.begin(), _listeners.end(), listener );
+    if( position != _listeners.end() )
+    {
+      _listeners.erase( position );
+    }
+  }
+
+  size_t Texture::uploadLoadedTextures()
+  {
+    SDL_Renderer *renderer = Game::getInstance()->getRenderer()->getSDL_Renderer();
+    Uint32 start = SDL_GetTicks();
+    size_t uploaded = 0;
+    while( true )
+    {
+      std::shared_ptr<AsyncTextureLoad> load;
+      {
+        std::lock_guard<std::mutex> lock( _decodedMutex );
+        if( _decodedLoads.empty() || ( uploaded > 0 && SDL_GetTicks() - start >= _uploadBudgetMs ) )
+        {
+          break;
+        }
+        load = _decodedLoads.front();
+        _decodedLoads.pop_front();
+      }
+      _pendingLoads--;
+
+      SDL_Texture *texture = NULL;
+      if( load->texture && load->surface )
+      {
+        texture = SDL_CreateTextureFromSurface( renderer, load->surface );
+      }
+      if( load->surface )
+      {
+        SDL_FreeSurface( load->surface );
+        load->surface = NULL;
+      }
+      if( load->texture )
+      {
+        load->texture->finishAsyncLoad( texture, load->fileName );
+        uploaded++;
+      }
     }
-    return _texture != NULL;
+    return uploaded;
+  }
+
+  void Texture::setUploadBudget( const Uint32 budgetMs )
+  {
+    _uploadBudgetMs = budgetMs;
+  }
+
+  Uint32 Texture::getUploadBudget()
+  {
+    return _uploadBudgetMs;
+  }
+
+  size_t Texture::getPendingLoadCount()
+  {
+    return _pendingLoads;
   }
 
 
@@ -19,11 +19,28 @@
 
 #include <SDL2/SDL.h>
 #include <string>
+#include <vector>
+#include <memory>
 
 namespace cocosdl {
 
+  class TextureListener;
+
+  struct AsyncTextureLoad;
+
+  /**
+   * TextureStatus tells whether a texture can be drawn, or is still being loaded asynchronously.
+   */
+  enum TextureStatus
+  {
+    TextureEmpty, TextureLoading, TextureLoaded, TextureFailed
+  };
+
   /**
-   * Represents a texture (image).
+   * Represents a texture (image).<br/>
+   * Textures can be loaded asynchronously with loadTextureAsync: the image is decoded on a worker thread, and then
+   * uploaded on the game thread at the start of a frame, spending at most the upload budget per frame. Until then the
+   * texture has no SDL texture and its status is TextureLoading.
    *
    * @author narciso.cerezo@gmail.com
    * @version 1.0
@@ -61,12 +78,72 @@ namespace cocosdl {
     }
 
     /**
-     * Load a texture from a resource file image.
+     * Load a texture from a resource file image. When util::TextureCache is enabled the pre-decoded image is
+     * uploaded instead of decoding the file.
      *
      * @param fileName resource file name (including extension, png or jpg).
      */
     bool loadTexture( const std::string &fileName );
 
+    /**
+     * Start loading a texture from a resource file image in the background. The current image, if any, is kept
+     * until the new one is ready.
+     *
+     * @param fileName resource file name (including extension, png or jpg).
+     * @param listener optional listener notified when the load finishes
+     */
+    void loadTextureAsync( const std::string &fileName, TextureListener *listener = NULL );
+
+    TextureStatus getStatus() const
+    {
+      return _status;
+    }
+
+    /**
+     * Check if the texture can be drawn. A texture being reloaded asynchronously keeps drawing its previous image.
+     */
+    bool isReady() const
+    {
+      return _texture != NULL;
+    }
+
+    const std::string &getFileName() const
+    {
+      return _fileName;
+    }
+
+    /**
+     * Register a listener to be notified when the current asynchronous load finishes. Listeners are removed once
+     * notified.
+     *
+     * @param listener the listener
+     */
+    void addListener( TextureListener *listener );
+
+    void removeListener( TextureListener *listener );
+
+    /**
+     * Upload the images decoded in the background since the last call. Called by the game at the start of every
+     * frame, it stops once the upload budget is spent (at least one image is always uploaded).
+     *
+     * @return number of textures that finished loading
+     */
+    static size_t uploadLoadedTextures();
+
+    /**
+     * Set the time the game can spend each frame uploading textures loaded asynchronously.
+     *
+     * @param budgetMs budget in milliseconds
+     */
+    static void setUploadBudget( const Uint32 budgetMs );
+
+    static Uint32 getUploadBudget();
+
+    /**
+     * Get the number of asynchronous loads not finished yet.
+     */
+    static size_t getPendingLoadCount();
+
     /**
      * Get the texture width.
      */
@@ -86,13 +163,30 @@ namespace cocosdl {
     void setOpacity( const float opacity );
 
   private:
-    SDL_Texture*  _texture;
-    int           _width;
-    int           _height;
-    std::string   _fileName;
+    SDL_Texture*                      _texture;
+    int                               _width;
+    int                               _height;
+    std::string                       _fileName;
+    TextureStatus                     _status;
+    std::shared_ptr<AsyncTextureLoad> _asyncLoad;
+    std::vector<TextureListener *>    _listeners;
 
 
     void setTexture( SDL_Texture *texture );
+
+    /**
+     * Abandon the load in progress, if any, telling its listeners it failed.
+     */
+    void cancelAsyncLoad();
+
+    /**
+     * Abandon the load in progress, if any, keeping its listeners for the next one.
+     */
+    void detachAsyncLoad();
+
+    void notifyListeners( const bool success );
+
+    void finishAsyncLoad( SDL_Texture *texture, const std::string &fileName );
   };
 
 }
@@ -0,0 +1,52 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __TextureListener_H_
+#define __TextureListener_H_
+
+namespace cocosdl {
+
+  class Texture;
+
+  /**
+   * TextureListener is an interface / protocol to allow objects to be notified when a texture loaded asynchronously
+   * becomes ready. Notifications are always delivered on the game thread.
+   *
+   * @author narciso.cerezo@gmail.com
+   * @version 1.0
+   */
+  class TextureListener
+  {
+
+  public:
+    virtual ~TextureListener()
+    {
+    }
+
+    /**
+     * An asynchronous load has finished.
+     *
+     * @param texture the texture
+     * @param success true if the image was loaded, false if it couldn't be read or uploaded, or the load was
+     * cancelled
+     */
+    virtual void textureLoaded( Texture *texture, const bool success ) = 0;
+
+  };
+
+}
+
+#endif //__TextureListener_H_
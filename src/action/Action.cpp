@@ -17,6 +17,7 @@
 #include "Action.h"
 #include "Node.h"
 #include "ActionPool.h"
+#include "ActionEventQueue.h"
 #include <mutex>
 
 using namespace cocosdl::util;
@@ -29,7 +30,8 @@ namespace cocosdl
   namespace action
   {
 
-    Action::Action() : _actionStatus( Created ), _observer( NULL ), _className( "Action" )
+    Action::Action() :
+    _className( "Action" ), _actionStatus( Created ), _observer( NULL ), _observedEvents( ActionFinishedEvent )
     {
     }
 
@@ -37,7 +39,8 @@ namespace cocosdl
     {
     }
 
-    Action::Action( const Action &other ) : _actionStatus( Created ), _observer( NULL ), _className( "Action" )
+    Action::Action( const Action &other ) :
+    _className( "Action" ), _actionStatus( Created ), _observer( NULL ), _observedEvents( ActionFinishedEvent )
     {
 
     }
@@ -46,6 +49,7 @@ namespace cocosdl
     {
       _actionStatus = Created;
       _observer = other._observer;
+      _observedEvents = other._observedEvents;
       _className = other._className;
       return *this;
     }
@@ -58,27 +62,37 @@ namespace cocosdl
 
     void Action::setActionStatus( ActionStatus const &actionStatus, const Node *node )
     {
+      if( _actionStatus == actionStatus )
+      {
+        return;
+      }
       _actionStatus = actionStatus;
-      if( _observer )
+      switch( _actionStatus )
       {
-        switch( _actionStatus )
-        {
-          case Finished:
-            _observer->actionFinished( this, node );
-            break;
-
-          default:
-            break;
-        }
+        case Started:
+          ActionEventQueue::post( ActionStartedEvent, this, node );
+          break;
+
+        case Finished:
+          ActionEventQueue::post( ActionFinishedEvent, this, node );
+          break;
+
+        default:
+          break;
       }
     }
 
     bool Action::release()
     {
       ActionPool *pool = NULL;
+      _mutex.lock();
       if( _poolMap.find( _className ) != _poolMap.end() )
       {
         pool = _poolMap.at( _className );
+      }
+      _mutex.unlock();
+      if( pool )
+      {
         return pool->release( this );
       }
       else
@@ -87,7 +101,7 @@ namespace cocosdl
       }
     }
 
-    Action *Action::getFromPoolOrCreate( const Action *source, const ActionFactory &factory )
+    Action *Action::fetchFromPool( const Action *source, const ActionFactory &factory )
     {
       ActionPool *pool = NULL;
       _mutex.lock();
@@ -112,7 +126,6 @@ namespace cocosdl
         action = factory.createInstance();
         pool->insert( action );
       }
-      *action = *source;
       return action;
     }
   }
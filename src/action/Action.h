@@ -71,9 +71,21 @@ namespace cocosdl
         return _observer;
       }
 
-      void setObserver( ActionObserver *observer )
+      /**
+       * Set the observer notified of status changes of this action.
+       *
+       * @param observer the observer, NULL for none
+       * @param observedEvents ActionEventType flags of the events to notify
+       */
+      void setObserver( ActionObserver *observer, const int observedEvents = ActionFinishedEvent )
       {
         _observer = observer;
+        _observedEvents = observedEvents;
+      }
+
+      int getObservedEvents() const
+      {
+        return _observedEvents;
       }
 
       /**
@@ -94,6 +106,16 @@ namespace cocosdl
        */
       virtual Action *copy() = 0;
 
+      /**
+       * Whether the action can run on a worker thread, at the same time as the actions of other nodes. That is only
+       * safe for actions that modify nothing but the properties of the node they run on: actions touching the parent,
+       * the children, the scene graph, the game or SDL must return false, which is the default.
+       */
+      virtual bool isConcurrent() const
+      {
+        return false;
+      }
+
       /**
        * Release the action to its pool, if possible.
        * @return true if the action was again accepted in the pool, false if it didn't belong there (must be deleted).
@@ -104,8 +126,28 @@ namespace cocosdl
       std::string     _className;
       ActionStatus    _actionStatus;
       ActionObserver* _observer;
+      int             _observedEvents;
+
+      /**
+       * Get a recycled instance from the pool for the source class, or a new one from the factory if there are no
+       * free instances, and assign the source to it with the class assignment operator, so parameters and children are
+       * copied as in a copy constructor. Subclasses implement copy() with it.<br/>
+       * Pools are keyed by _className, so every class using it must set a class name of its own.
+       *
+       * @param source the action to clone
+       * @param factory factory for the source class, used when the pool has no free instances
+       * @return a copy of source ready to be used on a node
+       */
+      template <class T>
+      static Action *getFromPoolOrCreate( const T *source, const ActionFactory &factory )
+      {
+        T *action = static_cast<T *>( fetchFromPool( source, factory ) );
+        *action = *source;
+        return action;
+      }
 
-      static Action*getFromPoolOrCreate( const Action *source, const ActionFactory &factory );
+    private:
+      static Action *fetchFromPool( const Action *source, const ActionFactory &factory );
     };
 
   }
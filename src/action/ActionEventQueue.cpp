@@ -0,0 +1,185 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "ActionEventQueue.h"
+#include "Action.h"
+#include "RingBuffer.h"
+#include <mutex>
+#include <vector>
+
+using namespace cocosdl::util;
+
+namespace cocosdl
+{
+  namespace action
+  {
+    struct ActionEvent
+    {
+      ActionEventType type;
+      Action          *action;
+      ActionObserver  *observer;
+      const Node      *node;
+    };
+
+    struct ObserverRegistration
+    {
+      ActionObserver  *observer;
+      int             eventTypes;
+    };
+
+    static std::mutex _queueMutex;
+    static RingBuffer<ActionEvent> _events( 256 );
+    static std::vector<Action *> _retiredActions;
+    static std::vector<ObserverRegistration> _observers;
+    static int _observedEventTypes = 0;
+
+    static void notify( ActionObserver *observer, const ActionEvent &event )
+    {
+      switch( event.type )
+      {
+        case ActionStartedEvent:
+          observer->actionStarted( event.action, event.node );
+          break;
+
+        case ActionFinishedEvent:
+          observer->actionFinished( event.action, event.node );
+          break;
+      }
+    }
+
+    static void destroyRetiredActions()
+    {
+      std::vector<Action *> retiredActions;
+      _queueMutex.lock();
+      retiredActions.swap( _retiredActions );
+      _queueMutex.unlock();
+      for( size_t i = 0; i < retiredActions.size(); i++ )
+      {
+        Action *action = retiredActions.at( i );
+        DESTROY_ACTION( action );
+      }
+    }
+
+    void ActionEventQueue::addObserver( ActionObserver *observer, const int eventTypes )
+    {
+      std::lock_guard<std::mutex> lock( _queueMutex );
+      ObserverRegistration registration = { observer, eventTypes };
+      _observers.push_back( registration );
+      _observedEventTypes |= eventTypes;
+    }
+
+    void ActionEventQueue::removeObserver( ActionObserver *observer )
+    {
+      std::lock_guard<std::mutex> lock( _queueMutex );
+      _observedEventTypes = 0;
+      for( size_t i = _observers.size(); i > 0; i-- )
+      {
+        if( _observers.at( i - 1 ).observer == observer )
+        {
+          _observers.erase( _observers.begin() + ( i - 1 ) );
+        }
+        else
+        {
+          _observedEventTypes |= _observers.at( i - 1 ).eventTypes;
+        }
+      }
+    }
+
+    void ActionEventQueue::post( const ActionEventType type, Action *action, const Node *node )
+    {
+      ActionObserver *observer = ( action->getObservedEvents() & type ) ? action->getObserver() : NULL;
+      std::lock_guard<std::mutex> lock( _queueMutex );
+      if( observer || ( _observedEventTypes & type ) )
+      {
+        ActionEvent event = { type, action, observer, node };
+        _events.push( event );
+      }
+    }
+
+    void ActionEventQueue::retire( Action *action )
+    {
+      std::lock_guard<std::mutex> lock( _queueMutex );
+      _retiredActions.push_back( action );
+    }
+
+    void ActionEventQueue::dispatch()
+    {
+      std::vector<ObserverRegistration> observers;
+      ActionEvent event;
+      while( true )
+      {
+        {
+          std::lock_guard<std::mutex> lock( _queueMutex );
+          if( !_events.pop( event ) )
+          {
+            break;
+          }
+          if( _observedEventTypes & event.type )
+          {
+            observers = _observers;
+          }
+          else
+          {
+            observers.clear();
+          }
+        }
+        if( event.observer )
+        {
+          notify( event.observer, event );
+        }
+        for( size_t i = 0; i < observers.size(); i++ )
+        {
+          if( observers.at( i ).eventTypes & event.type )
+          {
+            notify( observers.at( i ).observer, event );
+          }
+        }
+      }
+
+      destroyRetiredActions();
+    }
+
+    void ActionEventQueue::forget( const Node *node )
+    {
+      std::lock_guard<std::mutex> lock( _queueMutex );
+      // keep the other events in posting order
+      size_t count = _events.size();
+      ActionEvent event;
+      for( size_t i = 0; i < count; i++ )
+      {
+        _events.pop( event );
+        if( event.node != node )
+        {
+          _events.push( event );
+        }
+      }
+    }
+
+    void ActionEventQueue::clear()
+    {
+      _queueMutex.lock();
+      _events.clear();
+      _queueMutex.unlock();
+      destroyRetiredActions();
+    }
+
+    size_t ActionEventQueue::getPendingCount()
+    {
+      std::lock_guard<std::mutex> lock( _queueMutex );
+      return _events.size();
+    }
+  }
+}
@@ -0,0 +1,109 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __ActionEventQueue_H_
+#define __ActionEventQueue_H_
+
+#include <stddef.h>
+#include "ActionObserver.h"
+
+namespace cocosdl
+{
+  class Node;
+
+  namespace action
+  {
+    class Action;
+
+    /**
+     * Per-frame queue of action status events.<br/>
+     * Actions post their start and finish events here while running instead of calling observers directly, and the
+     * game dispatches the whole batch after every node has run its actions. Observers are notified in posting order,
+     * and may freely add or remove nodes and actions. Events posted while dispatching are delivered in the same batch.
+     * <br/>
+     * Actions that finish are retired instead of destroyed, so the action pointers delivered to observers stay valid
+     * until the end of the dispatch. Deleting a node drops its queued events, so observers are never notified about a
+     * node that no longer exists. Posting and retiring are thread safe.
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    class ActionEventQueue
+    {
+
+    public:
+      /**
+       * Register an observer for every action of the given event types, in addition to the observers set on each
+       * action.
+       *
+       * @param observer the observer
+       * @param eventTypes ActionEventType flags
+       */
+      static void addObserver( ActionObserver *observer, const int eventTypes );
+
+      /**
+       * Unregister an observer added with addObserver.
+       *
+       * @param observer the observer
+       */
+      static void removeObserver( ActionObserver *observer );
+
+      /**
+       * Queue an event. Called by Action when its status changes.
+       *
+       * @param type event type
+       * @param action the action changing status
+       * @param node the node it is running on
+       */
+      static void post( const ActionEventType type, Action *action, const Node *node );
+
+      /**
+       * Destroy an action (releasing it to its pool when possible) after the next dispatch.
+       *
+       * @param action the action, no longer used by the caller
+       */
+      static void retire( Action *action );
+
+      /**
+       * Notify observers of every queued event, then destroy the retired actions. Called once per frame by the game.
+       */
+      static void dispatch();
+
+      /**
+       * Drop the queued events of a node. Called by the node destructor, also when an observer deletes nodes during
+       * dispatch, so later events of the same batch are not delivered.
+       *
+       * @param node the node being deleted
+       */
+      static void forget( const Node *node );
+
+      /**
+       * Drop every queued event and destroy the retired actions without notifying observers. Called by the game when
+       * it shuts down.
+       */
+      static void clear();
+
+      /**
+       * Get the number of events waiting to be dispatched.
+       *
+       * @return queued events
+       */
+      static size_t getPendingCount();
+    };
+  }
+}
+
+#endif //__ActionEventQueue_H_
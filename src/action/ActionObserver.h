@@ -25,9 +25,20 @@ namespace cocosdl
   {
     class Action;
 
+    /**
+     * Action event types, usable as flags to register observers for several types at once.
+     */
+    enum ActionEventType
+    {
+      ActionStartedEvent = 1,
+      ActionFinishedEvent = 2
+    };
+
     /**
      * ActionObserver is an interface / protocol to allow objects to be notified when actions change status running on a
-     * node.
+     * node.<br/>
+     * Notifications are not delivered while actions run: they are queued and dispatched in a batch once per frame, after
+     * every node has run its actions (see ActionEventQueue), so observers are free to modify the scene.
      *
      * @author narciso.cerezo@gmail.com
      * @version 1.0
@@ -37,7 +48,17 @@ namespace cocosdl
 
     public:
       /**
-       * The action has just finished running on a node.
+       * The action has started running on a node. Only delivered to observers registered for ActionStartedEvent.
+       *
+       * @param action the action being run
+       * @param node the node it has started running on
+       */
+      virtual void actionStarted( Action const *action, Node const *node )
+      {
+      }
+
+      /**
+       * The action has finished running on a node.
        *
        * @param action the action being run
        * @param node the node it has finished running on
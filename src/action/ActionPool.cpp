@@ -66,9 +66,9 @@ namespace cocosdl
         Action* element = _usedInstances.at( i );
         if( action == element )
         {
-          std::vector<Action*>::iterator pos = _usedInstances.begin();
-          pos += i + 1;
-          _usedInstances.erase( pos );
+          // order doesn't matter, swap with the last one to avoid shifting the rest
+          _usedInstances[i] = _usedInstances.back();
+          _usedInstances.pop_back();
           _freeInstances.push_back( action );
           _mutex.unlock();
           return true;
@@ -78,13 +78,16 @@ namespace cocosdl
       return false;
     }
 
-    void ActionPool::insert( Action *action )
+    bool ActionPool::insert( Action *action )
     {
+      bool inserted = false;
       _mutex.lock();
       if( _usedInstances.size() + _freeInstances.size() < _size ) {
-        _freeInstances.push_back( action );
+        _usedInstances.push_back( action );
+        inserted = true;
       }
       _mutex.unlock();
+      return inserted;
     }
   }
 }
@@ -35,10 +35,30 @@ namespace cocosdl
 
       virtual ~ActionPool();
 
+      /**
+       * Fetch a free instance, marking it as in use.
+       *
+       * @param action set to the fetched instance
+       * @return true if there was a free instance, false if the pool is empty
+       */
       bool fetch( Action* &action );
+
+      /**
+       * Return an instance in use to the free list.
+       *
+       * @param action the instance
+       * @return true if the instance belongs to the pool, false otherwise (it must then be deleted)
+       */
       bool release( Action* action );
 
-      void insert( Action* action );
+      /**
+       * Register a newly created instance as in use, so it's recycled when released. Instances beyond the pool size
+       * are not registered, and are deleted when released.
+       *
+       * @param action the new instance
+       * @return true if the pool took the instance
+       */
+      bool insert( Action* action );
 
       /**
        * Get the size (maximum of objects) of the pool.
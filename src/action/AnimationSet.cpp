@@ -0,0 +1,567 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <string.h>
+#include "AnimationSet.h"
+#include "Game.h"
+#include "Log.h"
+#include "SequenceAction.h"
+#include "GroupAction.h"
+#include "RepeatForeverAction.h"
+#include "MoveToAction.h"
+#include "MoveByAction.h"
+#include "ResizeToAction.h"
+#include "ResizeByAction.h"
+#include "RotateToAction.h"
+#include "RotateByAction.h"
+#include "FadeInAction.h"
+#include "FadeOutAction.h"
+#include "WaitAction.h"
+#include "PlayEffectAction.h"
+#include "RemoveFromParentAction.h"
+#include "TiltLabelFontAction.h"
+
+namespace cocosdl
+{
+  namespace action
+  {
+    static const Uint8 MAGIC[4] = { 'C', 'D', 'L', 'A' };
+    static const size_t HEADER_SIZE = 12;
+    static const size_t INDEX_ENTRY_SIZE = 12;
+    static const int MAX_DEPTH = 64;
+
+    static void putU8( std::vector<Uint8> &out, const Uint8 value )
+    {
+      out.push_back( value );
+    }
+
+    static void putU32( std::vector<Uint8> &out, const Uint32 value )
+    {
+      for( int i = 0; i < 4; i++ )
+      {
+        out.push_back( (Uint8) ( value >> ( 8 * i ) ) );
+      }
+    }
+
+    static void putU64( std::vector<Uint8> &out, const Uint64 value )
+    {
+      for( int i = 0; i < 8; i++ )
+      {
+        out.push_back( (Uint8) ( value >> ( 8 * i ) ) );
+      }
+    }
+
+    static void putF64( std::vector<Uint8> &out, const double value )
+    {
+      Uint64 bits;
+      memcpy( &bits, &value, sizeof( bits ) );
+      putU64( out, bits );
+    }
+
+    static void setU32( std::vector<Uint8> &out, const size_t offset, const Uint32 value )
+    {
+      for( int i = 0; i < 4; i++ )
+      {
+        out[offset + i] = (Uint8) ( value >> ( 8 * i ) );
+      }
+    }
+
+    static bool getU8( const Uint8 *data, const size_t size, size_t &offset, Uint8 &value )
+    {
+      if( offset + 1 > size )
+      {
+        return false;
+      }
+      value = data[offset++];
+      return true;
+    }
+
+    static bool getU32( const Uint8 *data, const size_t size, size_t &offset, Uint32 &value )
+    {
+      if( offset + 4 > size )
+      {
+        return false;
+      }
+      value = 0;
+      for( int i = 0; i < 4; i++ )
+      {
+        value |= ( (Uint32) data[offset++] ) << ( 8 * i );
+      }
+      return true;
+    }
+
+    static bool getU64( const Uint8 *data, const size_t size, size_t &offset, Uint64 &value )
+    {
+      if( offset + 8 > size )
+      {
+        return false;
+      }
+      value = 0;
+      for( int i = 0; i < 8; i++ )
+      {
+        value |= ( (Uint64) data[offset++] ) << ( 8 * i );
+      }
+      return true;
+    }
+
+    /**
+     * Get an action from the pool of its class, as copies do, with the parameters of a prototype built on the stack.
+     */
+    template <class T, class... Args>
+    static T *createPooled( Args... args )
+    {
+      T prototype( args... );
+      return static_cast<T *>( prototype.copy() );
+    }
+
+    static bool getF64( const Uint8 *data, const size_t size, size_t &offset, double &value )
+    {
+      Uint64 bits;
+      if( !getU64( data, size, offset, bits ) )
+      {
+        return false;
+      }
+      memcpy( &value, &bits, sizeof( value ) );
+      return true;
+    }
+
+    AnimationSet::AnimationSet() : _data( NULL ), _size( 0 )
+    {
+    }
+
+    AnimationSet::~AnimationSet()
+    {
+    }
+
+    bool AnimationSet::load( const std::string &fileName )
+    {
+      Game *game = Game::getInstance();
+      size_t archivedSize;
+      const void *archived = game->getArchivedResource( fileName, archivedSize );
+      if( archived )
+      {
+        // packed sets are used in place, the archive lives as long as the game
+        return loadFromMemory( archived, archivedSize );
+      }
+      SDL_RWops *rw = game->openResource( fileName );
+      if( !rw )
+      {
+        Log::error() << "Can't open animation set " << fileName << std::endl;
+        return false;
+      }
+      Sint64 size = SDL_RWsize( rw );
+      bool ok = size > 0;
+      if( ok )
+      {
+        _buffer.resize( (size_t) size );
+        ok = SDL_RWread( rw, &_buffer[0], (size_t) size, 1 ) == 1;
+      }
+      SDL_RWclose( rw );
+      if( !ok )
+      {
+        _buffer.clear();
+        Log::error() << "Can't read animation set " << fileName << std::endl;
+        return false;
+      }
+      _data = &_buffer[0];
+      _size = _buffer.size();
+      return parse();
+    }
+
+    bool AnimationSet::loadFromMemory( const void *data, const size_t size )
+    {
+      _buffer.clear();
+      _data = static_cast<const Uint8 *>( data );
+      _size = size;
+      return parse();
+    }
+
+    bool AnimationSet::parse()
+    {
+      _entries.clear();
+      size_t offset = 0;
+      Uint32 version;
+      Uint32 count;
+      if( _size < HEADER_SIZE || memcmp( _data, MAGIC, sizeof( MAGIC ) ) != 0 )
+      {
+        Log::error() << "Not an animation set" << std::endl;
+        return false;
+      }
+      offset += sizeof( MAGIC );
+      getU32( _data, _size, offset, version );
+      getU32( _data, _size, offset, count );
+      if( version != FORMAT_VERSION || count > ( _size - HEADER_SIZE ) / INDEX_ENTRY_SIZE )
+      {
+        Log::error() << "Unsupported or corrupt animation set" << std::endl;
+        return false;
+      }
+      _entries.reserve( count );
+      for( Uint32 i = 0; i < count; i++ )
+      {
+        Uint32 nameOffset;
+        Uint32 nameLength;
+        Uint32 treeOffset;
+        getU32( _data, _size, offset, nameOffset );
+        getU32( _data, _size, offset, nameLength );
+        getU32( _data, _size, offset, treeOffset );
+        if( (size_t) nameOffset + nameLength > _size || treeOffset >= _size )
+        {
+          Log::error() << "Corrupt animation set index" << std::endl;
+          _entries.clear();
+          return false;
+        }
+        Entry entry;
+        entry.name.assign( (const char *) _data + nameOffset, nameLength );
+        entry.treeOffset = treeOffset;
+        _entries.push_back( entry );
+      }
+      return true;
+    }
+
+    Action *AnimationSet::create( const std::string &name ) const
+    {
+      size_t count = _entries.size();
+      for( size_t i = 0; i < count; i++ )
+      {
+        if( _entries.at( i ).name == name )
+        {
+          return create( i );
+        }
+      }
+      return NULL;
+    }
+
+    Action *AnimationSet::create( const size_t index ) const
+    {
+      if( index >= _entries.size() )
+      {
+        return NULL;
+      }
+      size_t offset = _entries.at( index ).treeOffset;
+      return readAction( offset, 0 );
+    }
+
+    Action *AnimationSet::readAction( size_t &offset, const int depth ) const
+    {
+      Uint8 opcode;
+      if( depth > MAX_DEPTH || !getU8( _data, _size, offset, opcode ) )
+      {
+        return NULL;
+      }
+
+      Uint32 count;
+      Uint64 duration;
+      Uint32 a;
+      Uint32 b;
+      double angle;
+      switch( opcode )
+      {
+        case AnimationSequence:
+        case AnimationGroup:
+        {
+          if( !getU32( _data, _size, offset, count ) )
+          {
+            return NULL;
+          }
+          SequenceAction *sequence = opcode == AnimationSequence ? createPooled<SequenceAction>() : NULL;
+          GroupAction *group = opcode == AnimationGroup ? createPooled<GroupAction>() : NULL;
+          Action *result = sequence ? (Action *) sequence : (Action *) group;
+          for( Uint32 i = 0; i < count; i++ )
+          {
+            Action *child = readAction( offset, depth + 1 );
+            if( !child )
+            {
+              DESTROY_ACTION( result );
+              return NULL;
+            }
+            if( sequence )
+            {
+              sequence->addAction( child );
+            }
+            else
+            {
+              group->addAction( child );
+            }
+          }
+          return result;
+        }
+
+        case AnimationRepeatForever:
+        {
+          Action *child = readAction( offset, depth + 1 );
+          if( !child )
+          {
+            return NULL;
+          }
+          // the child is handed over as read, instead of copied from a prototype
+          RepeatForeverAction *repeat = createPooled<RepeatForeverAction>( (Action *) NULL );
+          repeat->_child = child;
+          return repeat;
+        }
+
+        case AnimationMoveTo:
+        case AnimationMoveBy:
+        case AnimationResizeTo:
+        case AnimationResizeBy:
+          if( !getU64( _data, _size, offset, duration ) ||
+              !getU32( _data, _size, offset, a ) ||
+              !getU32( _data, _size, offset, b ) )
+          {
+            return NULL;
+          }
+          switch( opcode )
+          {
+            case AnimationMoveTo:
+              return createPooled<MoveToAction>( (long long) duration, (Sint32) a, (Sint32) b );
+            case AnimationMoveBy:
+              return createPooled<MoveByAction>( (long long) duration, (Sint32) a, (Sint32) b );
+            case AnimationResizeTo:
+              return createPooled<ResizeToAction>( (long long) duration, (Sint32) a, (Sint32) b );
+            default:
+              return createPooled<ResizeByAction>( (long long) duration, (Sint32) a, (Sint32) b );
+          }
+
+        case AnimationRotateTo:
+        case AnimationRotateBy:
+          if( !getU64( _data, _size, offset, duration ) || !getF64( _data, _size, offset, angle ) )
+          {
+            return NULL;
+          }
+          if( opcode == AnimationRotateTo )
+          {
+            return createPooled<RotateToAction>( (long long) duration, angle );
+          }
+          return createPooled<RotateByAction>( (long long) duration, angle );
+
+        case AnimationFadeIn:
+        case AnimationFadeOut:
+        case AnimationWait:
+          if( !getU64( _data, _size, offset, duration ) )
+          {
+            return NULL;
+          }
+          if( opcode == AnimationFadeIn )
+          {
+            return createPooled<FadeInAction>( (long long) duration );
+          }
+          if( opcode == AnimationFadeOut )
+          {
+            return createPooled<FadeOutAction>( (long long) duration );
+          }
+          return createPooled<WaitAction>( (long long) duration );
+
+        case AnimationPlayEffect:
+          if( !getU32( _data, _size, offset, count ) || offset + count > _size )
+          {
+            return NULL;
+          }
+          offset += count;
+          return createPooled<PlayEffectAction>( std::string( (const char *) _data + offset - count, count ) );
+
+        case AnimationRemoveFromParent:
+          return createPooled<RemoveFromParentAction>();
+
+        case AnimationTiltLabelFont:
+          if( !getU64( _data, _size, offset, duration ) || !getU32( _data, _size, offset, a ) )
+          {
+            return NULL;
+          }
+          return createPooled<TiltLabelFontAction>( (long long) duration, (Sint32) a );
+
+        default:
+          Log::error() << "Unknown animation opcode " << (int) opcode << std::endl;
+          return NULL;
+      }
+    }
+
+    AnimationWriter::AnimationWriter()
+    {
+    }
+
+    AnimationWriter::~AnimationWriter()
+    {
+    }
+
+    bool AnimationWriter::addAnimation( const std::string &name, const Action *action )
+    {
+      std::vector<Uint8> tree;
+      if( !action || !writeAction( tree, action ) )
+      {
+        return false;
+      }
+      _names.push_back( name );
+      _trees.push_back( tree );
+      return true;
+    }
+
+    bool AnimationWriter::writeAction( std::vector<Uint8> &out, const Action *action ) const
+    {
+      if( const SequenceAction *sequence = dynamic_cast<const SequenceAction *>( action ) )
+      {
+        putU8( out, AnimationSequence );
+        putU32( out, (Uint32) sequence->_actions.size() );
+        for( size_t i = 0; i < sequence->_actions.size(); i++ )
+        {
+          if( !writeAction( out, sequence->_actions.at( i ) ) )
+          {
+            return false;
+          }
+        }
+        return true;
+      }
+      if( const GroupAction *group = dynamic_cast<const GroupAction *>( action ) )
+      {
+        putU8( out, AnimationGroup );
+        putU32( out, (Uint32) group->_actions.size() );
+        for( size_t i = 0; i < group->_actions.size(); i++ )
+        {
+          if( !writeAction( out, group->_actions.at( i ) ) )
+          {
+            return false;
+          }
+        }
+        return true;
+      }
+      if( const RepeatForeverAction *repeat = dynamic_cast<const RepeatForeverAction *>( action ) )
+      {
+        putU8( out, AnimationRepeatForever );
+        return repeat->_child && writeAction( out, repeat->_child );
+      }
+      if( const MoveToAction *moveTo = dynamic_cast<const MoveToAction *>( action ) )
+      {
+        putU8( out, AnimationMoveTo );
+        putU64( out, (Uint64) moveTo->getDurationMs() );
+        putU32( out, (Uint32) moveTo->_x1 );
+        putU32( out, (Uint32) moveTo->_y1 );
+        return true;
+      }
+      if( const MoveByAction *moveBy = dynamic_cast<const MoveByAction *>( action ) )
+      {
+        putU8( out, AnimationMoveBy );
+        putU64( out, (Uint64) moveBy->getDurationMs() );
+        putU32( out, (Uint32) moveBy->_xDelta );
+        putU32( out, (Uint32) moveBy->_yDelta );
+        return true;
+      }
+      if( const ResizeToAction *resizeTo = dynamic_cast<const ResizeToAction *>( action ) )
+      {
+        putU8( out, AnimationResizeTo );
+        putU64( out, (Uint64) resizeTo->getDurationMs() );
+        putU32( out, (Uint32) resizeTo->_width1 );
+        putU32( out, (Uint32) resizeTo->_height1 );
+        return true;
+      }
+      if( const ResizeByAction *resizeBy = dynamic_cast<const ResizeByAction *>( action ) )
+      {
+        putU8( out, AnimationResizeBy );
+        putU64( out, (Uint64) resizeBy->getDurationMs() );
+        putU32( out, (Uint32) resizeBy->_widthDelta );
+        putU32( out, (Uint32) resizeBy->_heightDelta );
+        return true;
+      }
+      if( const RotateToAction *rotateTo = dynamic_cast<const RotateToAction *>( action ) )
+      {
+        putU8( out, AnimationRotateTo );
+        putU64( out, (Uint64) rotateTo->getDurationMs() );
+        putF64( out, rotateTo->_angle1 );
+        return true;
+      }
+      if( const RotateByAction *rotateBy = dynamic_cast<const RotateByAction *>( action ) )
+      {
+        putU8( out, AnimationRotateBy );
+        putU64( out, (Uint64) rotateBy->getDurationMs() );
+        putF64( out, rotateBy->_angleDelta );
+        return true;
+      }
+      if( const FadeInAction *fadeIn = dynamic_cast<const FadeInAction *>( action ) )
+      {
+        putU8( out, AnimationFadeIn );
+        putU64( out, (Uint64) fadeIn->getDurationMs() );
+        return true;
+      }
+      if( const FadeOutAction *fadeOut = dynamic_cast<const FadeOutAction *>( action ) )
+      {
+        putU8( out, AnimationFadeOut );
+        putU64( out, (Uint64) fadeOut->getDurationMs() );
+        return true;
+      }
+      if( const WaitAction *wait = dynamic_cast<const WaitAction *>( action ) )
+      {
+        putU8( out, AnimationWait );
+        putU64( out, (Uint64) wait->getDurationMs() );
+        return true;
+      }
+      if( const PlayEffectAction *playEffect = dynamic_cast<const PlayEffectAction *>( action ) )
+      {
+        putU8( out, AnimationPlayEffect );
+        putU32( out, (Uint32) playEffect->_name.size() );
+        out.insert( out.end(), playEffect->_name.begin(), playEffect->_name.end() );
+        return true;
+      }
+      if( dynamic_cast<const RemoveFromParentAction *>( action ) )
+      {
+        putU8( out, AnimationRemoveFromParent );
+        return true;
+      }
+      if( const TiltLabelFontAction *tilt = dynamic_cast<const TiltLabelFontAction *>( action ) )
+      {
+        putU8( out, AnimationTiltLabelFont );
+        putU64( out, (Uint64) tilt->getDurationMs() );
+        putU32( out, (Uint32) tilt->_delta );
+        return true;
+      }
+      Log::error() << "Action can't be exported to an animation set" << std::endl;
+      return false;
+    }
+
+    void AnimationWriter::getData( std::vector<Uint8> &data ) const
+    {
+      size_t count = _names.size();
+      data.clear();
+      data.insert( data.end(), MAGIC, MAGIC + sizeof( MAGIC ) );
+      putU32( data, AnimationSet::FORMAT_VERSION );
+      putU32( data, (Uint32) count );
+      size_t indexOffset = data.size();
+      data.resize( indexOffset + count * INDEX_ENTRY_SIZE );
+      for( size_t i = 0; i < count; i++ )
+      {
+        const std::string &name = _names.at( i );
+        const std::vector<Uint8> &tree = _trees.at( i );
+        size_t entry = indexOffset + i * INDEX_ENTRY_SIZE;
+        setU32( data, entry, (Uint32) data.size() );
+        setU32( data, entry + 4, (Uint32) name.size() );
+        data.insert( data.end(), name.begin(), name.end() );
+        setU32( data, entry + 8, (Uint32) data.size() );
+        data.insert( data.end(), tree.begin(), tree.end() );
+      }
+    }
+
+    bool AnimationWriter::save( const std::string &filePath ) const
+    {
+      std::vector<Uint8> data;
+      getData( data );
+      SDL_RWops *rw = SDL_RWFromFile( filePath.c_str(), "wb" );
+      if( !rw )
+      {
+        Log::error() << "Can't create animation set " << filePath << std::endl;
+        return false;
+      }
+      bool ok = SDL_RWwrite( rw, &data[0], data.size(), 1 ) == 1;
+      SDL_RWclose( rw );
+      return ok;
+    }
+  }
+}
@@ -0,0 +1,198 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __AnimationSet_H_
+#define __AnimationSet_H_
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <SDL2/SDL.h>
+
+namespace cocosdl
+{
+  namespace action
+  {
+    class Action;
+
+    /**
+     * Node types of the binary animation format. Values are stored in files, never reorder them.
+     */
+    enum AnimationOpcode
+    {
+      AnimationSequence = 1,
+      AnimationGroup = 2,
+      AnimationRepeatForever = 3,
+      AnimationMoveTo = 4,
+      AnimationMoveBy = 5,
+      AnimationResizeTo = 6,
+      AnimationResizeBy = 7,
+      AnimationRotateTo = 8,
+      AnimationRotateBy = 9,
+      AnimationFadeIn = 10,
+      AnimationFadeOut = 11,
+      AnimationWait = 12,
+      AnimationPlayEffect = 13,
+      AnimationRemoveFromParent = 14,
+      AnimationTiltLabelFont = 15
+    };
+
+    /**
+     * A set of named action trees loaded from the compact binary animation format written by AnimationWriter.<br/>
+     * The whole file is brought in with a single read (or used in place from memory the caller keeps alive, such as a
+     * mapped archive), and each call to create instantiates a tree with one linear pass over its encoded nodes, taking
+     * the actions from the action pools as copies do.<br/>
+     * File layout (all integers little endian):
+     * <pre>
+     *   "CDLA" u32 version, u32 animationCount
+     *   animationCount x ( u32 nameOffset, u32 nameLength, u32 treeOffset )
+     *   names and trees, each tree encoded in pre-order as u8 opcode followed by its parameters
+     * </pre>
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    class AnimationSet
+    {
+
+    public:
+      static const Uint32 FORMAT_VERSION = 1;
+
+      AnimationSet();
+
+      virtual ~AnimationSet();
+
+      /**
+       * Load an animation set from a resource file. Sets packed in a mounted asset archive are used in place.
+       *
+       * @param fileName resource file name (including extension)
+       * @return true if the file was read and is a valid animation set
+       */
+      bool load( const std::string &fileName );
+
+      /**
+       * Use an animation set already in memory. The data is not copied, it must stay valid while the set is in use.
+       *
+       * @param data encoded animation set
+       * @param size data size in bytes
+       * @return true if the data is a valid animation set
+       */
+      bool loadFromMemory( const void *data, const size_t size );
+
+      /**
+       * Get the number of animations in the set.
+       *
+       * @return animation count
+       */
+      size_t getCount() const
+      {
+        return _entries.size();
+      }
+
+      /**
+       * Get the name of an animation.
+       *
+       * @param index animation index, from 0 to getCount() - 1
+       * @return animation name
+       */
+      const std::string &getName( const size_t index ) const
+      {
+        return _entries.at( index ).name;
+      }
+
+      /**
+       * Create a new action tree for the named animation, ready to be added to a node.
+       *
+       * @param name animation name
+       * @return the action, NULL if there is no such animation or its data is corrupt
+       */
+      Action *create( const std::string &name ) const;
+
+      /**
+       * Create a new action tree for an animation.
+       *
+       * @param index animation index, from 0 to getCount() - 1
+       * @return the action, NULL if its data is corrupt
+       */
+      Action *create( const size_t index ) const;
+
+    private:
+      struct Entry
+      {
+        std::string name;
+        size_t      treeOffset;
+      };
+
+      std::vector<Uint8>  _buffer;
+      const Uint8         *_data;
+      size_t              _size;
+      std::vector<Entry>  _entries;
+
+      bool parse();
+
+      Action *readAction( size_t &offset, const int depth ) const;
+    };
+
+    /**
+     * Exports in-memory action trees to the binary animation format read by AnimationSet. Only the built-in
+     * Sequence, Group, RepeatForever, MoveTo, MoveBy, ResizeTo, ResizeBy, RotateTo, RotateBy, FadeIn, FadeOut, Wait,
+     * PlayEffect, RemoveFromParent and TiltLabelFont actions can be exported.
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    class AnimationWriter
+    {
+
+    public:
+      AnimationWriter();
+
+      virtual ~AnimationWriter();
+
+      /**
+       * Encode an action tree under the given name. The action is not modified nor retained.
+       *
+       * @param name animation name
+       * @param action root of the action tree
+       * @return true if every action in the tree could be encoded
+       */
+      bool addAnimation( const std::string &name, const Action *action );
+
+      /**
+       * Get the encoded animation set.
+       *
+       * @param data buffer to fill with the encoded set
+       */
+      void getData( std::vector<Uint8> &data ) const;
+
+      /**
+       * Write the encoded animation set to a file.
+       *
+       * @param filePath full path of the file to write
+       * @return true if the file was written
+       */
+      bool save( const std::string &filePath ) const;
+
+    private:
+      std::vector<std::string>          _names;
+      std::vector<std::vector<Uint8> >  _trees;
+
+      bool writeAction( std::vector<Uint8> &out, const Action *action ) const;
+    };
+  }
+}
+
+#endif //__AnimationSet_H_
@@ -65,6 +65,11 @@ namespace cocosdl
       return getFromPoolOrCreate( this, fadeInActionFactory );
     }
 
+    bool FadeInAction::isConcurrent() const
+    {
+      return !Node::isEagerInheritance();
+    }
+
     Action *FadeInActionFactory::createInstance() const
     {
       return new FadeInAction( 0 );
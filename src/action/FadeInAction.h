@@ -57,6 +57,11 @@ namespace cocosdl
        */
       virtual Action *copy();
 
+      /**
+       * Concurrent unless children inherit by propagation, see Node::setEagerInheritance.
+       */
+      virtual bool isConcurrent() const;
+
     protected:
       /**
        * Run the action.<br/>
@@ -63,6 +63,11 @@ namespace cocosdl
       return getFromPoolOrCreate( this, fadeOutActionFactory );
     }
 
+    bool FadeOutAction::isConcurrent() const
+    {
+      return !Node::isEagerInheritance();
+    }
+
     Action *FadeOutActionFactory::createInstance() const
     {
       return new FadeOutAction( 0 );
@@ -64,6 +64,11 @@ namespace cocosdl
        */
       virtual Action *copy();
 
+      /**
+       * Concurrent unless children inherit by propagation, see Node::setEagerInheritance.
+       */
+      virtual bool isConcurrent() const;
+
     };
 
     class FadeOutActionFactory : public ActionFactory
@@ -44,11 +44,14 @@ namespace cocosdl
     GroupAction &GroupAction::operator = ( const GroupAction &other )
     {
       Action::operator=( other );
-      removeAll();
-      size_t count = other._actions.size();
-      for( size_t i = 0; i < count; i++ )
+      if( this != &other )
       {
-        addAction( other._actions.at( i )->copy() );
+        removeAll();
+        size_t count = other._actions.size();
+        for( size_t i = 0; i < count; i++ )
+        {
+          addAction( other._actions.at( i )->copy() );
+        }
       }
       return *this;
     }
@@ -95,6 +98,19 @@ namespace cocosdl
       setActionStatus( status, node );
     }
 
+    bool GroupAction::isConcurrent() const
+    {
+      size_t count = _actions.size();
+      for( size_t i = 0; i < count; i++ )
+      {
+        if( !_actions.at( i )->isConcurrent() )
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
     Action *GroupAction::copy()
     {
       return getFromPoolOrCreate( this, groupActionFactory );
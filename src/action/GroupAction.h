@@ -26,6 +26,7 @@ namespace cocosdl
 
   namespace action
   {
+    class AnimationWriter;
     class GroupActionFactory;
 
     /**
@@ -37,6 +38,7 @@ namespace cocosdl
     class GroupAction : public Action
     {
       friend class GroupActionFactory;
+      friend class AnimationWriter;
 
     public:
       GroupAction();
@@ -68,6 +70,11 @@ namespace cocosdl
        */
       virtual Action *copy();
 
+      /**
+       * Concurrent only if every child action is.
+       */
+      virtual bool isConcurrent() const;
+
       /**
        * Reset the action to the initial status so it can be applied to other nodes.
        *
@@ -23,6 +23,7 @@ namespace cocosdl
 {
   namespace action
   {
+    class AnimationWriter;
     class MoveByActionFactory;
 
     /**
@@ -34,6 +35,7 @@ namespace cocosdl
     class MoveByAction : public TimedAction
     {
       friend class MoveByActionFactory;
+      friend class AnimationWriter;
 
     public:
       /**
@@ -56,6 +58,11 @@ namespace cocosdl
        */
       virtual Action *copy();
 
+      virtual bool isConcurrent() const
+      {
+        return true;
+      }
+
     protected:
       int _x0;
       int _y0;
@@ -24,6 +24,7 @@ namespace cocosdl
   namespace action
   {
 
+    class AnimationWriter;
     class MoveToActionFactory;
 
     /**
@@ -35,6 +36,7 @@ namespace cocosdl
     class MoveToAction : public TimedAction
     {
       friend class MoveToActionFactory;
+      friend class AnimationWriter;
 
     public:
       /**
@@ -57,6 +59,11 @@ namespace cocosdl
        */
       virtual Action *copy();
 
+      virtual bool isConcurrent() const
+      {
+        return true;
+      }
+
     protected:
       int _x0;
       int _y0;
@@ -31,7 +31,7 @@ namespace cocosdl
       _className = CLASS_NAME;
     }
 
-    PlayEffectAction::PlayEffectAction( const PlayEffectAction &other ) : Action( other ), _name( other._name )
+    PlayEffectAction::PlayEffectAction( const PlayEffectAction &other ) : Action( other ), _name( other._name ), _sound( other._sound )
     {
       _className = CLASS_NAME;
     }
@@ -42,21 +42,33 @@ namespace cocosdl
 
     PlayEffectAction &PlayEffectAction::operator = ( const PlayEffectAction &other )
     {
+      Action::operator=( other );
       _name = other._name;
+      _sound = other._sound;
       return *this;
     }
 
     void PlayEffectAction::run( Node *node )
     {
-      Game::getInstance()->playSound( _name );
+      resolveSound();
+      Game::getInstance()->playSound( _sound );
       setActionStatus( Finished, node );
     }
 
     Action *PlayEffectAction::copy()
     {
+      resolveSound();
       return getFromPoolOrCreate( this, playEffectActionFactory );
     }
 
+    void PlayEffectAction::resolveSound()
+    {
+      if( !_sound.isValid() && !_name.empty() )
+      {
+        _sound = Game::getInstance()->getResources()->loadSound( _name );
+      }
+    }
+
     Action *PlayEffectActionFactory::createInstance() const
     {
       return new PlayEffectAction( "" );
@@ -19,6 +19,7 @@
 
 #include "Action.h"
 #include "Node.h"
+#include "ResourceManager.h"
 #include <string>
 
 namespace cocosdl
@@ -26,10 +27,11 @@ namespace cocosdl
   namespace action
   {
     // ToDo: implement threaded sound queue
+    class AnimationWriter;
     class PlayEffectActionFactory;
 
     /**
-     * Play a sound effect.
+     * Play a sound effect. The sound is resolved on first use and its handle shared with the copies of the action.
      *
      * @author narciso.cerezo@gmail.com
      * @version 1.0
@@ -37,6 +39,7 @@ namespace cocosdl
     class PlayEffectAction : public Action
     {
       friend class PlayEffectActionFactory;
+      friend class AnimationWriter;
 
     public:
       /**
@@ -65,6 +68,10 @@ namespace cocosdl
 
     protected:
       std::string _name;
+      SoundHandle _sound;
+
+    private:
+      void resolveSound();
 
     };
 
@@ -29,14 +29,10 @@ namespace cocosdl
       _className = CLASS_NAME;
     }
 
-    RepeatForeverAction::RepeatForeverAction( const RepeatForeverAction &other ) : Action( other ), _child( NULL )
+    RepeatForeverAction::RepeatForeverAction( const RepeatForeverAction &other ) :
+    Action( other ), _child( other._child ? other._child->copy() : NULL )
     {
       _className = CLASS_NAME;
-      releaseChild();
-      if( other._child )
-      {
-        _child = other._child->copy();
-      }
     }
 
     RepeatForeverAction::~RepeatForeverAction()
@@ -46,20 +42,22 @@ namespace cocosdl
 
     void RepeatForeverAction::releaseChild()
     {
-      if( _child && !_child->release() )
+      if( _child )
       {
         DESTROY_ACTION( _child );
       }
-      _child = NULL;
     }
 
     RepeatForeverAction &RepeatForeverAction::operator = ( const RepeatForeverAction &other )
     {
       Action::operator=( other );
-      releaseChild();
-      if( other._child )
+      if( this != &other )
       {
-        _child = other._child->copy();
+        releaseChild();
+        if( other._child )
+        {
+          _child = other._child->copy();
+        }
       }
       return *this;
     }
@@ -77,6 +75,11 @@ namespace cocosdl
       }
     }
 
+    bool RepeatForeverAction::isConcurrent() const
+    {
+      return !_child || _child->isConcurrent();
+    }
+
     Action *RepeatForeverAction::copy()
     {
       return getFromPoolOrCreate( this, repeatForeverActionFactory );
@@ -24,6 +24,7 @@ namespace cocosdl
 {
   namespace action
   {
+    class AnimationWriter;
     class RepeatForeverActionFactory;
 
     /**
@@ -35,6 +36,8 @@ namespace cocosdl
     class RepeatForeverAction : public Action
     {
       friend class RepeatForeverActionFactory;
+      friend class AnimationWriter;
+      friend class AnimationSet;
 
     public:
       /**
@@ -61,6 +64,11 @@ namespace cocosdl
        */
       virtual Action *copy();
 
+      /**
+       * Concurrent only if every child action is.
+       */
+      virtual bool isConcurrent() const;
+
     protected:
       Action *_child;
 
@@ -23,6 +23,7 @@ namespace cocosdl
 {
   namespace action
   {
+    class AnimationWriter;
     class ResizeByActionFactory;
 
     /**
@@ -34,6 +35,7 @@ namespace cocosdl
     class ResizeByAction : public TimedAction
     {
       friend class ResizeByActionFactory;
+      friend class AnimationWriter;
 
     public:
       /**
@@ -23,6 +23,7 @@ namespace cocosdl
 {
   namespace action
   {
+    class AnimationWriter;
     class ResizeToActionFactory;
 
     /**
@@ -34,6 +35,7 @@ namespace cocosdl
     class ResizeToAction : public TimedAction
     {
       friend class ResizeToActionFactory;
+      friend class AnimationWriter;
 
     public:
       /**
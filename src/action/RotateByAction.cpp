@@ -76,6 +76,11 @@ namespace cocosdl
       return getFromPoolOrCreate( this, rotateByActionFactory );
     }
 
+    bool RotateByAction::isConcurrent() const
+    {
+      return !Node::isEagerInheritance();
+    }
+
     Action *RotateByActionFactory::createInstance() const
     {
       return new RotateByAction( 0, 0.0 );
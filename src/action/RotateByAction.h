@@ -24,6 +24,7 @@ namespace cocosdl
 {
   namespace action
   {
+    class AnimationWriter;
     class RotateByActionFactory;
 
     /**
@@ -35,6 +36,7 @@ namespace cocosdl
     class RotateByAction : public TimedAction
     {
       friend class RotateByActionFactory;
+      friend class AnimationWriter;
 
     public:
       /**
@@ -57,6 +59,11 @@ namespace cocosdl
        */
       virtual Action *copy();
 
+      /**
+       * Concurrent unless children inherit by propagation, see Node::setEagerInheritance.
+       */
+      virtual bool isConcurrent() const;
+
     protected:
       double _angle0;
       double _angleDelta;
@@ -23,7 +23,7 @@ namespace cocosdl
   {
     static RotateToActionFactory rotateToActionFactory;
 
-    static char const *const CLASS_NAME = "ResizeToAction";
+    static char const *const CLASS_NAME = "RotateToAction";
 
     RotateToAction::RotateToAction( long long durationMs, double angle ) :
     TimedAction( durationMs ), _angle0( 0.0 ), _angle1( angle )
@@ -68,6 +68,11 @@ namespace cocosdl
       return getFromPoolOrCreate( this, rotateToActionFactory );
     }
 
+    bool RotateToAction::isConcurrent() const
+    {
+      return !Node::isEagerInheritance();
+    }
+
     Action *RotateToActionFactory::createInstance() const
     {
       return new RotateToAction( 0, 0.0 );
@@ -23,6 +23,7 @@ namespace cocosdl
 {
   namespace action
   {
+    class AnimationWriter;
     class RotateToActionFactory;
 
     /**
@@ -34,6 +35,7 @@ namespace cocosdl
     class RotateToAction : public TimedAction
     {
       friend class RotateToActionFactory;
+      friend class AnimationWriter;
 
     public:
       /**
@@ -56,6 +58,11 @@ namespace cocosdl
        */
       virtual Action *copy();
 
+      /**
+       * Concurrent unless children inherit by propagation, see Node::setEagerInheritance.
+       */
+      virtual bool isConcurrent() const;
+
     protected:
       double _angle0;
       double _angle1;
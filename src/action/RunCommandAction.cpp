@@ -32,14 +32,10 @@ namespace cocosdl
       _className = CLASS_NAME;
     }
 
-    RunCommandAction::RunCommandAction( const RunCommandAction &other ) : Action( other )
+    RunCommandAction::RunCommandAction( const RunCommandAction &other ) :
+    Action( other ), _command( other._command ? other._command->copy() : NULL )
     {
       _className = CLASS_NAME;
-      if( _command )
-      {
-        delete _command;
-      }
-      _command = other._command ? other._command->copy() : NULL;
     }
 
     RunCommandAction::~RunCommandAction()
@@ -53,11 +49,14 @@ namespace cocosdl
     RunCommandAction &RunCommandAction::operator = ( const RunCommandAction &other )
     {
       Action::operator=( other );
-      if( _command )
+      if( _command != other._command )
       {
-        delete _command;
+        if( _command )
+        {
+          delete _command;
+        }
+        _command = other._command ? other._command->copy() : NULL;
       }
-      _command = other._command ? other._command->copy() : NULL;
       return *this;
     }
 
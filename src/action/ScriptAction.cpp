@@ -0,0 +1,231 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <assert.h>
+#include <map>
+#include <mutex>
+#include "ScriptAction.h"
+#include "ActionEventQueue.h"
+#include "BlockPool.h"
+#include "Game.h"
+
+using namespace cocosdl::util;
+
+namespace cocosdl
+{
+  namespace action
+  {
+    static ScriptActionFactory scriptActionFactory;
+
+    static char const *const CLASS_NAME = "ScriptAction";
+
+    static const long long NO_WAIT = -1L;
+
+    // a script can resume several times in the same frame when what it awaits is already satisfied, this bounds it
+    static const int MAX_RESUMES_PER_FRAME = 32;
+
+    static std::mutex _eventMutex;
+    static std::map<std::string, unsigned long> _eventGenerations;
+
+    static unsigned long getEventGeneration( const std::string &eventName )
+    {
+      std::lock_guard<std::mutex> lock( _eventMutex );
+      std::map<std::string, unsigned long>::const_iterator position = _eventGenerations.find( eventName );
+      return position != _eventGenerations.end() ? position->second : 0;
+    }
+
+    Script::Script() :
+    _resumePoint( 0 ), _waitUntil( NO_WAIT ), _awaitedAction( NULL ), _awaitedEvent( "" ), _awaitedEventGeneration( 0 )
+    {
+    }
+
+    Script::Script( const Script &other ) :
+    _resumePoint( 0 ), _waitUntil( NO_WAIT ), _awaitedAction( NULL ), _awaitedEvent( "" ), _awaitedEventGeneration( 0 )
+    {
+    }
+
+    Script::~Script()
+    {
+      clearWait();
+    }
+
+    Script &Script::operator = ( const Script &other )
+    {
+      restart();
+      return *this;
+    }
+
+    void *Script::operator new( size_t size )
+    {
+      return BlockPool::allocateSized( size );
+    }
+
+    void Script::operator delete( void *block, size_t size )
+    {
+      BlockPool::deallocateSized( block, size );
+    }
+
+    void Script::restart()
+    {
+      clearWait();
+      _resumePoint = 0;
+    }
+
+    void Script::wait( const long long durationMs )
+    {
+      clearWait();
+      _waitUntil = Game::getInstance()->currentTimeMillis() + durationMs;
+    }
+
+    void Script::await( Action *action )
+    {
+      clearWait();
+      _awaitedAction = action;
+    }
+
+    void Script::awaitEvent( const std::string &eventName )
+    {
+      clearWait();
+      _awaitedEvent = eventName;
+      _awaitedEventGeneration = getEventGeneration( eventName );
+    }
+
+    void Script::clearWait()
+    {
+      _waitUntil = NO_WAIT;
+      if( _awaitedAction )
+      {
+        // its finish event may still be queued
+        ActionEventQueue::retire( _awaitedAction );
+        _awaitedAction = NULL;
+      }
+      _awaitedEvent.clear();
+    }
+
+    ScriptAction::ScriptAction( Script *script ) : _script( script )
+    {
+      _className = CLASS_NAME;
+    }
+
+    ScriptAction::ScriptAction( const ScriptAction &other ) :
+    Action( other ), _script( other._script ? other._script->copy() : NULL )
+    {
+      _className = CLASS_NAME;
+    }
+
+    ScriptAction::~ScriptAction()
+    {
+      if( _script )
+      {
+        delete _script;
+      }
+    }
+
+    ScriptAction &ScriptAction::operator = ( const ScriptAction &other )
+    {
+      Action::operator=( other );
+      if( _script != other._script )
+      {
+        if( _script )
+        {
+          delete _script;
+        }
+        _script = other._script ? other._script->copy() : NULL;
+      }
+      return *this;
+    }
+
+    void ScriptAction::run( Node *node )
+    {
+      assert( node != NULL );
+      if( !_script )
+      {
+        setActionStatus( Finished, node );
+        return;
+      }
+      if( _actionStatus == Created )
+      {
+        setActionStatus( Started, node );
+      }
+      for( int i = 0; i < MAX_RESUMES_PER_FRAME; i++ )
+      {
+        if( isBlocked( node ) )
+        {
+          return;
+        }
+        _script->clearWait();
+        _script->run( node );
+        if( _script->isFinished() )
+        {
+          setActionStatus( Finished, node );
+          return;
+        }
+        if( _script->_waitUntil == NO_WAIT && !_script->_awaitedAction && _script->_awaitedEvent.empty() )
+        {
+          // plain yield, resume on the next frame
+          return;
+        }
+      }
+    }
+
+    bool ScriptAction::isBlocked( Node *node )
+    {
+      if( _script->_awaitedAction )
+      {
+        Action *action = _script->_awaitedAction;
+        if( action->getActionStatus() != Finished )
+        {
+          action->run( node );
+        }
+        return action->getActionStatus() != Finished;
+      }
+      if( _script->_waitUntil != NO_WAIT )
+      {
+        return Game::getInstance()->currentTimeMillis() < _script->_waitUntil;
+      }
+      if( !_script->_awaitedEvent.empty() )
+      {
+        return getEventGeneration( _script->_awaitedEvent ) == _script->_awaitedEventGeneration;
+      }
+      return false;
+    }
+
+    void ScriptAction::reset( const Node *node )
+    {
+      Action::reset( node );
+      if( _script )
+      {
+        _script->restart();
+      }
+    }
+
+    Action *ScriptAction::copy()
+    {
+      return getFromPoolOrCreate( this, scriptActionFactory );
+    }
+
+    void ScriptAction::postEvent( const std::string &eventName )
+    {
+      std::lock_guard<std::mutex> lock( _eventMutex );
+      _eventGenerations[eventName]++;
+    }
+
+    Action *ScriptActionFactory::createInstance() const
+    {
+      return new ScriptAction( NULL );
+    }
+  }
+}
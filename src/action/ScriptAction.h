@@ -0,0 +1,209 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __ScriptAction_H_
+#define __ScriptAction_H_
+
+#include <string>
+#include "Action.h"
+
+/**
+ * Script body helpers. A script body is a resumable function: it is written as straight code between SCRIPT_BEGIN and
+ * SCRIPT_END, and every SCRIPT_WAIT, SCRIPT_AWAIT, SCRIPT_AWAIT_EVENT or SCRIPT_YIELD suspends it until the awaited
+ * condition is met, resuming right after that statement on a later frame.<br/>
+ * Local variables do not survive a suspension, keep any state that must live across them as members of the Script.
+ * Suspension points are identified by their line, so write at most one of them per line.
+ */
+#define SCRIPT_BEGIN                switch( _resumePoint ) { case 0:
+#define SCRIPT_SUSPEND_             _resumePoint = __LINE__; return; case __LINE__:;
+#define SCRIPT_YIELD()              do { SCRIPT_SUSPEND_ } while( 0 )
+#define SCRIPT_WAIT( ms )           do { wait( ms ); SCRIPT_SUSPEND_ } while( 0 )
+#define SCRIPT_AWAIT( action )      do { await( action ); SCRIPT_SUSPEND_ } while( 0 )
+#define SCRIPT_AWAIT_EVENT( name )  do { awaitEvent( name ); SCRIPT_SUSPEND_ } while( 0 )
+#define SCRIPT_END                  } _resumePoint = cocosdl::action::Script::SCRIPT_FINISHED;
+
+namespace cocosdl
+{
+  class Node;
+
+  namespace action
+  {
+    class ScriptAction;
+    class ScriptActionFactory;
+
+    /**
+     * A Script is a scripted behavior run on a node by a ScriptAction. Instead of building trees of SequenceAction,
+     * GroupAction and RunCommandAction, subclasses implement run as plain sequential code that waits for durations,
+     * other actions or named events (see the SCRIPT_ macros).<br/>
+     * Script objects are the frames of the resumable function, and they are allocated from the shared BlockPool, so
+     * creating and destroying thousands of them does not hit the heap once the pool is warm.<br/>
+     * Example:
+     * <pre>
+     *   void Blink::run( Node *node )
+     *   {
+     *     SCRIPT_BEGIN
+     *     SCRIPT_AWAIT( new FadeOutAction( 200 ) );
+     *     SCRIPT_WAIT( 100 );
+     *     SCRIPT_AWAIT( new FadeInAction( 200 ) );
+     *     SCRIPT_AWAIT_EVENT( "levelEnd" );
+     *     SCRIPT_END
+     *   }
+     * </pre>
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    class Script
+    {
+      friend class ScriptAction;
+
+    public:
+      static const int SCRIPT_FINISHED = -1;
+
+      Script();
+
+      Script( const Script &other );
+
+      virtual ~Script();
+
+      Script &operator = ( const Script &other );
+
+      /**
+       * Run the script body on the node until it suspends or ends. Must be implemented by subclasses, wrapping the
+       * body with SCRIPT_BEGIN and SCRIPT_END.
+       *
+       * @param node the node the script runs on
+       */
+      virtual void run( Node *node ) = 0;
+
+      /**
+       * Create a deep copy of the script, with the same subclass, ready to be run from the start.
+       */
+      virtual Script *copy() = 0;
+
+      /**
+       * Restart the script from the beginning. Subclasses keeping state across suspensions should override it to
+       * reset that state too, calling this implementation.
+       */
+      virtual void restart();
+
+      bool isFinished() const
+      {
+        return _resumePoint == SCRIPT_FINISHED;
+      }
+
+      static void *operator new( size_t size );
+
+      static void operator delete( void *block, size_t size );
+
+    protected:
+      int _resumePoint;
+
+      /**
+       * Suspend the script for the given time. Use SCRIPT_WAIT instead of calling it directly.
+       *
+       * @param durationMs time to wait in milliseconds
+       */
+      void wait( const long long durationMs );
+
+      /**
+       * Suspend the script until the action finishes running on the node. The script takes ownership of the action.
+       * Use SCRIPT_AWAIT instead of calling it directly.
+       *
+       * @param action action to run
+       */
+      void await( Action *action );
+
+      /**
+       * Suspend the script until the named event is posted with ScriptAction::postEvent. Use SCRIPT_AWAIT_EVENT
+       * instead of calling it directly.
+       *
+       * @param eventName event name
+       */
+      void awaitEvent( const std::string &eventName );
+
+    private:
+      long long     _waitUntil;
+      Action        *_awaitedAction;
+      std::string   _awaitedEvent;
+      unsigned long _awaitedEventGeneration;
+
+      void clearWait();
+    };
+
+    /**
+     * Run a Script on a node. The action finishes when the script reaches SCRIPT_END, notifying its observer as any
+     * other action does.
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    class ScriptAction : public Action
+    {
+      friend class ScriptActionFactory;
+
+    public:
+      /**
+       * Constructor.
+       *
+       * @param script script to run, the action takes ownership of it.
+       */
+      ScriptAction( Script *script );
+
+      ScriptAction( const ScriptAction &other );
+
+      virtual ~ScriptAction();
+
+      ScriptAction &operator = ( const ScriptAction &other );
+
+      virtual void run( Node *node );
+
+      /**
+       * Reset the action to the initial status so it can be applied to other nodes.
+       *
+       * @param node the node which the action has just been run on, to enable notification to obervers.
+       */
+      virtual void reset( const Node *node );
+
+      /**
+       * Allows reuse of the action by creating disposable copies.<br/>
+       * Must return a new action of the same subtype, deep copied, ready to be used on a node.
+       */
+      virtual Action *copy();
+
+      /**
+       * Post a named event, resuming every script currently waiting for it.
+       *
+       * @param eventName event name
+       */
+      static void postEvent( const std::string &eventName );
+
+    private:
+      Script *_script;
+
+      bool isBlocked( Node *node );
+    };
+
+    class ScriptActionFactory : public ActionFactory
+    {
+
+    public:
+      virtual Action *createInstance() const;
+    };
+  }
+}
+
+#endif //__ScriptAction_H_
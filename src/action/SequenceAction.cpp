@@ -43,11 +43,14 @@ namespace cocosdl
     SequenceAction &SequenceAction::operator = ( const SequenceAction &other )
     {
       Action::operator=( other );
-      removeAll();
-      size_t count = other._actions.size();
-      for( size_t i = 0; i < count; i++ )
+      if( this != &other )
       {
-        addAction( other._actions.at( i )->copy() );
+        removeAll();
+        size_t count = other._actions.size();
+        for( size_t i = 0; i < count; i++ )
+        {
+          addAction( other._actions.at( i )->copy() );
+        }
       }
       return *this;
     }
@@ -104,6 +107,19 @@ namespace cocosdl
       }
     }
 
+    bool SequenceAction::isConcurrent() const
+    {
+      size_t count = _actions.size();
+      for( size_t i = 0; i < count; i++ )
+      {
+        if( !_actions.at( i )->isConcurrent() )
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
     Action *SequenceAction::copy()
     {
       return getFromPoolOrCreate( this, sequenceActionFactory );
@@ -25,6 +25,7 @@ namespace cocosdl
 {
   namespace action
   {
+    class AnimationWriter;
     class SequenceActionFactory;
 
     /**
@@ -38,6 +39,7 @@ namespace cocosdl
     class SequenceAction : public Action
     {
       friend class SequenceActionFactory;
+      friend class AnimationWriter;
 
     public:
       SequenceAction();
@@ -60,6 +62,11 @@ namespace cocosdl
        */
       virtual Action *copy();
 
+      /**
+       * Concurrent only if every child action is.
+       */
+      virtual bool isConcurrent() const;
+
       /**
        * Reset the action to the initial status so it can be applied to other nodes.
        *
@@ -23,6 +23,7 @@ namespace cocosdl
 {
   namespace action
   {
+    class AnimationWriter;
     class TiltLabelFontActionFactory;
 
     /**
@@ -34,6 +35,7 @@ namespace cocosdl
     class TiltLabelFontAction : public TimedAction
     {
       friend class TiltLabelFontActionFactory;
+      friend class AnimationWriter;
 
     public:
       TiltLabelFontAction( long long durationMs, int delta );
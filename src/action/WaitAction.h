@@ -51,6 +51,11 @@ namespace cocosdl
        */
       virtual Action *copy();
 
+      virtual bool isConcurrent() const
+      {
+        return true;
+      }
+
     protected:
       /**
        * Run the action.<br/>
@@ -0,0 +1,362 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "AssetArchive.h"
+#include "Log.h"
+
+namespace cocosdl
+{
+  namespace util
+  {
+    static const Uint8 MAGIC[4] = { 'C', 'D', 'L', 'P' };
+    static const size_t HEADER_SIZE = 16;
+    static const size_t SLOT_SIZE = 4;
+    static const size_t ENTRY_SIZE = 32;
+
+    static Uint32 readU32( const Uint8 *data )
+    {
+      return (Uint32) data[0] | ( (Uint32) data[1] << 8 ) | ( (Uint32) data[2] << 16 ) | ( (Uint32) data[3] << 24 );
+    }
+
+    static Uint64 readU64( const Uint8 *data )
+    {
+      return (Uint64) readU32( data ) | ( (Uint64) readU32( data + 4 ) << 32 );
+    }
+
+    static void putU32( std::vector<Uint8> &out, const size_t offset, const Uint32 value )
+    {
+      for( int i = 0; i < 4; i++ )
+      {
+        out[offset + i] = (Uint8) ( value >> ( 8 * i ) );
+      }
+    }
+
+    static void putU64( std::vector<Uint8> &out, const size_t offset, const Uint64 value )
+    {
+      putU32( out, offset, (Uint32) value );
+      putU32( out, offset + 4, (Uint32) ( value >> 32 ) );
+    }
+
+    static size_t alignOffset( const size_t offset )
+    {
+      return ( offset + AssetArchive::PAYLOAD_ALIGNMENT - 1 ) & ~( AssetArchive::PAYLOAD_ALIGNMENT - 1 );
+    }
+
+    AssetArchive::AssetArchive() :
+    _data( NULL ), _size( 0 ), _mapped( NULL ), _mappedSize( 0 ), _entryCount( 0 ), _slotCount( 0 )
+    {
+    }
+
+    AssetArchive::~AssetArchive()
+    {
+      close();
+    }
+
+    bool AssetArchive::open( const std::string &filePath )
+    {
+      close();
+#ifndef _WIN32
+      int fd = ::open( filePath.c_str(), O_RDONLY );
+      if( fd >= 0 )
+      {
+        struct stat fileStat;
+        if( fstat( fd, &fileStat ) == 0 && fileStat.st_size > 0 )
+        {
+          void *mapped = mmap( NULL, (size_t) fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+          if( mapped != MAP_FAILED )
+          {
+            _mapped = mapped;
+            _mappedSize = (size_t) fileStat.st_size;
+          }
+        }
+        ::close( fd );
+      }
+      if( _mapped )
+      {
+        _data = static_cast<const Uint8 *>( _mapped );
+        _size = _mappedSize;
+        if( !parse() )
+        {
+          Log::error() << "Invalid asset archive " << filePath << std::endl;
+          close();
+          return false;
+        }
+        return true;
+      }
+#endif
+      SDL_RWops *rw = SDL_RWFromFile( filePath.c_str(), "rb" );
+      if( !rw )
+      {
+        return false;
+      }
+      Sint64 size = SDL_RWsize( rw );
+      bool ok = size > 0;
+      if( ok )
+      {
+        _buffer.resize( (size_t) size );
+        ok = SDL_RWread( rw, &_buffer[0], (size_t) size, 1 ) == 1;
+      }
+      SDL_RWclose( rw );
+      if( ok )
+      {
+        _data = &_buffer[0];
+        _size = _buffer.size();
+        ok = parse();
+      }
+      if( !ok )
+      {
+        Log::error() << "Can't read asset archive " << filePath << std::endl;
+        close();
+      }
+      return ok;
+    }
+
+    bool AssetArchive::openFromMemory( const void *data, const size_t size )
+    {
+      close();
+      _data = static_cast<const Uint8 *>( data );
+      _size = size;
+      if( !parse() )
+      {
+        close();
+        return false;
+      }
+      return true;
+    }
+
+    void AssetArchive::close()
+    {
+#ifndef _WIN32
+      if( _mapped )
+      {
+        munmap( _mapped, _mappedSize );
+      }
+#endif
+      _mapped = NULL;
+      _mappedSize = 0;
+      std::vector<Uint8>().swap( _buffer );
+      _data = NULL;
+      _size = 0;
+      _entryCount = 0;
+      _slotCount = 0;
+    }
+
+    bool AssetArchive::parse()
+    {
+      if( !_data || _size < HEADER_SIZE || memcmp( _data, MAGIC, sizeof( MAGIC ) ) != 0 ||
+          readU32( _data + 4 ) != FORMAT_VERSION )
+      {
+        return false;
+      }
+      size_t entryCount = readU32( _data + 8 );
+      size_t slotCount = readU32( _data + 12 );
+      if( ( slotCount & ( slotCount - 1 ) ) != 0 || slotCount < entryCount ||
+          HEADER_SIZE + slotCount * SLOT_SIZE + entryCount * ENTRY_SIZE > _size )
+      {
+        return false;
+      }
+      // validate every entry once, so lookups can trust the index
+      const Uint8 *entries = _data + HEADER_SIZE + slotCount * SLOT_SIZE;
+      for( size_t i = 0; i < entryCount; i++ )
+      {
+        const Uint8 *entry = entries + i * ENTRY_SIZE;
+        Uint64 offset = readU64( entry + 8 );
+        Uint64 size = readU64( entry + 16 );
+        Uint64 nameOffset = readU32( entry + 24 );
+        Uint64 nameLength = readU32( entry + 28 );
+        if( offset > _size || size > _size - offset || nameOffset > _size || nameLength > _size - nameOffset )
+        {
+          return false;
+        }
+      }
+      for( size_t i = 0; i < slotCount; i++ )
+      {
+        if( readU32( _data + HEADER_SIZE + i * SLOT_SIZE ) > entryCount )
+        {
+          return false;
+        }
+      }
+      _entryCount = entryCount;
+      _slotCount = slotCount;
+      return true;
+    }
+
+    std::string AssetArchive::getName( const size_t index ) const
+    {
+      if( index >= _entryCount )
+      {
+        return "";
+      }
+      const Uint8 *entry = _data + HEADER_SIZE + _slotCount * SLOT_SIZE + index * ENTRY_SIZE;
+      return std::string( (const char *) _data + readU32( entry + 24 ), readU32( entry + 28 ) );
+    }
+
+    const void *AssetArchive::find( const std::string &name, size_t &size ) const
+    {
+      if( _slotCount == 0 )
+      {
+        return NULL;
+      }
+      Uint64 hash = hashName( name );
+      const Uint8 *slots = _data + HEADER_SIZE;
+      const Uint8 *entries = slots + _slotCount * SLOT_SIZE;
+      size_t mask = _slotCount - 1;
+      for( size_t probe = 0; probe < _slotCount; probe++ )
+      {
+        Uint32 slot = readU32( slots + ( ( hash + probe ) & mask ) * SLOT_SIZE );
+        if( slot == 0 )
+        {
+          return NULL;
+        }
+        const Uint8 *entry = entries + ( slot - 1 ) * ENTRY_SIZE;
+        if( readU64( entry ) == hash && readU32( entry + 28 ) == name.size() &&
+            memcmp( _data + readU32( entry + 24 ), name.data(), name.size() ) == 0 )
+        {
+          size = (size_t) readU64( entry + 16 );
+          return _data + readU64( entry + 8 );
+        }
+      }
+      return NULL;
+    }
+
+    SDL_RWops *AssetArchive::openEntry( const std::string &name ) const
+    {
+      size_t size;
+      const void *data = find( name, size );
+      return data ? SDL_RWFromConstMem( data, (int) size ) : NULL;
+    }
+
+    Uint64 AssetArchive::hashName( const std::string &name )
+    {
+      Uint64 hash = 14695981039346656037ULL;
+      for( size_t i = 0; i < name.size(); i++ )
+      {
+        hash ^= (Uint8) name[i];
+        hash *= 1099511628211ULL;
+      }
+      return hash;
+    }
+
+    AssetArchiveWriter::AssetArchiveWriter()
+    {
+    }
+
+    AssetArchiveWriter::~AssetArchiveWriter()
+    {
+    }
+
+    bool AssetArchiveWriter::addFile( const std::string &name, const std::string &filePath )
+    {
+      SDL_RWops *rw = SDL_RWFromFile( filePath.c_str(), "rb" );
+      if( !rw )
+      {
+        Log::error() << "Can't open " << filePath << std::endl;
+        return false;
+      }
+      Sint64 size = SDL_RWsize( rw );
+      std::vector<Uint8> data( size > 0 ? (size_t) size : 0 );
+      bool ok = size >= 0 && ( size == 0 || SDL_RWread( rw, &data[0], (size_t) size, 1 ) == 1 );
+      SDL_RWclose( rw );
+      if( !ok )
+      {
+        Log::error() << "Can't read " << filePath << std::endl;
+        return false;
+      }
+      addData( name, data.empty() ? NULL : &data[0], data.size() );
+      return true;
+    }
+
+    void AssetArchiveWriter::addData( const std::string &name, const void *data, const size_t size )
+    {
+      const Uint8 *bytes = static_cast<const Uint8 *>( data );
+      for( size_t i = 0; i < _names.size(); i++ )
+      {
+        if( _names.at( i ) == name )
+        {
+          _payloads.at( i ).assign( bytes, bytes + size );
+          return;
+        }
+      }
+      _names.push_back( name );
+      _payloads.push_back( std::vector<Uint8>( bytes, bytes + size ) );
+    }
+
+    void AssetArchiveWriter::getData( std::vector<Uint8> &data ) const
+    {
+      size_t count = _names.size();
+      // keep the table at most half full, so probe sequences stay short
+      size_t slotCount = 1;
+      while( slotCount < count * 2 )
+      {
+        slotCount <<= 1;
+      }
+      data.clear();
+      data.resize( HEADER_SIZE + slotCount * SLOT_SIZE + count * ENTRY_SIZE );
+      memcpy( &data[0], MAGIC, sizeof( MAGIC ) );
+      putU32( data, 4, AssetArchive::FORMAT_VERSION );
+      putU32( data, 8, (Uint32) count );
+      putU32( data, 12, (Uint32) slotCount );
+      size_t entriesOffset = HEADER_SIZE + slotCount * SLOT_SIZE;
+      for( size_t i = 0; i < count; i++ )
+      {
+        const std::string &name = _names.at( i );
+        Uint64 hash = AssetArchive::hashName( name );
+        size_t slot = (size_t) hash & ( slotCount - 1 );
+        while( readU32( &data[HEADER_SIZE + slot * SLOT_SIZE] ) != 0 )
+        {
+          slot = ( slot + 1 ) & ( slotCount - 1 );
+        }
+        putU32( data, HEADER_SIZE + slot * SLOT_SIZE, (Uint32) ( i + 1 ) );
+        size_t entry = entriesOffset + i * ENTRY_SIZE;
+        putU64( data, entry, hash );
+        putU32( data, entry + 24, (Uint32) data.size() );
+        putU32( data, entry + 28, (Uint32) name.size() );
+        data.insert( data.end(), name.begin(), name.end() );
+      }
+      for( size_t i = 0; i < count; i++ )
+      {
+        const std::vector<Uint8> &payload = _payloads.at( i );
+        data.resize( alignOffset( data.size() ), 0 );
+        size_t entry = entriesOffset + i * ENTRY_SIZE;
+        putU64( data, entry + 8, data.size() );
+        putU64( data, entry + 16, payload.size() );
+        data.insert( data.end(), payload.begin(), payload.end() );
+      }
+    }
+
+    bool AssetArchiveWriter::save( const std::string &filePath ) const
+    {
+      std::vector<Uint8> data;
+      getData( data );
+      SDL_RWops *rw = SDL_RWFromFile( filePath.c_str(), "wb" );
+      if( !rw )
+      {
+        Log::error() << "Can't create asset archive " << filePath << std::endl;
+        return false;
+      }
+      bool ok = SDL_RWwrite( rw, &data[0], data.size(), 1 ) == 1;
+      SDL_RWclose( rw );
+      return ok;
+    }
+  }
+}
@@ -0,0 +1,219 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __AssetArchive_H_
+#define __AssetArchive_H_
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <SDL2/SDL.h>
+
+namespace cocosdl
+{
+  namespace util
+  {
+    /**
+     * A read only archive of resource files, written by AssetArchiveWriter. The archive is mapped in memory once when
+     * opened, and entries are found through a hashed index and read in place: openEntry returns an SDL_RWops over the
+     * mapped payload, so image, font, sound and music loaders read from it without copying it nor touching the
+     * filesystem again. Lookups do not modify the archive, so they are safe from any thread once it is open.<br/>
+     * File layout (all integers little endian):
+     * <pre>
+     *   "CDLP" u32 version, u32 entryCount, u32 slotCount
+     *   slotCount x u32 slot: entry index + 1 for the entry whose name hash lands on it, 0 if empty (open addressing)
+     *   entryCount x ( u64 nameHash, u64 payloadOffset, u64 payloadSize, u32 nameOffset, u32 nameLength )
+     *   names, then payloads, each one aligned to PAYLOAD_ALIGNMENT bytes from the start of the file
+     * </pre>
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    class AssetArchive
+    {
+
+    public:
+      static const Uint32 FORMAT_VERSION = 1;
+      static const size_t PAYLOAD_ALIGNMENT = 16;
+
+      AssetArchive();
+
+      virtual ~AssetArchive();
+
+      /**
+       * Open an archive file, mapping it in memory. Where the file can't be mapped (such as packaged Android assets)
+       * it is read into memory instead.
+       *
+       * @param filePath full path of the archive file
+       * @return true if the file is a valid archive
+       */
+      bool open( const std::string &filePath );
+
+      /**
+       * Use an archive already in memory. The data is not copied, it must stay valid while the archive is in use.
+       *
+       * @param data archive data
+       * @param size data size in bytes
+       * @return true if the data is a valid archive
+       */
+      bool openFromMemory( const void *data, const size_t size );
+
+      /**
+       * Close the archive. Pointers and SDL_RWops obtained from it become invalid.
+       */
+      void close();
+
+      bool isOpen() const
+      {
+        return _data != NULL;
+      }
+
+      /**
+       * Tell whether the archive is mapped from its file, or was read into memory.
+       *
+       * @return true if mapped
+       */
+      bool isMapped() const
+      {
+        return _mappedSize > 0;
+      }
+
+      /**
+       * Get the number of entries in the archive.
+       *
+       * @return entry count
+       */
+      size_t getCount() const
+      {
+        return _entryCount;
+      }
+
+      /**
+       * Get the name of an entry.
+       *
+       * @param index entry index, from 0 to getCount() - 1
+       * @return entry name
+       */
+      std::string getName( const size_t index ) const;
+
+      bool contains( const std::string &name ) const
+      {
+        size_t size;
+        return find( name, size ) != NULL;
+      }
+
+      /**
+       * Find an entry.
+       *
+       * @param name entry name, the file path relative to the packed directory with '/' separators
+       * @param size filled with the entry size in bytes
+       * @return the entry data, valid while the archive is open, or NULL if there is no such entry
+       */
+      const void *find( const std::string &name, size_t &size ) const;
+
+      /**
+       * Open an entry for reading with SDL.
+       *
+       * @param name entry name
+       * @return a read only SDL_RWops over the entry data, to be closed by the caller, or NULL if there is no such
+       * entry
+       */
+      SDL_RWops *openEntry( const std::string &name ) const;
+
+      /**
+       * Hash an entry name as done by the archive index (64 bit FNV-1a).
+       *
+       * @param name entry name
+       * @return name hash
+       */
+      static Uint64 hashName( const std::string &name );
+
+    private:
+      std::vector<Uint8>  _buffer;
+      const Uint8         *_data;
+      size_t              _size;
+      void                *_mapped;
+      size_t              _mappedSize;
+      size_t              _entryCount;
+      size_t              _slotCount;
+
+      AssetArchive( const AssetArchive &other );
+
+      AssetArchive &operator = ( const AssetArchive &other );
+
+      bool parse();
+    };
+
+    /**
+     * Builds asset archives to be read by AssetArchive.
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    class AssetArchiveWriter
+    {
+
+    public:
+      AssetArchiveWriter();
+
+      virtual ~AssetArchiveWriter();
+
+      /**
+       * Add a file to the archive, replacing any entry with the same name.
+       *
+       * @param name entry name, the file path relative to the packed directory with '/' separators
+       * @param filePath full path of the file to add
+       * @return true if the file was read
+       */
+      bool addFile( const std::string &name, const std::string &filePath );
+
+      /**
+       * Add an entry to the archive, replacing any entry with the same name. The data is copied.
+       *
+       * @param name entry name
+       * @param data entry data
+       * @param size data size in bytes
+       */
+      void addData( const std::string &name, const void *data, const size_t size );
+
+      size_t getCount() const
+      {
+        return _names.size();
+      }
+
+      /**
+       * Get the encoded archive.
+       *
+       * @param data buffer to fill with the archive
+       */
+      void getData( std::vector<Uint8> &data ) const;
+
+      /**
+       * Write the archive to a file.
+       *
+       * @param filePath full path of the file to write
+       * @return true if the file was written
+       */
+      bool save( const std::string &filePath ) const;
+
+    private:
+      std::vector<std::string>          _names;
+      std::vector<std::vector<Uint8> >  _payloads;
+    };
+  }
+}
+
+#endif //__AssetArchive_H_
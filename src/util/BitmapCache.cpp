@@ -0,0 +1,231 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "BitmapCache.h"
+#include "Node.h"
+#include "Game.h"
+#include "Renderer.h"
+#include "Texture.h"
+#include "Log.h"
+
+namespace cocosdl
+{
+  namespace util
+  {
+    static char const *const CLASS_NAME = "BitmapCache";
+
+    static const size_t BYTES_PER_PIXEL = 4;
+
+    // caches are only drawn from the game thread
+    static size_t _hitCount = 0;
+    static size_t _renderCount = 0;
+    static size_t _textureMemory = 0;
+    static size_t _textureCount = 0;
+
+    BitmapCache::BitmapCache() :
+    _texture( NULL ), _textureWidth( 0 ), _textureHeight( 0 ), _offsetX( 0 ), _offsetY( 0 ), _width( 0 ),
+    _height( 0 ), _dirty( true ), _unsupported( false ), _rotationAngle( 0.0 ), _widthDelta( 0 ), _heightDelta( 0 )
+    {
+    }
+
+    BitmapCache::~BitmapCache()
+    {
+      release();
+    }
+
+    bool BitmapCache::draw( const Node &node )
+    {
+      if( _unsupported )
+      {
+        return false;
+      }
+
+      Rect screenRect;
+      int widthDelta, heightDelta;
+      node.getDestinationRect( screenRect );
+      node.getInheritedDelta( widthDelta, heightDelta );
+      if( isDirty() || node._drawRotationAngle != _rotationAngle || widthDelta != _widthDelta ||
+          heightDelta != _heightDelta )
+      {
+        _rotationAngle = node._drawRotationAngle;
+        _widthDelta = widthDelta;
+        _heightDelta = heightDelta;
+        if( !render( node, screenRect ) )
+        {
+          return false;
+        }
+        _renderCount++;
+      }
+      else
+      {
+        _hitCount++;
+      }
+
+      if( _width > 0 && _height > 0 )
+      {
+        Rect source( 0, 0, _width, _height );
+        Rect destination( screenRect.getX() + _offsetX - Node::_drawOffsetX,
+                          screenRect.getY() + _offsetY - Node::_drawOffsetY, _width, _height );
+        // premultiplied colors fade with the alpha
+        float opacity = Node::isEagerInheritance() ? 1.0f : node._drawOpacity;
+        Uint8 modulation = (Uint8) ( opacity * 255 );
+        SDL_SetTextureColorMod( _texture->getTexture(), modulation, modulation, modulation );
+        _texture->setOpacity( opacity );
+        Point center( 0, 0 );
+        Game::getInstance()->getRenderer()->renderCopy( _texture, &source, &destination, 0, center, SDL_FLIP_NONE );
+      }
+      return true;
+    }
+
+    bool BitmapCache::render( const Node &node, const Rect &screenRect )
+    {
+      Renderer *renderer = Game::getInstance()->getRenderer();
+      SDL_Renderer *sdlRenderer = renderer->getSDL_Renderer();
+      if( !SDL_RenderTargetSupported( sdlRenderer ) )
+      {
+        Log::error() << CLASS_NAME << ": render targets not supported, drawing nodes directly" << std::endl;
+        _unsupported = true;
+        return false;
+      }
+
+      // anything changed from now on is seen on the next draw
+      _dirty.store( false, std::memory_order_relaxed );
+      int left, top, right, bottom;
+      if( !node.getTreeBounds( left, top, right, bottom ) )
+      {
+        _width = _height = 0;
+        return true;
+      }
+      if( !reserve( right - left, bottom - top ) )
+      {
+        _unsupported = true;
+        return false;
+      }
+      _offsetX = left - screenRect.getX();
+      _offsetY = top - screenRect.getY();
+
+      // caches below render into their own texture while this one is the target
+      SDL_Texture *previousTarget = SDL_GetRenderTarget( sdlRenderer );
+      Rect previousClipRect;
+      renderer->getClipRect( previousClipRect );
+      SDL_SetRenderTarget( sdlRenderer, _texture->getTexture() );
+      Uint8 red, green, blue, alpha;
+      SDL_GetRenderDrawColor( sdlRenderer, &red, &green, &blue, &alpha );
+      SDL_SetRenderDrawColor( sdlRenderer, 0, 0, 0, 0 );
+      SDL_RenderClear( sdlRenderer );
+      SDL_SetRenderDrawColor( sdlRenderer, red, green, blue, alpha );
+
+      int offsetX = Node::_drawOffsetX;
+      int offsetY = Node::_drawOffsetY;
+      float drawOpacity = node._drawOpacity;
+      Node::_drawOffsetX = left;
+      Node::_drawOffsetY = top;
+      if( !Node::isEagerInheritance() )
+      {
+        // applied when drawing the texture
+        node._drawOpacity = 1.0f;
+      }
+      node.drawNode();
+      node._drawOpacity = drawOpacity;
+      Node::_drawOffsetX = offsetX;
+      Node::_drawOffsetY = offsetY;
+
+      SDL_SetRenderTarget( sdlRenderer, previousTarget );
+      if( previousTarget && previousClipRect.getWidth() > 0 )
+      {
+        // only the clipping of the screen is restored by SDL
+        renderer->setClipRect( previousClipRect );
+      }
+      return true;
+    }
+
+    bool BitmapCache::reserve( const int width, const int height )
+    {
+      _width = width;
+      _height = height;
+      // reuse the texture unless it is too small, or four times what is needed
+      if( _texture && width <= _textureWidth && height <= _textureHeight &&
+          width * height * 4 >= _textureWidth * _textureHeight )
+      {
+        return true;
+      }
+      release();
+
+      SDL_Texture *texture = SDL_CreateTexture( Game::getInstance()->getRenderer()->getSDL_Renderer(),
+                                                SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height );
+      if( !texture )
+      {
+        Log::error() << CLASS_NAME << ": can't create a " << width << "x" << height << " render target: "
+                     << SDL_GetError() << std::endl;
+        return false;
+      }
+      SDL_SetTextureBlendMode( texture, SDL_ComposeCustomBlendMode(
+          SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+          SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD ) );
+      _texture = new Texture( texture );
+      _textureWidth = width;
+      _textureHeight = height;
+      _textureMemory += BYTES_PER_PIXEL * width * height;
+      _textureCount++;
+      return true;
+    }
+
+    void BitmapCache::release()
+    {
+      if( _texture )
+      {
+        delete _texture;
+        _texture = NULL;
+        _textureMemory -= BYTES_PER_PIXEL * _textureWidth * _textureHeight;
+        _textureCount--;
+      }
+      _textureWidth = _textureHeight = 0;
+    }
+
+    size_t BitmapCache::getHitCount()
+    {
+      return _hitCount;
+    }
+
+    size_t BitmapCache::getRenderCount()
+    {
+      return _renderCount;
+    }
+
+    size_t BitmapCache::getTextureMemory()
+    {
+      return _textureMemory;
+    }
+
+    size_t BitmapCache::getTextureCount()
+    {
+      return _textureCount;
+    }
+
+    void BitmapCache::resetStats()
+    {
+      _hitCount = 0;
+      _renderCount = 0;
+    }
+
+    void BitmapCache::logUsage()
+    {
+      Log::info() << CLASS_NAME << ": " << _hitCount << " hits, " << _renderCount << " renders, " << _textureCount
+                  << " textures, " << _textureMemory / 1024 << " KB" << std::endl;
+    }
+  }
+}
@@ -0,0 +1,122 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef __BitmapCache_H_
+#define __BitmapCache_H_
+
+#include <atomic>
+#include <stddef.h>
+#include <SDL2/SDL.h>
+
+namespace cocosdl
+{
+  class Node;
+  class Rect;
+  class Texture;
+
+  namespace util
+  {
+    /**
+     * The render target texture a node caching as bitmap (see Node::setCacheAsBitmap) draws its subtree from.<br/>
+     * The texture covers the area drawn by the subtree and is rendered again when the cache is invalidated, when the
+     * angle the node is drawn rotated by changes, or when its ancestors are resized. It holds premultiplied colors, so
+     * translucent nodes blend the same as when drawn directly, and the node opacity modulates the whole texture.<br/>
+     * When the renderer does not support render targets, nodes are drawn directly.<br/>
+     * Caches are only drawn from the game thread, invalidate may be called from any thread.
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    class BitmapCache
+    {
+
+    public:
+      BitmapCache();
+
+      virtual ~BitmapCache();
+
+      /**
+       * Mark the cache for rendering on the next draw.
+       *
+       * @return false if it was already marked, and so were the caches above it
+       */
+      bool invalidate()
+      {
+        return !_dirty.exchange( true, std::memory_order_relaxed );
+      }
+
+      bool isDirty() const
+      {
+        return _dirty.load( std::memory_order_relaxed );
+      }
+
+      /**
+       * Draw a node from the cache, rendering its subtree first if needed. The node draw values must be composed.
+       *
+       * @param node the node owning the cache
+       * @return false if the subtree can't be cached and must be drawn directly
+       */
+      bool draw( const Node &node );
+
+      /**
+       * Get the number of draws served from a cache without rendering, since the last resetStats.
+       */
+      static size_t getHitCount();
+
+      /**
+       * Get the number of times a subtree was rendered into its cache, since the last resetStats.
+       */
+      static size_t getRenderCount();
+
+      /**
+       * Get the memory used by the textures of every cache, counting 4 bytes per pixel.
+       */
+      static size_t getTextureMemory();
+
+      static size_t getTextureCount();
+
+      static void resetStats();
+
+      /**
+       * Log the statistics.
+       */
+      static void logUsage();
+
+    private:
+      Texture           *_texture;
+      int               _textureWidth;
+      int               _textureHeight;
+      int               _offsetX;         // from the node destination origin to the texture origin
+      int               _offsetY;
+      int               _width;           // area in use
+      int               _height;
+      std::atomic<bool> _dirty;
+      bool              _unsupported;
+      double            _rotationAngle;   // draw values the texture was rendered with
+      int               _widthDelta;
+      int               _heightDelta;
+
+      bool render( const Node &node, const Rect &screenRect );
+
+      bool reserve( const int width, const int height );
+
+      void release();
+    };
+  }
+}
+
+#endif //__BitmapCache_H_
@@ -0,0 +1,118 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "BlockPool.h"
+#include <new>
+
+namespace cocosdl
+{
+  namespace util
+  {
+    static const size_t SIZE_CLASSES = BlockPool::MAX_POOLED_SIZE / BlockPool::SIZE_CLASS_STEP;
+
+    static std::mutex _sizeClassMutex;
+    static BlockPool *_sizeClassPools[SIZE_CLASSES] = { NULL };
+
+    BlockPool::BlockPool( const size_t blockSize, const size_t blocksPerSlab ) :
+    _blockSize( blockSize < sizeof( FreeBlock ) ? sizeof( FreeBlock ) : blockSize ),
+    _blocksPerSlab( blocksPerSlab > 0 ? blocksPerSlab : 1 ),
+    _usedBlocks( 0 ),
+    _freeList( NULL )
+    {
+      // keep every block aligned for any fundamental type
+      size_t alignment = sizeof( long double );
+      _blockSize = ( _blockSize + alignment - 1 ) / alignment * alignment;
+    }
+
+    BlockPool::~BlockPool()
+    {
+      for( size_t i = 0; i < _slabs.size(); i++ )
+      {
+        ::operator delete( _slabs.at( i ) );
+      }
+    }
+
+    void *BlockPool::allocate()
+    {
+      std::lock_guard<std::mutex> lock( _mutex );
+      if( !_freeList )
+      {
+        grow();
+      }
+      FreeBlock *block = _freeList;
+      _freeList = block->next;
+      _usedBlocks++;
+      return block;
+    }
+
+    void BlockPool::deallocate( void *block )
+    {
+      if( block == NULL )
+      {
+        return;
+      }
+      std::lock_guard<std::mutex> lock( _mutex );
+      FreeBlock *freeBlock = static_cast<FreeBlock *>( block );
+      freeBlock->next = _freeList;
+      _freeList = freeBlock;
+      _usedBlocks--;
+    }
+
+    void BlockPool::grow()
+    {
+      char *slab = static_cast<char *>( ::operator new( _blockSize * _blocksPerSlab ) );
+      _slabs.push_back( slab );
+      for( size_t i = _blocksPerSlab; i > 0; i-- )
+      {
+        FreeBlock *block = reinterpret_cast<FreeBlock *>( slab + ( i - 1 ) * _blockSize );
+        block->next = _freeList;
+        _freeList = block;
+      }
+    }
+
+    void *BlockPool::allocateSized( const size_t size )
+    {
+      if( size == 0 || size > MAX_POOLED_SIZE )
+      {
+        return ::operator new( size );
+      }
+      size_t index = ( size - 1 ) / SIZE_CLASS_STEP;
+      BlockPool *pool;
+      _sizeClassMutex.lock();
+      pool = _sizeClassPools[index];
+      if( !pool )
+      {
+        pool = new BlockPool( ( index + 1 ) * SIZE_CLASS_STEP );
+        _sizeClassPools[index] = pool;
+      }
+      _sizeClassMutex.unlock();
+      return pool->allocate();
+    }
+
+    void BlockPool::deallocateSized( void *block, const size_t size )
+    {
+      if( size == 0 || size > MAX_POOLED_SIZE )
+      {
+        ::operator delete( block );
+        return;
+      }
+      _sizeClassMutex.lock();
+      BlockPool *pool = _sizeClassPools[( size - 1 ) / SIZE_CLASS_STEP];
+      _sizeClassMutex.unlock();
+      pool->deallocate( block );
+    }
+  }
+}
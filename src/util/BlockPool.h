@@ -0,0 +1,132 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __BlockPool_H_
+#define __BlockPool_H_
+
+#include <vector>
+#include <mutex>
+#include <stddef.h>
+
+namespace cocosdl
+{
+  namespace util
+  {
+    /**
+     * A pool of fixed size memory blocks. Blocks are carved out of larger slabs and recycled through a free list, so
+     * once the pool has grown to its working size allocating and freeing blocks never touches the heap.<br/>
+     * The static allocateSized and deallocateSized methods route requests to a shared pool per size class (16 byte
+     * steps up to MAX_POOLED_SIZE), falling back to the global operator new for larger sizes. Classes can use them to
+     * implement class-specific operator new and delete.
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    class BlockPool
+    {
+
+    public:
+      static const size_t SIZE_CLASS_STEP = 16;
+      static const size_t MAX_POOLED_SIZE = 512;
+
+      /**
+       * Create a pool.
+       *
+       * @param blockSize size in bytes of each block
+       * @param blocksPerSlab how many blocks are allocated at once when the pool runs out of free blocks
+       */
+      BlockPool( const size_t blockSize, const size_t blocksPerSlab = 64 );
+
+      virtual ~BlockPool();
+
+      /**
+       * Get a block from the pool, growing it if needed.
+       *
+       * @return a block of at least getBlockSize() bytes
+       */
+      void *allocate();
+
+      /**
+       * Return a block to the pool.
+       *
+       * @param block a block previously obtained from this pool
+       */
+      void deallocate( void *block );
+
+      size_t getBlockSize() const
+      {
+        return _blockSize;
+      }
+
+      /**
+       * Get the number of blocks currently handed out.
+       *
+       * @return blocks in use
+       */
+      size_t getUsedBlocks() const
+      {
+        return _usedBlocks;
+      }
+
+      /**
+       * Get the total number of blocks owned by the pool (used and free).
+       *
+       * @return total blocks
+       */
+      size_t getCapacity() const
+      {
+        return _slabs.size() * _blocksPerSlab;
+      }
+
+      /**
+       * Allocate memory from the shared pool for the size class of size.
+       *
+       * @param size requested size in bytes
+       * @return memory block
+       */
+      static void *allocateSized( const size_t size );
+
+      /**
+       * Free memory obtained from allocateSized. The size must be the same used to allocate it.
+       *
+       * @param block memory block
+       * @param size size in bytes used to allocate the block
+       */
+      static void deallocateSized( void *block, const size_t size );
+
+    private:
+      struct FreeBlock
+      {
+        FreeBlock *next;
+      };
+
+      size_t              _blockSize;
+      size_t              _blocksPerSlab;
+      size_t              _usedBlocks;
+      FreeBlock           *_freeList;
+      std::vector<char *> _slabs;
+      std::mutex          _mutex;
+
+      BlockPool( const BlockPool &other );
+
+      BlockPool &operator = ( const BlockPool &other );
+
+      void grow();
+    };
+  }
+}
+
+#endif //__BlockPool_H_
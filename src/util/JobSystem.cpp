@@ -0,0 +1,321 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "JobSystem.h"
+#include "BlockPool.h"
+
+namespace cocosdl
+{
+  namespace util
+  {
+    class JobSystem::Job
+    {
+
+    public:
+      JobFunction       function;
+      Job               *parent;
+      std::atomic<int>  unfinished;
+      std::atomic<int>  references;
+
+      Job( const JobFunction &jobFunction, Job *parentJob, const int referenceCount ) :
+      function( jobFunction ), parent( parentJob ), unfinished( 1 ), references( referenceCount )
+      {
+      }
+
+      static void *operator new( size_t size )
+      {
+        return BlockPool::allocateSized( size );
+      }
+
+      static void operator delete( void *block, size_t size )
+      {
+        BlockPool::deallocateSized( block, size );
+      }
+    };
+
+    static std::mutex _instanceMutex;
+    static JobSystem *_instance = NULL;
+
+    JobSystem *JobSystem::getInstance()
+    {
+      std::lock_guard<std::mutex> lock( _instanceMutex );
+      if( !_instance )
+      {
+        _instance = new JobSystem();
+      }
+      return _instance;
+    }
+
+    void JobSystem::destroyInstance()
+    {
+      std::lock_guard<std::mutex> lock( _instanceMutex );
+      if( _instance )
+      {
+        delete _instance;
+        _instance = NULL;
+      }
+    }
+
+    JobSystem::JobSystem( const unsigned threadCount ) :
+    _queuedJobs( 0 ), _sleepingWorkers( 0 ), _stopping( false ), _mainThreadId( std::this_thread::get_id() )
+    {
+      unsigned count = threadCount;
+      if( count == 0 )
+      {
+        unsigned hardwareThreads = std::thread::hardware_concurrency();
+        count = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+      }
+      // workers wait for this lock before looking for jobs, so the worker list is complete when they start
+      std::lock_guard<std::mutex> lock( _sleepMutex );
+      for( unsigned i = 0; i < count; i++ )
+      {
+        _queues.push_back( new WorkQueue() );
+      }
+      for( unsigned i = 0; i < count; i++ )
+      {
+        _workers.push_back( std::thread( &JobSystem::workerLoop, this, (size_t) i ) );
+        _workerIds.push_back( _workers.back().get_id() );
+      }
+    }
+
+    JobSystem::~JobSystem()
+    {
+      _stopping = true;
+      _sleepMutex.lock();
+      _workAvailable.notify_all();
+      _sleepMutex.unlock();
+      for( size_t i = 0; i < _workers.size(); i++ )
+      {
+        _workers.at( i ).join();
+      }
+      for( size_t i = 0; i < _queues.size(); i++ )
+      {
+        delete _queues.at( i );
+      }
+    }
+
+    JobSystem::Job *JobSystem::createJob( const JobFunction &function, Job *parent )
+    {
+      if( parent )
+      {
+        parent->unfinished++;
+      }
+      // one reference for the execution, and another for the caller of wait on root jobs
+      return new Job( function, parent, parent ? 1 : 2 );
+    }
+
+    void JobSystem::run( Job *job )
+    {
+      push( job );
+    }
+
+    void JobSystem::wait( Job *job )
+    {
+      int workerIndex = getWorkerIndex();
+      while( job->unfinished > 0 )
+      {
+        Job *other = pop( workerIndex );
+        if( other )
+        {
+          execute( other );
+        }
+        else
+        {
+          std::this_thread::yield();
+        }
+      }
+      release( job );
+    }
+
+    void JobSystem::runAsync( const JobFunction &function )
+    {
+      if( _workers.empty() )
+      {
+        // nobody else would ever run it
+        function();
+        return;
+      }
+      push( new Job( function, NULL, 1 ) );
+    }
+
+    void JobSystem::parallelFor( const size_t count, const size_t grainSize, const RangeFunction &body )
+    {
+      size_t grain = grainSize > 0 ? grainSize : 1;
+      if( count == 0 )
+      {
+        return;
+      }
+      if( _workers.empty() || count <= grain )
+      {
+        body( 0, count );
+        return;
+      }
+      Job *root = createJob( JobFunction() );
+      for( size_t begin = 0; begin < count; begin += grain )
+      {
+        size_t end = begin + grain < count ? begin + grain : count;
+        run( createJob( [&body, begin, end]()
+        {
+          body( begin, end );
+        }, root ) );
+      }
+      run( root );
+      wait( root );
+    }
+
+    void JobSystem::runOnMainThread( const JobFunction &function )
+    {
+      std::lock_guard<std::mutex> lock( _mainThreadMutex );
+      _mainThreadJobs.push_back( function );
+    }
+
+    size_t JobSystem::runMainThreadJobs()
+    {
+      std::vector<JobFunction> jobs;
+      _mainThreadMutex.lock();
+      jobs.swap( _mainThreadJobs );
+      _mainThreadMutex.unlock();
+      for( size_t i = 0; i < jobs.size(); i++ )
+      {
+        jobs.at( i )();
+      }
+      return jobs.size();
+    }
+
+    void JobSystem::workerLoop( const size_t index )
+    {
+      _sleepMutex.lock();
+      _sleepMutex.unlock();
+      while( !_stopping )
+      {
+        Job *job = pop( (int) index );
+        if( job )
+        {
+          execute( job );
+          continue;
+        }
+        std::unique_lock<std::mutex> lock( _sleepMutex );
+        _sleepingWorkers++;
+        while( _queuedJobs == 0 && !_stopping )
+        {
+          _workAvailable.wait( lock );
+        }
+        _sleepingWorkers--;
+      }
+    }
+
+    int JobSystem::getWorkerIndex() const
+    {
+      std::thread::id id = std::this_thread::get_id();
+      for( size_t i = 0; i < _workerIds.size(); i++ )
+      {
+        if( _workerIds.at( i ) == id )
+        {
+          return (int) i;
+        }
+      }
+      return -1;
+    }
+
+    void JobSystem::push( Job *job )
+    {
+      int workerIndex = getWorkerIndex();
+      WorkQueue *queue = workerIndex >= 0 ? _queues.at( workerIndex ) : &_sharedQueue;
+      queue->mutex.lock();
+      queue->jobs.push_back( job );
+      queue->mutex.unlock();
+      _queuedJobs++;
+      if( _sleepingWorkers > 0 )
+      {
+        // taking the lock makes sure a worker about to sleep is already waiting when notified
+        std::lock_guard<std::mutex> lock( _sleepMutex );
+        _workAvailable.notify_one();
+      }
+    }
+
+    JobSystem::Job *JobSystem::pop( const int workerIndex )
+    {
+      Job *job = NULL;
+      if( workerIndex >= 0 )
+      {
+        WorkQueue *own = _queues.at( workerIndex );
+        std::lock_guard<std::mutex> lock( own->mutex );
+        if( !own->jobs.empty() )
+        {
+          job = own->jobs.back();
+          own->jobs.pop_back();
+        }
+      }
+      if( !job )
+      {
+        std::lock_guard<std::mutex> lock( _sharedQueue.mutex );
+        if( !_sharedQueue.jobs.empty() )
+        {
+          job = _sharedQueue.jobs.front();
+          _sharedQueue.jobs.pop_front();
+        }
+      }
+      // steal the oldest job of another worker, starting with the next one so thieves spread out
+      size_t count = _queues.size();
+      size_t first = workerIndex >= 0 ? (size_t) workerIndex + 1 : 0;
+      for( size_t i = 0; !job && i < count; i++ )
+      {
+        WorkQueue *victim = _queues.at( ( first + i ) % count );
+        std::lock_guard<std::mutex> lock( victim->mutex );
+        if( !victim->jobs.empty() )
+        {
+          job = victim->jobs.front();
+          victim->jobs.pop_front();
+        }
+      }
+      if( job )
+      {
+        _queuedJobs--;
+      }
+      return job;
+    }
+
+    void JobSystem::execute( Job *job )
+    {
+      if( job->function )
+      {
+        job->function();
+      }
+      finish( job );
+    }
+
+    void JobSystem::finish( Job *job )
+    {
+      if( --job->unfinished == 0 )
+      {
+        Job *parent = job->parent;
+        release( job );
+        if( parent )
+        {
+          finish( parent );
+        }
+      }
+    }
+
+    void JobSystem::release( Job *job )
+    {
+      if( --job->references == 0 )
+      {
+        delete job;
+      }
+    }
+  }
+}
@@ -0,0 +1,177 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __JobSystem_H_
+#define __JobSystem_H_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <stddef.h>
+
+namespace cocosdl
+{
+  namespace util
+  {
+    /**
+     * Runs jobs (small units of work) on a set of worker threads.<br/>
+     * Each worker has its own deque: jobs created on a worker are pushed to its back and it pops them from there,
+     * while idle workers steal from the front of the other deques, so work spreads without a central queue. Jobs
+     * created on other threads go to a shared queue that every worker takes from.<br/>
+     * A job can be created as the child of another one, the parent then only finishes when all its children have
+     * finished, which is what wait looks at. Threads waiting for a job run other jobs meanwhile instead of blocking.<br/>
+     * SDL rendering calls must be made from the thread that created the renderer, jobs needing them can be queued with
+     * runOnMainThread, and the game runs them once per frame.
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    class JobSystem
+    {
+
+    public:
+      typedef std::function<void()> JobFunction;
+
+      typedef std::function<void( size_t, size_t )> RangeFunction;
+
+      class Job;
+
+      /**
+       * Get the shared job system, creating it on first use. The thread that creates it is taken as the main thread.
+       */
+      static JobSystem *getInstance();
+
+      /**
+       * Destroy the shared job system, waiting for the workers to stop. Called by Game::quit.
+       */
+      static void destroyInstance();
+
+      /**
+       * Create a job system.
+       *
+       * @param threadCount number of worker threads, 0 to use one less than the number of hardware threads
+       */
+      JobSystem( const unsigned threadCount = 0 );
+
+      virtual ~JobSystem();
+
+      /**
+       * Create a job, not yet scheduled.
+       *
+       * @param function work to do
+       * @param parent parent job, which won't finish until this one does. NULL for a root job, that must be passed to
+       * wait once scheduled
+       * @return the job
+       */
+      Job *createJob( const JobFunction &function, Job *parent = NULL );
+
+      /**
+       * Schedule a job created with createJob. Children must be scheduled before their parent can finish.
+       *
+       * @param job the job
+       */
+      void run( Job *job );
+
+      /**
+       * Wait for a root job and its children to finish, running other jobs meanwhile, and release it.
+       *
+       * @param job a root job, scheduled with run
+       */
+      void wait( Job *job );
+
+      /**
+       * Schedule a function that nobody waits for.
+       *
+       * @param function work to do
+       */
+      void runAsync( const JobFunction &function );
+
+      /**
+       * Run body over [0, count), in chunks of grainSize items, on the workers and the calling thread, returning when
+       * the whole range is done.
+       *
+       * @param count number of items
+       * @param grainSize items per chunk
+       * @param body function called with the [begin, end) range of each chunk
+       */
+      void parallelFor( const size_t count, const size_t grainSize, const RangeFunction &body );
+
+      /**
+       * Queue a function to be run on the main thread by runMainThreadJobs.
+       *
+       * @param function work to do
+       */
+      void runOnMainThread( const JobFunction &function );
+
+      /**
+       * Run the functions queued with runOnMainThread. Only call it from the main thread.
+       *
+       * @return number of functions run
+       */
+      size_t runMainThreadJobs();
+
+      bool isMainThread() const
+      {
+        return std::this_thread::get_id() == _mainThreadId;
+      }
+
+      unsigned getThreadCount() const
+      {
+        return (unsigned) _workers.size();
+      }
+
+    private:
+      struct WorkQueue
+      {
+        std::mutex        mutex;
+        std::deque<Job *> jobs;
+      };
+
+      std::vector<std::thread>  _workers;
+      std::vector<std::thread::id> _workerIds;
+      std::vector<WorkQueue *>  _queues;
+      WorkQueue                 _sharedQueue;
+      std::atomic<long>         _queuedJobs;
+      std::atomic<int>          _sleepingWorkers;
+      std::mutex                _sleepMutex;
+      std::condition_variable   _workAvailable;
+      std::atomic<bool>         _stopping;
+      std::thread::id           _mainThreadId;
+      std::mutex                _mainThreadMutex;
+      std::vector<JobFunction>  _mainThreadJobs;
+
+      void workerLoop( const size_t index );
+
+      int getWorkerIndex() const;
+
+      void push( Job *job );
+
+      Job *pop( const int workerIndex );
+
+      void execute( Job *job );
+
+      void finish( Job *job );
+
+      void release( Job *job );
+    };
+  }
+}
+
+#endif //__JobSystem_H_
@@ -0,0 +1,107 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <string.h>
+#include <mutex>
+#include <unordered_map>
+#include <SDL2/SDL.h>
+#include "Name.h"
+
+namespace cocosdl
+{
+  namespace util
+  {
+    // strings by the hash of their characters, never freed so names stay valid at exit
+    struct NameTable
+    {
+      std::mutex                                              mutex;
+      std::unordered_multimap<size_t, const std::string *>    strings;
+    };
+
+    static NameTable &getTable()
+    {
+      static NameTable *table = new NameTable();
+      return *table;
+    }
+
+    static const std::string &getEmptyString()
+    {
+      static const std::string *empty = new std::string();
+      return *empty;
+    }
+
+    static size_t hashChars( const char *chars, const size_t length )
+    {
+      // 64 bit FNV-1a
+      Uint64 hash = 14695981039346656037ULL;
+      for( size_t i = 0; i < length; i++ )
+      {
+        hash ^= (unsigned char) chars[i];
+        hash *= 1099511628211ULL;
+      }
+      return (size_t) hash;
+    }
+
+    Name::Name() : _string( &getEmptyString() )
+    {
+    }
+
+    Name::Name( const char *chars ) : _string( intern( chars, chars ? strlen( chars ) : 0, true ) )
+    {
+    }
+
+    Name::Name( const std::string &string ) : _string( intern( string.data(), string.size(), true ) )
+    {
+    }
+
+    bool Name::find( const char *chars, const size_t length, Name &name )
+    {
+      const std::string *string = intern( chars, length, false );
+      if( string )
+      {
+        name._string = string;
+      }
+      return string != NULL;
+    }
+
+    const std::string *Name::intern( const char *chars, const size_t length, const bool add )
+    {
+      if( length == 0 )
+      {
+        return &getEmptyString();
+      }
+      size_t hash = hashChars( chars, length );
+      NameTable &table = getTable();
+      std::lock_guard<std::mutex> lock( table.mutex );
+      typedef std::unordered_multimap<size_t, const std::string *>::const_iterator Iterator;
+      std::pair<Iterator, Iterator> range = table.strings.equal_range( hash );
+      for( Iterator i = range.first; i != range.second; ++i )
+      {
+        if( i->second->size() == length && memcmp( i->second->data(), chars, length ) == 0 )
+        {
+          return i->second;
+        }
+      }
+      if( !add )
+      {
+        return NULL;
+      }
+      const std::string *string = new std::string( chars, length );
+      table.strings.insert( std::make_pair( hash, string ) );
+      return string;
+    }
+  }
+}
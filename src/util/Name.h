@@ -0,0 +1,93 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __Name_H_
+#define __Name_H_
+
+#include <string>
+#include <functional>
+#include <stddef.h>
+
+namespace cocosdl
+{
+  namespace util
+  {
+    /**
+     * An interned string, used for node names. Every distinct string is stored once for the life of the program, so
+     * names compare and hash by pointer, and copying a name copies a pointer.<br/>
+     * Creating a name looks the string up in the shared table (under a lock, allocating only the first time a string is
+     * seen); code looking nodes up every frame should keep its names, for instance as static constants.
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    class Name
+    {
+
+    public:
+      /**
+       * Create the empty name.
+       */
+      Name();
+
+      Name( const char *chars );
+
+      Name( const std::string &string );
+
+      const std::string &getString() const
+      {
+        return *_string;
+      }
+
+      bool empty() const
+      {
+        return _string->empty();
+      }
+
+      bool operator == ( const Name &other ) const
+      {
+        return _string == other._string;
+      }
+
+      bool operator != ( const Name &other ) const
+      {
+        return _string != other._string;
+      }
+
+      size_t getHash() const
+      {
+        return std::hash<const std::string *>()( _string );
+      }
+
+      /**
+       * Find the name for a string without interning it.
+       *
+       * @param chars string characters, not necessarily null terminated
+       * @param length string length
+       * @param name set to the name if found
+       * @return true if the string has been interned, false if no name has that string
+       */
+      static bool find( const char *chars, const size_t length, Name &name );
+
+    private:
+      const std::string *_string;
+
+      static const std::string *intern( const char *chars, const size_t length, const bool add );
+    };
+  }
+}
+
+#endif //__Name_H_
@@ -0,0 +1,136 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <new>
+#include "NodeArena.h"
+#include "BlockPool.h"
+#include "Log.h"
+
+namespace cocosdl
+{
+  namespace util
+  {
+    static NodeArena *_currentArena = NULL;
+
+    NodeArena::Scope::Scope( NodeArena *arena ) : _previous( _currentArena )
+    {
+      _currentArena = arena;
+    }
+
+    NodeArena::Scope::~Scope()
+    {
+      _currentArena = _previous;
+    }
+
+    NodeArena::NodeArena( const size_t nodesPerSlab ) :
+    _nodesPerSlab( nodesPerSlab > 0 ? nodesPerSlab : 1 ),
+    _pools( BlockPool::MAX_POOLED_SIZE / BlockPool::SIZE_CLASS_STEP, NULL ),
+    _liveCount( 0 ),
+    _released( false )
+    {
+    }
+
+    NodeArena::~NodeArena()
+    {
+      if( !reset() )
+      {
+        // freeing the blocks under live nodes would only move the crash elsewhere
+        Log::error() << "NodeArena deleted with " << _liveCount << " live nodes, leaking its memory" << std::endl;
+      }
+    }
+
+    void *NodeArena::allocate( const size_t size )
+    {
+      if( size == 0 || size > BlockPool::MAX_POOLED_SIZE )
+      {
+        _liveCount++;
+        return ::operator new( size );
+      }
+      size_t index = ( size - 1 ) / BlockPool::SIZE_CLASS_STEP;
+      if( !_pools[index] )
+      {
+        _pools[index] = new BlockPool( ( index + 1 ) * BlockPool::SIZE_CLASS_STEP, _nodesPerSlab );
+      }
+      _liveCount++;
+      return _pools[index]->allocate();
+    }
+
+    void NodeArena::deallocate( void *block, const size_t size )
+    {
+      if( block == NULL )
+      {
+        return;
+      }
+      _liveCount--;
+      if( size == 0 || size > BlockPool::MAX_POOLED_SIZE )
+      {
+        ::operator delete( block );
+      }
+      else
+      {
+        _pools[( size - 1 ) / BlockPool::SIZE_CLASS_STEP]->deallocate( block );
+      }
+      if( _released && _liveCount == 0 )
+      {
+        delete this;
+      }
+    }
+
+    void NodeArena::release()
+    {
+      if( _liveCount > 0 )
+      {
+        Log::info() << "NodeArena released with " << _liveCount << " live nodes, kept until they are deleted"
+                    << std::endl;
+        _released = true;
+        return;
+      }
+      delete this;
+    }
+
+    bool NodeArena::reset()
+    {
+      if( _liveCount > 0 )
+      {
+        return false;
+      }
+      for( size_t i = 0; i < _pools.size(); i++ )
+      {
+        delete _pools[i];
+        _pools[i] = NULL;
+      }
+      return true;
+    }
+
+    size_t NodeArena::getCapacity() const
+    {
+      size_t capacity = 0;
+      for( size_t i = 0; i < _pools.size(); i++ )
+      {
+        if( _pools[i] )
+        {
+          capacity += _pools[i]->getCapacity() * _pools[i]->getBlockSize();
+        }
+      }
+      return capacity;
+    }
+
+    NodeArena *NodeArena::getCurrent()
+    {
+      return _currentArena;
+    }
+  }
+}
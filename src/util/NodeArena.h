@@ -0,0 +1,143 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __NodeArena_H_
+#define __NodeArena_H_
+
+#include <vector>
+#include <stddef.h>
+
+namespace cocosdl
+{
+  namespace util
+  {
+    class BlockPool;
+
+    /**
+     * Memory for the nodes of one scene: a private set of size class pools (see BlockPool) that nodes are allocated
+     * from while the arena is current, and that are all released at once when the arena is reset or deleted.<br/>
+     * Nodes allocated in an arena are still owned and deleted as usual by their parents, their blocks are recycled for
+     * the next nodes of the scene; the arena only takes care of handing the memory back in one go at teardown.<br/>
+     * The current arena is shared by all threads, nodes are expected to be created on the game thread.
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    class NodeArena
+    {
+
+    public:
+      static const size_t DEFAULT_NODES_PER_SLAB = 256;
+
+      /**
+       * Makes an arena current for its lifetime, restoring the previous one when it ends.
+       */
+      class Scope
+      {
+
+      public:
+        Scope( NodeArena *arena );
+
+        ~Scope();
+
+      private:
+        NodeArena *_previous;
+
+        Scope( const Scope &other );
+
+        Scope &operator = ( const Scope &other );
+      };
+
+      /**
+       * Create an arena.
+       *
+       * @param nodesPerSlab nodes allocated at once when a size class runs out of free blocks
+       */
+      NodeArena( const size_t nodesPerSlab = DEFAULT_NODES_PER_SLAB );
+
+      /**
+       * Release the memory of the arena. If any of its nodes is still alive the memory is kept, and the error logged;
+       * arenas whose nodes may outlive them must be released with release instead.
+       */
+      virtual ~NodeArena();
+
+      /**
+       * Delete an arena created with new. If nodes allocated in it are still alive, such as nodes removed from their
+       * parent without deleting them, the arena stays until the last one is deleted, and then deletes itself.
+       */
+      void release();
+
+      /**
+       * Allocate a block from the pool of its size class.
+       *
+       * @param size block size in bytes
+       * @return memory block
+       */
+      void *allocate( const size_t size );
+
+      /**
+       * Return a block to the arena. The size must be the same used to allocate it.
+       *
+       * @param block memory block
+       * @param size size in bytes used to allocate the block
+       */
+      void deallocate( void *block, const size_t size );
+
+      /**
+       * Release all the memory of the arena at once. Only possible when none of its blocks are in use.
+       *
+       * @return true if released, false if blocks are still in use
+       */
+      bool reset();
+
+      /**
+       * Get the number of blocks in use.
+       *
+       * @return live nodes allocated in the arena
+       */
+      size_t getLiveCount() const
+      {
+        return _liveCount;
+      }
+
+      /**
+       * Get the memory owned by the arena, used or free.
+       *
+       * @return size in bytes
+       */
+      size_t getCapacity() const;
+
+      /**
+       * Get the arena nodes are being allocated from.
+       *
+       * @return the current arena, NULL for the shared pools
+       */
+      static NodeArena *getCurrent();
+
+    private:
+      size_t                    _nodesPerSlab;
+      std::vector<BlockPool *>  _pools;       // by size class, created when first used
+      size_t                    _liveCount;
+      bool                      _released;    // deleted by the last live node
+
+      NodeArena( const NodeArena &other );
+
+      NodeArena &operator = ( const NodeArena &other );
+    };
+  }
+}
+
+#endif //__NodeArena_H_
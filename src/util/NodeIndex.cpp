@@ -0,0 +1,101 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "NodeIndex.h"
+#include "Node.h"
+
+namespace cocosdl
+{
+  namespace util
+  {
+    NodeIndex::NodeIndex()
+    {
+    }
+
+    NodeIndex::~NodeIndex()
+    {
+    }
+
+    void NodeIndex::add( Node *node )
+    {
+      if( !node->_name.empty() )
+      {
+        NameKey key = { node->_parent, node->_name };
+        _names.insert( std::make_pair( key, node ) );
+      }
+      if( node->_tag != Node::NO_TAG )
+      {
+        TagKey key = { node->_parent, node->_tag };
+        _tags.insert( std::make_pair( key, node ) );
+      }
+    }
+
+    void NodeIndex::remove( const Node *node )
+    {
+      if( !node->_name.empty() )
+      {
+        NameKey key = { node->_parent, node->_name };
+        removeFrom( _names, key, node );
+      }
+      if( node->_tag != Node::NO_TAG )
+      {
+        TagKey key = { node->_parent, node->_tag };
+        removeFrom( _tags, key, node );
+      }
+    }
+
+    Node *NodeIndex::findByName( const Node *parent, const Name &name ) const
+    {
+      NameKey key = { parent, name };
+      return findFirst( _names, key );
+    }
+
+    Node *NodeIndex::findByTag( const Node *parent, const int tag ) const
+    {
+      TagKey key = { parent, tag };
+      return findFirst( _tags, key );
+    }
+
+    template<class Map>
+    Node *NodeIndex::findFirst( const Map &map, const typename Map::key_type &key )
+    {
+      Node *first = NULL;
+      std::pair<typename Map::const_iterator, typename Map::const_iterator> range = map.equal_range( key );
+      for( typename Map::const_iterator i = range.first; i != range.second; ++i )
+      {
+        if( !first || i->second->_childIndex < first->_childIndex )
+        {
+          first = i->second;
+        }
+      }
+      return first;
+    }
+
+    template<class Map>
+    void NodeIndex::removeFrom( Map &map, const typename Map::key_type &key, const Node *node )
+    {
+      std::pair<typename Map::iterator, typename Map::iterator> range = map.equal_range( key );
+      for( typename Map::iterator i = range.first; i != range.second; ++i )
+      {
+        if( i->second == node )
+        {
+          map.erase( i );
+          return;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,139 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __NodeIndex_H_
+#define __NodeIndex_H_
+
+#include <unordered_map>
+#include <stddef.h>
+#include "Name.h"
+
+namespace cocosdl
+{
+  class Node;
+
+  namespace util
+  {
+    /**
+     * Hash index of the nodes of a tree by their parent and name, and by their parent and tag, used by Node to find
+     * children without scanning them. Unnamed and untagged nodes are not indexed.<br/>
+     * The index does not follow the nodes: Node adds and removes them as they are added, removed, renamed or
+     * retagged.
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    class NodeIndex
+    {
+
+    public:
+      NodeIndex();
+
+      virtual ~NodeIndex();
+
+      /**
+       * Add a node under its parent, name and tag.
+       *
+       * @param node the node
+       */
+      void add( Node *node );
+
+      /**
+       * Remove a node, which must have the parent, name and tag it was added with.
+       *
+       * @param node the node
+       */
+      void remove( const Node *node );
+
+      /**
+       * Find a child by name. When several children share it, the first one in the parent's children is returned.
+       *
+       * @param parent the parent
+       * @param name child name
+       * @return the child, NULL if none has that name
+       */
+      Node *findByName( const Node *parent, const Name &name ) const;
+
+      /**
+       * Find a child by tag. When several children share it, the first one in the parent's children is returned.
+       *
+       * @param parent the parent
+       * @param tag child tag
+       * @return the child, NULL if none has that tag
+       */
+      Node *findByTag( const Node *parent, const int tag ) const;
+
+      size_t getCount() const
+      {
+        return _names.size() + _tags.size();
+      }
+
+    private:
+      struct NameKey
+      {
+        const Node  *parent;
+        Name        name;
+
+        bool operator == ( const NameKey &other ) const
+        {
+          return parent == other.parent && name == other.name;
+        }
+      };
+
+      struct NameKeyHash
+      {
+        size_t operator()( const NameKey &key ) const
+        {
+          return std::hash<const Node *>()( key.parent ) * 31 + key.name.getHash();
+        }
+      };
+
+      struct TagKey
+      {
+        const Node  *parent;
+        int         tag;
+
+        bool operator == ( const TagKey &other ) const
+        {
+          return parent == other.parent && tag == other.tag;
+        }
+      };
+
+      struct TagKeyHash
+      {
+        size_t operator()( const TagKey &key ) const
+        {
+          return std::hash<const Node *>()( key.parent ) * 31 + std::hash<int>()( key.tag );
+        }
+      };
+
+      std::unordered_multimap<NameKey, Node *, NameKeyHash>  _names;
+      std::unordered_multimap<TagKey, Node *, TagKeyHash>    _tags;
+
+      NodeIndex( const NodeIndex &other );
+
+      NodeIndex &operator = ( const NodeIndex &other );
+
+      template<class Map>
+      static Node *findFirst( const Map &map, const typename Map::key_type &key );
+
+      template<class Map>
+      static void removeFrom( Map &map, const typename Map::key_type &key, const Node *node );
+    };
+  }
+}
+
+#endif //__NodeIndex_H_
@@ -14,6 +14,7 @@
    limitations under the License.
 */
 
+#include <algorithm>
 #include "NodeVector.h"
 #include "Node.h"
 
@@ -23,18 +24,28 @@ namespace cocosdl
 {
   namespace util
   {
+    static bool isBelow( const Node *node, const Node *other )
+    {
+      return node->getZOrder() < other->getZOrder();
+    }
+
+    NodeVector::NodeVector() : _emptySlots( 0 ), _unsorted( false )
+    {
+    }
+
     void NodeVector::push( Node *node )
     {
-      if( node == NULL )
+      if( node == NULL || contains( node ) )
       {
         return;
       }
 
-      iterator position = find( begin(), end(), node );
-      if( position == end() )
+      if( !empty() && ( !back() || isBelow( node, back() ) ) )
       {
-        vector<Node *>::push_back( node );
+        _unsorted = true;
       }
+      node->_childIndex = size();
+      vector<Node *>::push_back( node );
     }
 
     void NodeVector::remove( Node *node )
@@ -44,17 +55,97 @@ namespace cocosdl
         return;
       }
 
-      iterator position = find( begin(), end(), node );
-      if( position != end() )
+      size_t index = node->_childIndex;
+      if( !contains( node ) )
       {
-        erase( position );
+        // not where its index says, only if it was added to another parent without leaving this one first
+        iterator position = find( begin(), end(), node );
+        if( position == end() )
+        {
+          return;
+        }
+        index = (size_t) ( position - begin() );
       }
+      else
+      {
+        node->_childIndex = NO_INDEX;
+      }
+      at( index ) = NULL;
+      _emptySlots++;
     }
 
     void NodeVector::push_back( Node *node )
     {
       push( node );
     }
+
+    void NodeVector::insert( const size_t position, Node *node )
+    {
+      if( node == NULL || contains( node ) )
+      {
+        return;
+      }
+
+      compact();
+      size_t index = position < size() ? position : size();
+      _unsorted = true;
+      vector<Node *>::insert( begin() + index, node );
+      for( size_t i = index; i < size(); i++ )
+      {
+        at( i )->_childIndex = i;
+      }
+    }
+
+    bool NodeVector::contains( const Node *node ) const
+    {
+      size_t index = node->_childIndex;
+      return index < size() && at( index ) == node;
+    }
+
+    void NodeVector::compact()
+    {
+      if( _emptySlots == 0 )
+      {
+        return;
+      }
+
+      size_t count = size();
+      size_t last = 0;
+      for( size_t i = 0; i < count; i++ )
+      {
+        Node *node = at( i );
+        if( node )
+        {
+          if( node->_childIndex == i )
+          {
+            node->_childIndex = last;
+          }
+          at( last++ ) = node;
+        }
+      }
+      resize( last );
+      _emptySlots = 0;
+    }
+
+    void NodeVector::sort()
+    {
+      compact();
+      if( !_unsorted )
+      {
+        return;
+      }
+
+      _unsorted = false;
+      if( !is_sorted( begin(), end(), isBelow ) )
+      {
+        stable_sort( begin(), end(), isBelow );
+        size_t count = size();
+        for( size_t i = 0; i < count; i++ )
+        {
+          at( i )->_childIndex = i;
+        }
+      }
+    }
   }
 
 }
@@ -18,6 +18,7 @@
 #define __NodeVector_H_
 
 #include <vector>
+#include <stddef.h>
 
 namespace cocosdl {
 
@@ -27,7 +28,13 @@ namespace cocosdl {
   {
     /**
      * Special subclass of vector used in Node to store its children, provides unique push (to disallow duplicates) and
-     * removal by passing the node instead of a position.
+     * removal by passing the node instead of a position.<br/>
+     * Every child keeps its own index in the vector, so both take constant time: a removed child leaves an empty
+     * (NULL) slot behind, and the empty slots are compacted in a single pass that keeps the children order, the drawing
+     * order, when the parent is visited by the game loop each frame. Removing never moves the other nodes, so loops
+     * over the vector may remove nodes from it.<br/>
+     * Nodes are kept sorted by z order, stable so equal values keep the order they were added in. Adding a node out of
+     * order or changing the z order of a child only flags the vector, which is sorted once when it is next drawn.
      *
      * @author narciso.cerezo@gmail.com
      * @version 1.0
@@ -36,11 +43,74 @@ namespace cocosdl {
     {
 
     public:
+      static const size_t NO_INDEX = (size_t) -1;
+
+      NodeVector();
+
       void push( Node *node );
 
       void remove( Node *node );
 
       void push_back( Node *node );
+
+      /**
+       * Insert a node at a position, moving the following ones.
+       *
+       * @param position position in the vector, after compacting it
+       * @param node the node
+       */
+      void insert( const size_t position, Node *node );
+
+      /**
+       * Check if a node is in this vector.
+       *
+       * @param node the node
+       * @return true if it is
+       */
+      bool contains( const Node *node ) const;
+
+      /**
+       * Remove the empty slots left by removed nodes.
+       */
+      void compact();
+
+      /**
+       * Flag the vector to be sorted, after the z order of a node in it changed.
+       */
+      void invalidateOrder()
+      {
+        _unsorted = true;
+      }
+
+      /**
+       * Compact the vector and sort it by z order if flagged.
+       */
+      void sort();
+
+      /**
+       * Check if the nodes are known to be in z order, as they are after sort until a node is added out of order or
+       * the z order of one changes.
+       *
+       * @return true if sorted
+       */
+      bool isSorted() const
+      {
+        return !_unsorted;
+      }
+
+      /**
+       * Get the number of nodes, not counting empty slots.
+       *
+       * @return node count
+       */
+      size_t getCount() const
+      {
+        return size() - _emptySlots;
+      }
+
+    private:
+      size_t  _emptySlots;
+      bool    _unsorted;
     };
   }
 
@@ -0,0 +1,123 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __RingBuffer_H_
+#define __RingBuffer_H_
+
+#include <vector>
+#include <stddef.h>
+
+namespace cocosdl
+{
+  namespace util
+  {
+    /**
+     * A FIFO queue stored in a circular buffer. The storage doubles when full and is never shrunk, so once it has
+     * grown to the working size pushing and popping never allocate.<br/>
+     * It is not synchronized, callers sharing it between threads must lock around it.
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    template <class T>
+    class RingBuffer
+    {
+
+    public:
+      /**
+       * Constructor.
+       *
+       * @param capacity initial capacity, rounded up to a power of two
+       */
+      RingBuffer( const size_t capacity = 64 ) : _head( 0 ), _count( 0 )
+      {
+        size_t size = 1;
+        while( size < capacity )
+        {
+          size <<= 1;
+        }
+        _items.resize( size );
+      }
+
+      void push( const T &item )
+      {
+        if( _count == _items.size() )
+        {
+          grow();
+        }
+        _items[( _head + _count ) & ( _items.size() - 1 )] = item;
+        _count++;
+      }
+
+      /**
+       * Remove the oldest item.
+       *
+       * @param item set to the removed item
+       * @return false if the buffer was empty
+       */
+      bool pop( T &item )
+      {
+        if( _count == 0 )
+        {
+          return false;
+        }
+        item = _items[_head];
+        _head = ( _head + 1 ) & ( _items.size() - 1 );
+        _count--;
+        return true;
+      }
+
+      size_t size() const
+      {
+        return _count;
+      }
+
+      bool empty() const
+      {
+        return _count == 0;
+      }
+
+      size_t capacity() const
+      {
+        return _items.size();
+      }
+
+      void clear()
+      {
+        _head = 0;
+        _count = 0;
+      }
+
+    private:
+      std::vector<T>  _items;
+      size_t          _head;
+      size_t          _count;
+
+      void grow()
+      {
+        std::vector<T> items( _items.size() * 2 );
+        for( size_t i = 0; i < _count; i++ )
+        {
+          items[i] = _items[( _head + i ) & ( _items.size() - 1 )];
+        }
+        _items.swap( items );
+        _head = 0;
+      }
+    };
+  }
+}
+
+#endif //__RingBuffer_H_
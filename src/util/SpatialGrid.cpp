@@ -0,0 +1,223 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "SpatialGrid.h"
+
+using namespace std;
+
+namespace cocosdl
+{
+  namespace util
+  {
+    SpatialGrid::SpatialGrid( const int cellSize ) : _cellSize( cellSize > 0 ? cellSize : 1 ), _queryMark( 0 )
+    {
+    }
+
+    SpatialGrid::~SpatialGrid()
+    {
+      clear();
+    }
+
+    void SpatialGrid::update( Node *node, const int x, const int y, const int width, const int height )
+    {
+      Entry *entry;
+      unordered_map<const Node *, Entry *>::iterator position = _entries.find( node );
+      if( position != _entries.end() )
+      {
+        entry = position->second;
+      }
+      else
+      {
+        entry = new Entry();
+        entry->node = node;
+        entry->firstColumn = entry->firstRow = 0;
+        entry->lastColumn = entry->lastRow = -1;
+        entry->large = false;
+        entry->queryMark = 0;
+        _entries[node] = entry;
+      }
+      entry->x = x;
+      entry->y = y;
+      entry->width = width;
+      entry->height = height;
+
+      int firstColumn = 0, firstRow = 0, lastColumn = -1, lastRow = -1;
+      if( width > 0 && height > 0 )
+      {
+        firstColumn = toCell( x );
+        firstRow = toCell( y );
+        lastColumn = toCell( x + width - 1 );
+        lastRow = toCell( y + height - 1 );
+      }
+      if( firstColumn == entry->firstColumn && firstRow == entry->firstRow && lastColumn == entry->lastColumn &&
+          lastRow == entry->lastRow )
+      {
+        // still in the same cells
+        return;
+      }
+      removeFromCells( entry );
+      entry->firstColumn = firstColumn;
+      entry->firstRow = firstRow;
+      entry->lastColumn = lastColumn;
+      entry->lastRow = lastRow;
+      addToCells( entry );
+    }
+
+    void SpatialGrid::remove( const Node *node )
+    {
+      unordered_map<const Node *, Entry *>::iterator position = _entries.find( node );
+      if( position != _entries.end() )
+      {
+        removeFromCells( position->second );
+        delete position->second;
+        _entries.erase( position );
+      }
+    }
+
+    void SpatialGrid::clear()
+    {
+      for( unordered_map<const Node *, Entry *>::iterator i = _entries.begin(); i != _entries.end(); ++i )
+      {
+        delete i->second;
+      }
+      _entries.clear();
+      _cells.clear();
+      _largeEntries.clear();
+    }
+
+    void SpatialGrid::findAt( const int x, const int y, vector<Node *> &nodes ) const
+    {
+      findIn( x, y, 1, 1, nodes );
+    }
+
+    void SpatialGrid::findIn( const int x, const int y, const int width, const int height, vector<Node *> &nodes ) const
+    {
+      if( width <= 0 || height <= 0 )
+      {
+        return;
+      }
+      // the mark reports nodes spanning several of the cells only once
+      Uint32 mark = ++_queryMark;
+      int firstColumn = toCell( x ), lastColumn = toCell( x + width - 1 );
+      int firstRow = toCell( y ), lastRow = toCell( y + height - 1 );
+      for( int row = firstRow; row <= lastRow; row++ )
+      {
+        for( int column = firstColumn; column <= lastColumn; column++ )
+        {
+          unordered_map<Uint64, Cell>::const_iterator cell = _cells.find( getCellKey( column, row ) );
+          if( cell == _cells.end() )
+          {
+            continue;
+          }
+          const Cell &entries = cell->second;
+          for( size_t i = 0; i < entries.size(); i++ )
+          {
+            Entry *entry = entries[i];
+            if( entry->queryMark != mark && entry->x < x + width && x < entry->x + entry->width &&
+                entry->y < y + height && y < entry->y + entry->height )
+            {
+              entry->queryMark = mark;
+              nodes.push_back( entry->node );
+            }
+          }
+        }
+      }
+      for( size_t i = 0; i < _largeEntries.size(); i++ )
+      {
+        Entry *entry = _largeEntries[i];
+        if( entry->x < x + width && x < entry->x + entry->width && entry->y < y + height &&
+            y < entry->y + entry->height )
+        {
+          nodes.push_back( entry->node );
+        }
+      }
+    }
+
+    void SpatialGrid::addToCells( Entry *entry )
+    {
+      if( entry->lastColumn < entry->firstColumn )
+      {
+        return;
+      }
+      long cellCount = (long) ( entry->lastColumn - entry->firstColumn + 1 ) * ( entry->lastRow - entry->firstRow + 1 );
+      entry->large = cellCount > MAX_CELLS_PER_NODE;
+      if( entry->large )
+      {
+        _largeEntries.push_back( entry );
+        return;
+      }
+      for( int row = entry->firstRow; row <= entry->lastRow; row++ )
+      {
+        for( int column = entry->firstColumn; column <= entry->lastColumn; column++ )
+        {
+          _cells[getCellKey( column, row )].push_back( entry );
+        }
+      }
+    }
+
+    void SpatialGrid::removeFromCells( Entry *entry )
+    {
+      if( entry->lastColumn < entry->firstColumn )
+      {
+        return;
+      }
+      if( entry->large )
+      {
+        removeFrom( _largeEntries, entry );
+        return;
+      }
+      for( int row = entry->firstRow; row <= entry->lastRow; row++ )
+      {
+        for( int column = entry->firstColumn; column <= entry->lastColumn; column++ )
+        {
+          unordered_map<Uint64, Cell>::iterator cell = _cells.find( getCellKey( column, row ) );
+          if( cell != _cells.end() )
+          {
+            removeFrom( cell->second, entry );
+            if( cell->second.empty() )
+            {
+              _cells.erase( cell );
+            }
+          }
+        }
+      }
+    }
+
+    int SpatialGrid::toCell( const int coordinate ) const
+    {
+      // rounding down, also for negative coordinates
+      return coordinate >= 0 ? coordinate / _cellSize : -( ( -coordinate - 1 ) / _cellSize ) - 1;
+    }
+
+    Uint64 SpatialGrid::getCellKey( const int column, const int row )
+    {
+      return ( (Uint64) (Uint32) column << 32 ) | (Uint32) row;
+    }
+
+    void SpatialGrid::removeFrom( vector<Entry *> &entries, const Entry *entry )
+    {
+      for( size_t i = 0; i < entries.size(); i++ )
+      {
+        if( entries[i] == entry )
+        {
+          entries[i] = entries.back();
+          entries.pop_back();
+          return;
+        }
+      }
+    }
+  }
+}
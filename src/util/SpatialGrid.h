@@ -0,0 +1,143 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __SpatialGrid_H_
+#define __SpatialGrid_H_
+
+#include <vector>
+#include <unordered_map>
+#include <stddef.h>
+#include <SDL2/SDL.h>
+
+namespace cocosdl
+{
+  class Node;
+
+  namespace util
+  {
+    /**
+     * A uniform grid of nodes by their bounds, used by Node to index its children so hit testing and area queries
+     * only look at the nodes in the cells they touch. Bounds are given in the coordinates of the parent, so moving the
+     * parent or its ancestors does not change them, and each update only moves the node between the cells it left and
+     * entered. Nodes spanning more than MAX_CELLS_PER_NODE cells are kept apart and tested by every query.
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    class SpatialGrid
+    {
+
+    public:
+      static const int MAX_CELLS_PER_NODE = 64;
+
+      /**
+       * Create a grid.
+       *
+       * @param cellSize cell width and height, about the size of the indexed nodes works best
+       */
+      SpatialGrid( const int cellSize );
+
+      virtual ~SpatialGrid();
+
+      int getCellSize() const
+      {
+        return _cellSize;
+      }
+
+      /**
+       * Add a node or update its bounds.
+       *
+       * @param node the node
+       * @param x bounds x
+       * @param y bounds y
+       * @param width bounds width
+       * @param height bounds height
+       */
+      void update( Node *node, const int x, const int y, const int width, const int height );
+
+      /**
+       * Remove a node.
+       *
+       * @param node the node
+       */
+      void remove( const Node *node );
+
+      /**
+       * Remove every node.
+       */
+      void clear();
+
+      /**
+       * Find the nodes whose bounds contain a point.
+       *
+       * @param x point x
+       * @param y point y
+       * @param nodes filled with the nodes found, in no particular order
+       */
+      void findAt( const int x, const int y, std::vector<Node *> &nodes ) const;
+
+      /**
+       * Find the nodes whose bounds overlap an area.
+       *
+       * @param x area x
+       * @param y area y
+       * @param width area width
+       * @param height area height
+       * @param nodes filled with the nodes found, in no particular order
+       */
+      void findIn( const int x, const int y, const int width, const int height, std::vector<Node *> &nodes ) const;
+
+      size_t getCount() const
+      {
+        return _entries.size();
+      }
+
+    private:
+      struct Entry
+      {
+        Node    *node;
+        int     x, y, width, height;
+        int     firstColumn, firstRow, lastColumn, lastRow;   // cells covered, none if lastColumn < firstColumn
+        bool    large;
+        Uint32  queryMark;                                    // last query that reported it
+      };
+
+      typedef std::vector<Entry *> Cell;
+
+      int                                         _cellSize;
+      std::unordered_map<const Node *, Entry *>   _entries;
+      std::unordered_map<Uint64, Cell>            _cells;
+      std::vector<Entry *>                        _largeEntries;
+      mutable Uint32                              _queryMark;
+
+      SpatialGrid( const SpatialGrid &other );
+
+      SpatialGrid &operator = ( const SpatialGrid &other );
+
+      void addToCells( Entry *entry );
+
+      void removeFromCells( Entry *entry );
+
+      int toCell( const int coordinate ) const;
+
+      static Uint64 getCellKey( const int column, const int row );
+
+      static void removeFrom( std::vector<Entry *> &entries, const Entry *entry );
+    };
+  }
+}
+
+#endif //__SpatialGrid_H_
@@ -0,0 +1,321 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <vector>
+#include <SDL2_image/SDL_image.h>
+#include "TextureCache.h"
+#include "Game.h"
+#include "Log.h"
+
+namespace cocosdl
+{
+  namespace util
+  {
+    char const *const TextureCache::FILE_EXTENSION = ".cdlt";
+
+    static const Uint8 MAGIC[4] = { 'C', 'D', 'L', 'T' };
+    static const Uint32 MAX_DIMENSION = 16384;
+
+    static bool _enabled = false;
+    static std::string _writeDirectory;
+    static std::atomic<size_t> _hits( 0 );
+    static std::atomic<size_t> _misses( 0 );
+    static std::atomic<unsigned int> _writeCount( 0 );
+
+    static Uint32 readU32( const Uint8 *data )
+    {
+      return (Uint32) data[0] | ( (Uint32) data[1] << 8 ) | ( (Uint32) data[2] << 16 ) | ( (Uint32) data[3] << 24 );
+    }
+
+    static void putU32( Uint8 *data, const Uint32 value )
+    {
+      for( int i = 0; i < 4; i++ )
+      {
+        data[i] = (Uint8) ( value >> ( 8 * i ) );
+      }
+    }
+
+    /**
+     * Check an entry header, getting the image size if it is valid for the source.
+     */
+    static bool parseHeader( const Uint8 *header, const Uint64 sourceHash, Uint32 &width, Uint32 &height )
+    {
+      if( memcmp( header, MAGIC, sizeof( MAGIC ) ) != 0 || readU32( header + 4 ) != TextureCache::FORMAT_VERSION ||
+          readU32( header + 24 ) != TextureCache::PIXEL_FORMAT )
+      {
+        return false;
+      }
+      Uint64 hash = (Uint64) readU32( header + 16 ) | ( (Uint64) readU32( header + 20 ) << 32 );
+      width = readU32( header + 8 );
+      height = readU32( header + 12 );
+      return hash == sourceHash && width > 0 && height > 0 && width <= MAX_DIMENSION && height <= MAX_DIMENSION;
+    }
+
+    static std::string getEntryPath( const Uint64 sourceHash )
+    {
+      char name[32];
+      snprintf( name, sizeof( name ), "%016llx", (unsigned long long) sourceHash );
+      return _writeDirectory + name + TextureCache::FILE_EXTENSION;
+    }
+
+    void TextureCache::enable( const std::string &writeDirectory )
+    {
+      _writeDirectory = writeDirectory;
+      _enabled = true;
+    }
+
+    void TextureCache::disable()
+    {
+      _enabled = false;
+      _writeDirectory.clear();
+    }
+
+    bool TextureCache::isEnabled()
+    {
+      return _enabled;
+    }
+
+    SDL_Surface *TextureCache::loadSurface( const std::string &fileName )
+    {
+      Game *game = Game::getInstance();
+      if( !_enabled )
+      {
+        SDL_RWops *rw = game->openResource( fileName );
+        return rw ? IMG_Load_RW( rw, 1 ) : NULL;
+      }
+
+      // the source is read anyway to validate the entry, so a miss decodes it from memory
+      size_t size = 0;
+      const void *source = game->getArchivedResource( fileName, size );
+      std::vector<Uint8> buffer;
+      if( !source )
+      {
+        SDL_RWops *rw = game->openResource( fileName );
+        if( !rw )
+        {
+          return NULL;
+        }
+        Sint64 fileSize = SDL_RWsize( rw );
+        if( fileSize > 0 )
+        {
+          buffer.resize( (size_t) fileSize );
+          if( SDL_RWread( rw, &buffer[0], (size_t) fileSize, 1 ) != 1 )
+          {
+            buffer.clear();
+          }
+        }
+        SDL_RWclose( rw );
+        if( buffer.empty() )
+        {
+          return NULL;
+        }
+        source = &buffer[0];
+        size = buffer.size();
+      }
+
+      Uint64 sourceHash = hashContents( source, size );
+      SDL_Surface *surface = readEntry( fileName + FILE_EXTENSION, sourceHash );
+      if( !surface && !_writeDirectory.empty() )
+      {
+        SDL_RWops *rw = SDL_RWFromFile( getEntryPath( sourceHash ).c_str(), "rb" );
+        surface = rw ? readEntry( rw, sourceHash ) : NULL;
+      }
+      if( surface )
+      {
+        _hits++;
+        return surface;
+      }
+
+      _misses++;
+      surface = decodeImage( source, size );
+      if( surface && !_writeDirectory.empty() )
+      {
+        write( getEntryPath( sourceHash ), surface, sourceHash );
+      }
+      return surface;
+    }
+
+    SDL_Surface *TextureCache::readEntry( const std::string &fileName, const Uint64 sourceHash )
+    {
+      Game *game = Game::getInstance();
+      size_t size;
+      const Uint8 *data = static_cast<const Uint8 *>( game->getArchivedResource( fileName, size ) );
+      if( data )
+      {
+        Uint32 width;
+        Uint32 height;
+        if( size < HEADER_SIZE || !parseHeader( data, sourceHash, width, height ) ||
+            size - HEADER_SIZE < (size_t) width * height * 4 )
+        {
+          return NULL;
+        }
+        // the archive outlives every texture, its pixels are uploaded in place
+        return SDL_CreateRGBSurfaceWithFormatFrom( const_cast<Uint8 *>( data + HEADER_SIZE ), (int) width,
+                                                   (int) height, 32, (int) width * 4, PIXEL_FORMAT );
+      }
+      SDL_RWops *rw = game->openResource( fileName );
+      return rw ? readEntry( rw, sourceHash ) : NULL;
+    }
+
+    SDL_Surface *TextureCache::readEntry( SDL_RWops *rw, const Uint64 sourceHash )
+    {
+      Uint8 header[HEADER_SIZE];
+      Uint32 width;
+      Uint32 height;
+      SDL_Surface *surface = NULL;
+      if( SDL_RWread( rw, header, HEADER_SIZE, 1 ) == 1 && parseHeader( header, sourceHash, width, height ) )
+      {
+        surface = SDL_CreateRGBSurfaceWithFormat( 0, (int) width, (int) height, 32, PIXEL_FORMAT );
+      }
+      if( surface )
+      {
+        const size_t rowSize = (size_t) width * 4;
+        Uint8 *row = static_cast<Uint8 *>( surface->pixels );
+        bool ok = true;
+        if( (size_t) surface->pitch == rowSize )
+        {
+          ok = SDL_RWread( rw, row, rowSize * height, 1 ) == 1;
+        }
+        else
+        {
+          for( Uint32 y = 0; ok && y < height; y++, row += surface->pitch )
+          {
+            ok = SDL_RWread( rw, row, rowSize, 1 ) == 1;
+          }
+        }
+        if( !ok )
+        {
+          SDL_FreeSurface( surface );
+          surface = NULL;
+        }
+      }
+      SDL_RWclose( rw );
+      return surface;
+    }
+
+    SDL_Surface *TextureCache::decodeImage( const void *data, const size_t size )
+    {
+      SDL_Surface *image = IMG_Load_RW( SDL_RWFromConstMem( data, (int) size ), 1 );
+      if( !image || image->format->format == PIXEL_FORMAT )
+      {
+        return image;
+      }
+      SDL_Surface *converted = SDL_ConvertSurfaceFormat( image, PIXEL_FORMAT, 0 );
+      SDL_FreeSurface( image );
+      return converted;
+    }
+
+    bool TextureCache::write( const std::string &filePath, SDL_Surface *surface, const Uint64 sourceHash )
+    {
+      if( surface->format->format != PIXEL_FORMAT )
+      {
+        return false;
+      }
+      Uint8 header[HEADER_SIZE];
+      memset( header, 0, HEADER_SIZE );
+      memcpy( header, MAGIC, sizeof( MAGIC ) );
+      putU32( header + 4, FORMAT_VERSION );
+      putU32( header + 8, (Uint32) surface->w );
+      putU32( header + 12, (Uint32) surface->h );
+      putU32( header + 16, (Uint32) sourceHash );
+      putU32( header + 20, (Uint32) ( sourceHash >> 32 ) );
+      putU32( header + 24, PIXEL_FORMAT );
+
+      // written aside and renamed, so a concurrent load or a crash never sees a partial entry
+      char suffix[32];
+      snprintf( suffix, sizeof( suffix ), ".%u.tmp", _writeCount++ );
+      const std::string tempPath = filePath + suffix;
+      SDL_RWops *rw = SDL_RWFromFile( tempPath.c_str(), "wb" );
+      if( !rw )
+      {
+        Log::error() << "Can't create texture cache entry " << tempPath << std::endl;
+        return false;
+      }
+      bool ok = SDL_RWwrite( rw, header, HEADER_SIZE, 1 ) == 1;
+      const size_t rowSize = (size_t) surface->w * 4;
+      const Uint8 *row = static_cast<const Uint8 *>( surface->pixels );
+      for( int y = 0; ok && y < surface->h; y++, row += surface->pitch )
+      {
+        ok = SDL_RWwrite( rw, row, rowSize, 1 ) == 1;
+      }
+      SDL_RWclose( rw );
+      if( ok )
+      {
+        ok = rename( tempPath.c_str(), filePath.c_str() ) == 0;
+        if( !ok )
+        {
+          // Windows does not replace existing files
+          remove( filePath.c_str() );
+          ok = rename( tempPath.c_str(), filePath.c_str() ) == 0;
+        }
+      }
+      if( !ok )
+      {
+        remove( tempPath.c_str() );
+        Log::error() << "Can't write texture cache entry " << filePath << std::endl;
+      }
+      return ok;
+    }
+
+    bool TextureCache::isValid( const std::string &filePath, const Uint64 sourceHash )
+    {
+      SDL_RWops *rw = SDL_RWFromFile( filePath.c_str(), "rb" );
+      if( !rw )
+      {
+        return false;
+      }
+      Uint8 header[HEADER_SIZE];
+      Uint32 width;
+      Uint32 height;
+      bool valid = SDL_RWread( rw, header, HEADER_SIZE, 1 ) == 1 && parseHeader( header, sourceHash, width, height );
+      SDL_RWclose( rw );
+      return valid;
+    }
+
+    Uint64 TextureCache::hashContents( const void *data, const size_t size )
+    {
+      // FNV-1a over 64 bit little endian words, as hashing runs on every load it must be far cheaper than decoding
+      const Uint8 *bytes = static_cast<const Uint8 *>( data );
+      Uint64 hash = 14695981039346656037ULL ^ (Uint64) size;
+      size_t i = 0;
+      for( ; i + 8 <= size; i += 8 )
+      {
+        Uint64 word;
+        memcpy( &word, bytes + i, sizeof( word ) );
+        hash = ( hash ^ SDL_SwapLE64( word ) ) * 1099511628211ULL;
+        hash ^= hash >> 32;
+      }
+      for( ; i < size; i++ )
+      {
+        hash = ( hash ^ bytes[i] ) * 1099511628211ULL;
+      }
+      return hash;
+    }
+
+    size_t TextureCache::getHitCount()
+    {
+      return _hits;
+    }
+
+    size_t TextureCache::getMissCount()
+    {
+      return _misses;
+    }
+  }
+}
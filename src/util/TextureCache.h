@@ -0,0 +1,133 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef __TextureCache_H_
+#define __TextureCache_H_
+
+#include <string>
+#include <stddef.h>
+#include <SDL2/SDL.h>
+
+namespace cocosdl
+{
+  namespace util
+  {
+    /**
+     * A cache of pre-decoded images, so textures are uploaded straight from raw pixels instead of running the JPEG or
+     * PNG decoder on every load.<br/>
+     * A decoded image is stored as a .cdlt file holding its RGBA pixels and the hash of the source file contents,
+     * which is checked on every load so a stale entry is never used. Entries are looked up first as a resource named
+     * after the source (e.g. "background.jpg.cdlt", baked offline with tools/BakeTextures.cpp and usually packed in
+     * the asset archive, where they are used in place without copying), and then in the write directory given to
+     * enable, where images decoded on a cache miss are stored so later runs skip the decoder.<br/>
+     * File layout (all integers little endian):
+     * <pre>
+     *   "CDLT" u32 version, u32 width, u32 height, u64 sourceHash, u32 pixelFormat, u32 reserved
+     *   height x width x 4 bytes of pixels in PIXEL_FORMAT
+     * </pre>
+     *
+     * @author narciso.cerezo@gmail.com
+     * @version 1.0
+     */
+    class TextureCache
+    {
+
+    public:
+      static const Uint32 FORMAT_VERSION = 1;
+      static const Uint32 PIXEL_FORMAT = SDL_PIXELFORMAT_ABGR8888;
+      static const size_t HEADER_SIZE = 32;
+      static char const *const FILE_EXTENSION;
+
+      /**
+       * Enable the cache. Set it up before loading any texture.
+       *
+       * @param writeDirectory directory, ending with a path separator, where images decoded on a cache miss are
+       * stored (such as the one returned by SDL_GetPrefPath). If empty only the baked entries are used.
+       */
+      static void enable( const std::string &writeDirectory = "" );
+
+      static void disable();
+
+      static bool isEnabled();
+
+      /**
+       * Load the image of a resource file, decoded and ready to be uploaded. Uses the cache when it is enabled, and
+       * decodes the source with SDL_image otherwise. Safe to call from any thread.
+       *
+       * @param fileName resource file name (including extension)
+       * @return the image, to be freed with SDL_FreeSurface, or NULL if it can't be loaded. Images read in place from
+       * the asset archive point to its memory and must not be modified.
+       */
+      static SDL_Surface *loadSurface( const std::string &fileName );
+
+      /**
+       * Decode an image with SDL_image, converting it to PIXEL_FORMAT.
+       *
+       * @param data encoded image (PNG, JPEG...)
+       * @param size data size in bytes
+       * @return the image, to be freed with SDL_FreeSurface, or NULL if it can't be decoded
+       */
+      static SDL_Surface *decodeImage( const void *data, const size_t size );
+
+      /**
+       * Write a decoded image as a cache entry.
+       *
+       * @param filePath full path of the file to write
+       * @param surface image in PIXEL_FORMAT
+       * @param sourceHash hashContents of the encoded source
+       * @return true if the file was written
+       */
+      static bool write( const std::string &filePath, SDL_Surface *surface, const Uint64 sourceHash );
+
+      /**
+       * Check whether a cache entry file matches its source, reading only its header.
+       *
+       * @param filePath full path of the entry file
+       * @param sourceHash hashContents of the encoded source
+       * @return true if the entry is valid for the source
+       */
+      static bool isValid( const std::string &filePath, const Uint64 sourceHash );
+
+      /**
+       * Hash the contents of a source file as done to validate cache entries.
+       *
+       * @param data file contents
+       * @param size data size in bytes
+       * @return contents hash
+       */
+      static Uint64 hashContents( const void *data, const size_t size );
+
+      /**
+       * Get the number of loads served from the cache since start.
+       */
+      static size_t getHitCount();
+
+      /**
+       * Get the number of loads that had to decode the source since the cache was enabled.
+       */
+      static size_t getMissCount();
+
+    private:
+      TextureCache();
+
+      static SDL_Surface *readEntry( const std::string &fileName, const Uint64 sourceHash );
+
+      static SDL_Surface *readEntry( SDL_RWops *rw, const Uint64 sourceHash );
+    };
+  }
+}
+
+#endif //__TextureCache_H_
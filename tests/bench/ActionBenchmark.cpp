@@ -0,0 +1,105 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Measures the time the game loop spends per frame with a large number of nodes running tween actions, with parallel
+ * action evaluation enabled or disabled.
+ *
+ *   ActionBenchmark [nodes=100000] [frames=300] [serial|parallel]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <CocosDL/CocosDL.h>
+
+using namespace cocosdl;
+using namespace cocosdl::action;
+
+class BenchmarkScene : public Scene
+{
+
+public:
+  BenchmarkScene( const int nodeCount, const int frameCount ) :
+  _frameCount( frameCount ), _frames( 0 ), _lastFrame( 0 ), _totalTicks( 0 ), _worstTicks( 0 )
+  {
+    SequenceAction *sequence = new SequenceAction();
+    sequence->addAction( new MoveByAction( 1000, 50, 0 ) );
+    sequence->addAction( new MoveByAction( 1000, -50, 0 ) );
+    RepeatForeverAction *tween = new RepeatForeverAction( sequence );
+    for( int i = 0; i < nodeCount; i++ )
+    {
+      Node *node = new Node();
+      node->setPosition( i % 640, i % 960 );
+      node->addAction( tween->copy() );
+      addChild( node );
+    }
+    DESTROY_ACTION( tween );
+  }
+
+  virtual void update( long long currentTimeMillis )
+  {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if( _lastFrame > 0 )
+    {
+      Uint64 ticks = now - _lastFrame;
+      _totalTicks += ticks;
+      _worstTicks = ticks > _worstTicks ? ticks : _worstTicks;
+      _frames++;
+    }
+    _lastFrame = now;
+    if( _frames == _frameCount )
+    {
+      Game::getInstance()->stopGame();
+    }
+  }
+
+  void report() const
+  {
+    double frequency = (double) SDL_GetPerformanceFrequency();
+    Log::info() << "frames: " << _frames
+                << ", average frame ms: " << ( _totalTicks * 1000.0 / frequency / ( _frames > 0 ? _frames : 1 ) )
+                << ", worst frame ms: " << ( _worstTicks * 1000.0 / frequency ) << std::endl;
+  }
+
+private:
+  int     _frameCount;
+  int     _frames;
+  Uint64  _lastFrame;
+  Uint64  _totalTicks;
+  Uint64  _worstTicks;
+};
+
+int main( int argc, const char *argv[] )
+{
+  int nodeCount = argc > 1 ? atoi( argv[1] ) : 100000;
+  int frameCount = argc > 2 ? atoi( argv[2] ) : 300;
+  bool parallel = argc <= 3 || strcmp( argv[3], "serial" ) != 0;
+
+  Node::setParallelActionThreshold( parallel ? 1 : 0 );
+
+  // headless unless a video driver is picked in the environment
+  SDL_setenv( "SDL_VIDEODRIVER", "dummy", 0 );
+  if( Game::init( "ActionBenchmark", 0, 0, 640, 960, SDL_WINDOW_HIDDEN ) )
+  {
+    Log::info() << "nodes: " << nodeCount << ", " << ( parallel ? "parallel" : "serial" ) << std::endl;
+    BenchmarkScene scene( nodeCount, frameCount );
+    Game::getInstance()->setScene( &scene );
+    Game::getInstance()->run();
+    scene.report();
+  }
+  Game::quit();
+  return 0;
+}
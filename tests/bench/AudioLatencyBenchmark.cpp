@@ -0,0 +1,154 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Measures the audio latency of a device configuration, from Game::playSound until the sound is in a buffer mixed for
+ * the device, and until its first sample is played assuming the device plays buffers as soon as they are mixed. Runs
+ * headless on SDL's dummy audio driver by default; "disk" writes the output to a file, and the name of a real driver
+ * measures that device, whose hardware latency comes on top.
+ *
+ *   AudioLatencyBenchmark [bufferSize=1024] [frequency=22050] [channels=2] [driver=dummy] [samples=100]
+ */
+
+#include <stdlib.h>
+#include <atomic>
+#include <vector>
+#include <CocosDL/CocosDL.h>
+
+using namespace cocosdl;
+
+static const Sint16 AMPLITUDE = 8000;
+static const Sint16 THRESHOLD = 1000;
+
+static int _frequency;
+static int _channels;
+static std::atomic<Uint64> _requestCounter( 0 );
+static std::atomic<Uint64> _mixCounter( 0 );
+static std::atomic<Uint64> _outputCounter( 0 );
+
+// post effect on the final mix, finds the first sample of the test sound
+static void detectSound( int channel, void *stream, int length, void *data )
+{
+  if( _requestCounter == 0 || _mixCounter != 0 )
+  {
+    return;
+  }
+  Uint64 now = SDL_GetPerformanceCounter();
+  const Sint16 *samples = static_cast<const Sint16 *>( stream );
+  int count = length / (int) sizeof( Sint16 );
+  for( int i = 0; i < count; i++ )
+  {
+    if( samples[i] > THRESHOLD || samples[i] < -THRESHOLD )
+    {
+      Uint64 frame = (Uint64) ( i / _channels );
+      _outputCounter = now + frame * SDL_GetPerformanceFrequency() / _frequency;
+      _mixCounter = now;
+      return;
+    }
+  }
+}
+
+static double toMs( const Uint64 ticks )
+{
+  return ticks * 1000.0 / (double) SDL_GetPerformanceFrequency();
+}
+
+int main( int argc, const char *argv[] )
+{
+  AudioSettings settings;
+  settings.format = AUDIO_S16SYS;
+  settings.bufferSize = argc > 1 ? atoi( argv[1] ) : settings.bufferSize;
+  settings.frequency = argc > 2 ? atoi( argv[2] ) : settings.frequency;
+  settings.channels = argc > 3 ? atoi( argv[3] ) : settings.channels;
+  const char *driver = argc > 4 ? argv[4] : "dummy";
+  int sampleCount = argc > 5 ? atoi( argv[5] ) : 100;
+
+  SDL_setenv( "SDL_AUDIODRIVER", driver, 1 );
+  SDL_setenv( "SDL_VIDEODRIVER", "dummy", 1 );
+  SDL_SetHint( SDL_HINT_RENDER_DRIVER, "software" );
+  if( !Game::init( "AudioLatencyBenchmark", 0, 0, 64, 64, SDL_WINDOW_HIDDEN, settings ) )
+  {
+    Game::quit();
+    return 1;
+  }
+  Game *game = Game::getInstance();
+  const AudioSettings &obtained = game->getAudioSettings();
+  if( obtained.format != AUDIO_S16SYS )
+  {
+    Log::error() << "the device does not support 16 bit samples" << std::endl;
+    Game::quit();
+    return 1;
+  }
+  _frequency = obtained.frequency;
+  _channels = obtained.channels;
+
+  // 50 ms square wave
+  std::vector<Sint16> wave( (size_t) ( obtained.frequency / 20 * obtained.channels ) );
+  for( size_t i = 0; i < wave.size(); i++ )
+  {
+    wave[i] = ( i / obtained.channels / 50 ) % 2 ? AMPLITUDE : -AMPLITUDE;
+  }
+  SoundHandle sound = game->getResources()->addSound(
+      "latency", Mix_QuickLoad_RAW( (Uint8 *) &wave[0], (Uint32) ( wave.size() * sizeof( Sint16 ) ) ) );
+  Mix_RegisterEffect( MIX_CHANNEL_POST, detectSound, NULL, NULL );
+
+  Log::info() << "driver: " << driver << ", " << obtained.frequency << " Hz, " << obtained.channels
+              << " channels, buffer " << obtained.bufferSize << " samples (" << obtained.getBufferMs() << " ms)"
+              << std::endl;
+
+  int measured = 0;
+  double mixTotal = 0.0, mixWorst = 0.0, outputTotal = 0.0, outputWorst = 0.0;
+  Uint32 period = (Uint32) obtained.getBufferMs() + 1;
+  for( int i = 0; i < sampleCount; i++ )
+  {
+    // start anywhere in the buffer period
+    SDL_Delay( (Uint32) rand() % period );
+    _mixCounter = 0;
+    _requestCounter = SDL_GetPerformanceCounter();
+    int voice = game->playSound( sound );
+    Uint32 timeout = SDL_GetTicks() + 1000;
+    while( _mixCounter == 0 && voice != -1 && SDL_GetTicks() < timeout )
+    {
+      SDL_Delay( 1 );
+    }
+    game->getMixer()->stop( voice );
+    if( _mixCounter != 0 )
+    {
+      double mixMs = toMs( _mixCounter - _requestCounter );
+      double outputMs = toMs( _outputCounter - _requestCounter );
+      mixTotal += mixMs;
+      mixWorst = mixMs > mixWorst ? mixMs : mixWorst;
+      outputTotal += outputMs;
+      outputWorst = outputMs > outputWorst ? outputMs : outputWorst;
+      measured++;
+    }
+    _requestCounter = 0;
+    // let the device drain the stopped sound
+    SDL_Delay( period * 3 );
+  }
+
+  Log::info() << "measured: " << measured << " of " << sampleCount << std::endl;
+  if( measured > 0 )
+  {
+    Log::info() << "in mixed buffer: average " << mixTotal / measured << " ms, worst " << mixWorst << " ms" << std::endl;
+    Log::info() << "first sample played: average " << outputTotal / measured << " ms, worst " << outputWorst << " ms"
+                << std::endl;
+  }
+  Log::info() << "underruns: " << game->getMusicPlayer()->getUnderrunCount() << std::endl;
+  sound.reset();
+  Game::quit();
+  return 0;
+}
@@ -0,0 +1,116 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Measures the collision world step with bodies wandering over a 1920x1080 field, half of them on a player layer
+ * colliding only with the other half, as bullets against enemies:
+ *
+ *   CollisionBenchmark [bodies=10000] [frames=300]
+ */
+
+#include <stdlib.h>
+#include <vector>
+#include <CocosDL/CollisionWorld.h>
+#include <CocosDL/Node.h>
+#include <CocosDL/Log.h>
+
+using namespace cocosdl;
+
+static const int FIELD_WIDTH = 1920;
+static const int FIELD_HEIGHT = 1080;
+static const int BODY_SIZE = 12;
+static const int MAX_SPEED = 4;
+static const Uint32 PLAYER_LAYER = 1;
+static const Uint32 ENEMY_LAYER = 2;
+
+class ContactCounter : public CollisionListener
+{
+
+public:
+  size_t began;
+  size_t ended;
+
+  ContactCounter() : began( 0 ), ended( 0 )
+  {
+  }
+
+  void contactsBegan( CollisionWorld &world, const std::vector<Contact> &contacts )
+  {
+    began += contacts.size();
+  }
+
+  void contactsEnded( CollisionWorld &world, const std::vector<Contact> &contacts )
+  {
+    ended += contacts.size();
+  }
+};
+
+static int wrap( const int value, const int limit )
+{
+  return value < 0 ? value + limit : ( value >= limit ? value - limit : value );
+}
+
+int main( int argc, const char *argv[] )
+{
+  int bodyCount = argc > 1 ? atoi( argv[1] ) : 10000;
+  int frameCount = argc > 2 ? atoi( argv[2] ) : 300;
+  CollisionWorld world;
+  ContactCounter counter;
+  world.addListener( &counter );
+
+  std::vector<Node *> bodies;
+  std::vector<int> speeds;
+  for( int i = 0; i < bodyCount; i++ )
+  {
+    Node *body = new Node();
+    body->setPosition( rand() % FIELD_WIDTH, rand() % FIELD_HEIGHT );
+    body->setDimension( BODY_SIZE, BODY_SIZE );
+    bool player = i % 2 == 0;
+    world.addBody( body, player ? PLAYER_LAYER : ENEMY_LAYER, player ? ENEMY_LAYER : PLAYER_LAYER );
+    bodies.push_back( body );
+    speeds.push_back( rand() % ( 2 * MAX_SPEED + 1 ) - MAX_SPEED );
+    speeds.push_back( rand() % ( 2 * MAX_SPEED + 1 ) - MAX_SPEED );
+  }
+  world.step();
+  Log::info() << "first step of " << bodyCount << " bodies: " << world.getStepMs() << " ms" << std::endl;
+
+  double total = 0.0;
+  double worst = 0.0;
+  size_t pairTests = 0;
+  size_t contacts = 0;
+  for( int frame = 0; frame < frameCount; frame++ )
+  {
+    for( size_t i = 0; i < bodies.size(); i++ )
+    {
+      bodies[i]->setPosition( wrap( bodies[i]->getX() + speeds[2 * i], FIELD_WIDTH ),
+                              wrap( bodies[i]->getY() + speeds[2 * i + 1], FIELD_HEIGHT ) );
+    }
+    world.step();
+    total += world.getStepMs();
+    worst = world.getStepMs() > worst ? world.getStepMs() : worst;
+    pairTests += world.getPairTestCount();
+    contacts += world.getContactCount();
+  }
+  Log::info() << "step: average " << total / frameCount << " ms, worst " << worst << " ms" << std::endl;
+  Log::info() << "per step: " << pairTests / frameCount << " pair tests, " << contacts / frameCount << " contacts, "
+              << ( counter.began + counter.ended ) / frameCount << " began or ended" << std::endl;
+
+  for( size_t i = 0; i < bodies.size(); i++ )
+  {
+    delete bodies[i];
+  }
+  return 0;
+}
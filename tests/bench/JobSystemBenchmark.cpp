@@ -0,0 +1,124 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Microbenchmarks for util::JobSystem:
+ *  - dispatch latency: time from scheduling a job until a worker starts running it
+ *  - throughput: empty jobs per second, as children of a single root job
+ *  - parallelFor: speedup over a plain loop for a compute bound range
+ *
+ *   JobSystemBenchmark [threads=0 (hardware threads - 1)]
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <CocosDL/JobSystem.h>
+#include <CocosDL/Log.h>
+
+using namespace cocosdl;
+using namespace cocosdl::util;
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs( const Clock::time_point &start, const Clock::time_point &end )
+{
+  return std::chrono::duration<double, std::milli>( end - start ).count();
+}
+
+static void measureLatency( JobSystem &jobSystem )
+{
+  const int samples = 10000;
+  double total = 0.0;
+  double worst = 0.0;
+  for( int i = 0; i < samples; i++ )
+  {
+    std::atomic<bool> started( false );
+    Clock::time_point startTime;
+    Clock::time_point scheduled = Clock::now();
+    jobSystem.runAsync( [&started, &startTime]()
+    {
+      startTime = Clock::now();
+      started = true;
+    } );
+    while( !started )
+    {
+    }
+    double latency = elapsedMs( scheduled, startTime ) * 1000.0;
+    total += latency;
+    worst = latency > worst ? latency : worst;
+  }
+  Log::info() << "dispatch latency: average " << total / samples << " us, worst " << worst << " us" << std::endl;
+}
+
+static void measureThroughput( JobSystem &jobSystem )
+{
+  const int jobs = 1000000;
+  std::atomic<int> counter( 0 );
+  Clock::time_point start = Clock::now();
+  JobSystem::Job *root = jobSystem.createJob( JobSystem::JobFunction() );
+  for( int i = 0; i < jobs; i++ )
+  {
+    jobSystem.run( jobSystem.createJob( [&counter]()
+    {
+      counter++;
+    }, root ) );
+  }
+  jobSystem.run( root );
+  jobSystem.wait( root );
+  double ms = elapsedMs( start, Clock::now() );
+  Log::info() << "throughput: " << jobs << " jobs in " << ms << " ms, " << ( jobs / ms * 1000.0 ) << " jobs/s"
+              << std::endl;
+}
+
+static void measureParallelFor( JobSystem &jobSystem )
+{
+  const size_t count = 4000000;
+  std::vector<float> values( count );
+  JobSystem::RangeFunction body = [&values]( size_t begin, size_t end )
+  {
+    for( size_t i = begin; i < end; i++ )
+    {
+      values[i] = sqrtf( (float) i ) * sinf( (float) i );
+    }
+  };
+
+  Clock::time_point start = Clock::now();
+  body( 0, count );
+  double serialMs = elapsedMs( start, Clock::now() );
+
+  start = Clock::now();
+  jobSystem.parallelFor( count, 4096, body );
+  double parallelMs = elapsedMs( start, Clock::now() );
+
+  Log::info() << "parallelFor: serial " << serialMs << " ms, parallel " << parallelMs << " ms, speedup "
+              << serialMs / parallelMs << "x" << std::endl;
+}
+
+int main( int argc, const char *argv[] )
+{
+  JobSystem jobSystem( argc > 1 ? (unsigned) atoi( argv[1] ) : 0 );
+  Log::info() << "workers: " << jobSystem.getThreadCount() << std::endl;
+  if( jobSystem.getThreadCount() > 0 )
+  {
+    measureLatency( jobSystem );
+  }
+  measureThroughput( jobSystem );
+  measureParallelFor( jobSystem );
+  return 0;
+}
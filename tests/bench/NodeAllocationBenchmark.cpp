@@ -0,0 +1,150 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Measures spawning and deleting particles, as small Node subclasses, per frame:
+ *  - heap: allocated with the global operator new, as before nodes were pooled
+ *  - pool: allocated with Node::create from the shared size class pools
+ *  - arena: allocated with Node::create in a util::NodeArena, released in one go at the end
+ * and checks that a node detached from the tree can still be deleted after its arena was released, as when a scene
+ * is deleted while a node removed with removeChild( node, false ) is kept:
+ *
+ *   NodeAllocationBenchmark [particles=20000] [frames=300]
+ */
+
+#include <stdlib.h>
+#include <chrono>
+#include <new>
+#include <vector>
+#include <CocosDL/Node.h>
+#include <CocosDL/NodeArena.h>
+#include <CocosDL/Log.h>
+
+using namespace cocosdl;
+
+typedef std::chrono::steady_clock Clock;
+
+enum Mode
+{
+  HeapMode, PoolMode, ArenaMode
+};
+
+class Particle : public Node
+{
+
+public:
+  Particle( const int x, const int y ) : Node(), _life( 30 + rand() % 60 )
+  {
+    setPosition( x, y );
+    setDimension( 4, 4 );
+  }
+
+  int _life;
+};
+
+static Particle *spawn( const Mode mode, const int x, const int y )
+{
+  return mode == HeapMode ? ::new Particle( x, y ) : Node::create<Particle>( x, y );
+}
+
+static void destroy( const Mode mode, Particle *particle )
+{
+  if( mode == HeapMode )
+  {
+    particle->~Particle();
+    ::operator delete( particle );
+  }
+  else
+  {
+    delete particle;
+  }
+}
+
+static double run( const Mode mode, const int particleCount, const int frameCount )
+{
+  util::NodeArena arena;
+  util::NodeArena::Scope scope( mode == ArenaMode ? &arena : NULL );
+  std::vector<Particle *> particles;
+  srand( 1 );
+
+  Clock::time_point start = Clock::now();
+  for( int i = 0; i < particleCount; i++ )
+  {
+    particles.push_back( spawn( mode, i % 640, i % 960 ) );
+  }
+  for( int frame = 0; frame < frameCount; frame++ )
+  {
+    // expired particles are replaced by new ones, a few percent every frame
+    for( size_t i = 0; i < particles.size(); i++ )
+    {
+      if( --particles[i]->_life <= 0 )
+      {
+        int x = particles[i]->getX();
+        int y = particles[i]->getY();
+        destroy( mode, particles[i] );
+        particles[i] = spawn( mode, x, y );
+      }
+    }
+  }
+  for( size_t i = 0; i < particles.size(); i++ )
+  {
+    destroy( mode, particles[i] );
+  }
+  if( mode == ArenaMode )
+  {
+    arena.reset();
+  }
+  return std::chrono::duration<double, std::milli>( Clock::now() - start ).count();
+}
+
+static bool deleteDetachedAfterRelease()
+{
+  util::NodeArena *arena = new util::NodeArena();
+  Node *parent;
+  Particle *detached;
+  {
+    util::NodeArena::Scope scope( arena );
+    parent = Node::create<Node>();
+    detached = Node::create<Particle>( 0, 0 );
+  }
+  parent->addChild( detached );
+  parent->removeChild( detached, false );
+  delete parent;
+  arena->release();
+  bool kept = arena->getLiveCount() == 1;
+  // the last live node deletes the arena
+  delete detached;
+  return kept;
+}
+
+int main( int argc, const char *argv[] )
+{
+  int particleCount = argc > 1 ? atoi( argv[1] ) : 20000;
+  int frameCount = argc > 2 ? atoi( argv[2] ) : 300;
+  const char *names[] = { "heap", "pool", "arena" };
+  for( int mode = HeapMode; mode <= ArenaMode; mode++ )
+  {
+    double ms = run( (Mode) mode, particleCount, frameCount );
+    Log::info() << names[mode] << ": " << ms << " ms, " << ms / frameCount << " ms per frame" << std::endl;
+  }
+  if( !deleteDetachedAfterRelease() )
+  {
+    Log::error() << "released arena did not wait for its detached node" << std::endl;
+    return 1;
+  }
+  Log::info() << "detached node deleted after its arena was released" << std::endl;
+  return 0;
+}
@@ -0,0 +1,100 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Measures adding and removing children of a single parent, as when spawning and despawning bullets:
+ *  - spawn: adding every bullet to the parent
+ *  - despawn: removing and deleting every bullet in random order
+ *  - churn: frames spawning and despawning a share of the bullets, the parent compacted once per frame
+ *
+ *   NodeChildrenBenchmark [bullets=50000] [frames=300]
+ */
+
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <CocosDL/Node.h>
+#include <CocosDL/Log.h>
+
+using namespace cocosdl;
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs( const Clock::time_point &start )
+{
+  return std::chrono::duration<double, std::milli>( Clock::now() - start ).count();
+}
+
+static void spawn( Node &parent, std::vector<Node *> &bullets, const int count )
+{
+  for( int i = 0; i < count; i++ )
+  {
+    Node *bullet = new Node();
+    bullet->setPosition( i % 640, i % 960 );
+    parent.addChild( bullet );
+    bullets.push_back( bullet );
+  }
+}
+
+int main( int argc, const char *argv[] )
+{
+  int bulletCount = argc > 1 ? atoi( argv[1] ) : 50000;
+  int frameCount = argc > 2 ? atoi( argv[2] ) : 300;
+  Node parent;
+  std::vector<Node *> bullets;
+  bullets.reserve( (size_t) bulletCount );
+
+  Clock::time_point start = Clock::now();
+  spawn( parent, bullets, bulletCount );
+  Log::info() << "spawn " << bulletCount << ": " << elapsedMs( start ) << " ms" << std::endl;
+
+  std::random_shuffle( bullets.begin(), bullets.end() );
+  start = Clock::now();
+  for( size_t i = 0; i < bullets.size(); i++ )
+  {
+    parent.removeChild( bullets[i], true );
+  }
+  parent.getChildren();
+  Log::info() << "despawn " << bulletCount << ": " << elapsedMs( start ) << " ms" << std::endl;
+  bullets.clear();
+
+  // a tenth of the bullets hit something and are replaced every frame
+  spawn( parent, bullets, bulletCount );
+  int turnover = bulletCount / 10;
+  double total = 0.0;
+  double worst = 0.0;
+  for( int frame = 0; frame < frameCount; frame++ )
+  {
+    start = Clock::now();
+    for( int i = 0; i < turnover; i++ )
+    {
+      size_t hit = (size_t) rand() % bullets.size();
+      parent.removeChild( bullets[hit], true );
+      bullets[hit] = bullets.back();
+      bullets.pop_back();
+    }
+    spawn( parent, bullets, turnover );
+    // the game loop compacts the children once per frame
+    parent.getChildren();
+    double frameMs = elapsedMs( start );
+    total += frameMs;
+    worst = frameMs > worst ? frameMs : worst;
+  }
+  Log::info() << "churn of " << turnover << " per frame: average " << total / frameCount << " ms, worst " << worst
+              << " ms" << std::endl;
+  return 0;
+}
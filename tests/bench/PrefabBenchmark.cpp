@@ -0,0 +1,105 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Measures spawning a 40 node enemy (a body, 19 sprites and 20 labels with an animation) built from scratch each time
+ * against stamping it out of a Prefab. Labels render their text with a font from the resources:
+ *
+ *   PrefabBenchmark <font name> [instances=1000] [texture]
+ */
+
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <CocosDL/CocosDL.h>
+
+using namespace cocosdl;
+using namespace cocosdl::action;
+
+typedef std::chrono::steady_clock Clock;
+
+static const int PARTS = 19;
+
+static Node *buildEnemy( const std::string &fontName, const std::string &textureName )
+{
+  Node *enemy = new Node( "enemy" );
+  for( int i = 0; i < PARTS; i++ )
+  {
+    Sprite *part = textureName.empty() ? new Sprite() : new Sprite( textureName );
+    part->setPosition( i * 4, 0 );
+    enemy->addChild( part );
+    Label *label = new Label( fontName, 12, "HP 100" );
+    label->setPosition( i * 4, 10 );
+    enemy->addChild( label );
+  }
+  Label *name = new Label( fontName, 14, "Enemy" );
+  enemy->addChild( name );
+  SequenceAction *sequence = new SequenceAction();
+  sequence->addAction( new MoveByAction( 500, 20, 0 ) );
+  sequence->addAction( new MoveByAction( 500, -20, 0 ) );
+  enemy->addAction( new RepeatForeverAction( sequence ) );
+  return enemy;
+}
+
+static double elapsedMs( const Clock::time_point &start )
+{
+  return std::chrono::duration<double, std::milli>( Clock::now() - start ).count();
+}
+
+int main( int argc, const char *argv[] )
+{
+  if( argc < 2 )
+  {
+    Log::error() << "Usage: PrefabBenchmark <font name> [instances] [texture]" << std::endl;
+    return 1;
+  }
+  std::string fontName = argv[1];
+  int instanceCount = argc > 2 ? atoi( argv[2] ) : 1000;
+  std::string textureName = argc > 3 ? argv[3] : "";
+
+  // headless unless a video driver is picked in the environment
+  SDL_setenv( "SDL_VIDEODRIVER", "dummy", 0 );
+  if( Game::init( "PrefabBenchmark", 0, 0, 640, 960, SDL_WINDOW_HIDDEN ) )
+  {
+    std::vector<Node *> enemies;
+    Clock::time_point start = Clock::now();
+    for( int i = 0; i < instanceCount; i++ )
+    {
+      enemies.push_back( buildEnemy( fontName, textureName ) );
+    }
+    Log::info() << "built " << instanceCount << ": " << elapsedMs( start ) << " ms" << std::endl;
+    for( size_t i = 0; i < enemies.size(); i++ )
+    {
+      delete enemies[i];
+    }
+    enemies.clear();
+
+    Prefab prefab( buildEnemy( fontName, textureName ) );
+    start = Clock::now();
+    for( int i = 0; i < instanceCount; i++ )
+    {
+      enemies.push_back( prefab.instantiate() );
+    }
+    Log::info() << "instantiated " << instanceCount << ": " << elapsedMs( start ) << " ms" << std::endl;
+    for( size_t i = 0; i < enemies.size(); i++ )
+    {
+      delete enemies[i];
+    }
+  }
+  Game::quit();
+  return 0;
+}
@@ -0,0 +1,124 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Measures a batch of sprites from the four quarters of a texture, all of them moving and spinning every frame.
+ * Update is the data-oriented loop over the sprite arrays, draw builds the vertices and submits the single batch:
+ *
+ *   SpriteBatchBenchmark <texture> [sprites=100000] [frames=300]
+ *
+ * It runs headless on the software renderer of the dummy video driver; set SDL_VIDEODRIVER to measure a real one.
+ */
+
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include <CocosDL/CocosDL.h>
+
+using namespace cocosdl;
+
+typedef std::chrono::steady_clock Clock;
+
+static const int FIELD_WIDTH = 1920;
+static const int FIELD_HEIGHT = 1080;
+static const int SPRITE_SIZE = 16;
+static const float MAX_SPEED = 4.0f;
+
+static double elapsedMs( const Clock::time_point &start )
+{
+  return std::chrono::duration<double, std::milli>( Clock::now() - start ).count();
+}
+
+static float randomSpeed()
+{
+  return ( rand() / (float) RAND_MAX * 2.0f - 1.0f ) * MAX_SPEED;
+}
+
+int main( int argc, const char *argv[] )
+{
+  if( argc < 2 )
+  {
+    Log::error() << "Usage: SpriteBatchBenchmark <texture> [sprites] [frames]" << std::endl;
+    return 1;
+  }
+  int spriteCount = argc > 2 ? atoi( argv[2] ) : 100000;
+  int frameCount = argc > 3 ? atoi( argv[3] ) : 300;
+
+  // headless unless a video driver is picked in the environment
+  SDL_setenv( "SDL_VIDEODRIVER", "dummy", 0 );
+  if( Game::init( "SpriteBatchBenchmark", 0, 0, FIELD_WIDTH, FIELD_HEIGHT, SDL_WINDOW_HIDDEN ) )
+  {
+    SpriteBatchNode *batch = new SpriteBatchNode( argv[1], spriteCount );
+    Texture *texture = batch->getTexture();
+    if( !texture )
+    {
+      delete batch;
+      return 1;
+    }
+    int frameWidth = texture->getWidth() / 2;
+    int frameHeight = texture->getHeight() / 2;
+    for( int i = 0; i < 4; i++ )
+    {
+      batch->addFrame( Rect( ( i % 2 ) * frameWidth, ( i / 2 ) * frameHeight, frameWidth, frameHeight ) );
+    }
+
+    std::vector<float> speeds;
+    for( int i = 0; i < spriteCount; i++ )
+    {
+      Uint32 id = batch->addSprite( rand() % FIELD_WIDTH, rand() % FIELD_HEIGHT, 1 + i % 4 );
+      batch->setSpriteSize( id, SPRITE_SIZE, SPRITE_SIZE );
+      speeds.push_back( randomSpeed() );
+      speeds.push_back( randomSpeed() );
+    }
+
+    Renderer *renderer = Game::getInstance()->getRenderer();
+    double updateTotal = 0.0;
+    double drawTotal = 0.0;
+    double worst = 0.0;
+    for( int frame = 0; frame < frameCount; frame++ )
+    {
+      Clock::time_point start = Clock::now();
+      size_t count = batch->getSpriteCount();
+      float *xs = batch->getXs();
+      float *ys = batch->getYs();
+      float *rotations = batch->getRotations();
+      for( size_t i = 0; i < count; i++ )
+      {
+        xs[i] += speeds[2 * i];
+        ys[i] += speeds[2 * i + 1];
+        xs[i] = xs[i] < 0 ? xs[i] + FIELD_WIDTH : ( xs[i] >= FIELD_WIDTH ? xs[i] - FIELD_WIDTH : xs[i] );
+        ys[i] = ys[i] < 0 ? ys[i] + FIELD_HEIGHT : ( ys[i] >= FIELD_HEIGHT ? ys[i] - FIELD_HEIGHT : ys[i] );
+        rotations[i] += 2.0f;
+      }
+      double updateMs = elapsedMs( start );
+
+      start = Clock::now();
+      renderer->clear();
+      batch->draw();
+      double drawMs = elapsedMs( start );
+      renderer->present();
+
+      updateTotal += updateMs;
+      drawTotal += drawMs;
+      worst = updateMs + drawMs > worst ? updateMs + drawMs : worst;
+    }
+    Log::info() << spriteCount << " sprites: update " << updateTotal / frameCount << " ms, draw "
+                << drawTotal / frameCount << " ms, worst frame " << worst << " ms" << std::endl;
+
+    delete batch;
+  }
+  return 0;
+}
@@ -25,7 +25,8 @@ MainScene::MainScene()
   Point center;
   getCenter( center );
 
-  Sprite* background = new Sprite( "background.jpg" );
+  Sprite* background = new Sprite();
+  background->setTextureAsync( "background.jpg" );
   background->setPosition( center );
   addChild( background );
 
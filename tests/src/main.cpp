@@ -19,6 +19,7 @@
 #include <CocosDL/Button.h>
 #include <CocosDL/Log.h>
 #include <CocosDL/Label.h>
+#include <CocosDL/PreloadManifest.h>
 #include "settings.h"
 #include "MainScene.h"
 
@@ -28,26 +29,18 @@ int main(int argc, const char * argv[])
 {
   if( Game::init( "CocosDLTest", 100, 100, 640, 1136 ) ) {
     Game *game = Game::getInstance();
-    bool initOk = true;
-    if( !game->loadMusic( "menu" ) ) {
-      Log::error() << "Can't load menu music";
-      initOk = false;
-    }
-    if( !game->loadSound( "hit" ) ) {
-      Log::error() << "Can't load sound effect (hit)";
-      initOk = false;
-    }
-    if( !game->loadSound( "blop" ) ) {
-      Log::error() << "Can't load sound effect (blop)";
-      initOk = false;
-    }
-    if( !game->loadSound( "bomb" ) ) {
-      Log::error() << "Can't load sound effect (bomb)";
-      initOk = false;
-    }
-    if( !game->loadSound( "click" ) ) {
-      Log::error() << "Can't load sound effect (click)";
-      initOk = false;
+    PreloadManifest manifest;
+    manifest.addMusic( "menu" );
+    manifest.addSound( "hit" );
+    manifest.addSound( "blop" );
+    manifest.addSound( "bomb" );
+    manifest.addSound( "click" );
+    manifest.addFont( DEFAULT_FONT, DEFAULT_FONT_SIZE );
+    manifest.addTexture( "background.jpg" );
+    bool initOk = game->preloadAndWait( &manifest );
+    manifest.logTimings();
+    if( !initOk ) {
+      Log::error() << "Can't load the game assets";
     }
 
     if( initOk ) {
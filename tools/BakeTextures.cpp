@@ -0,0 +1,149 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Pre-decodes the images of a resource directory for util::TextureCache. Every PNG and JPEG file under the directory
+ * gets a <file>.cdlt entry next to it, which PackAssets then packs with the rest of the resources. Entries already
+ * matching their source are left as they are.
+ *
+ *   BakeTextures <res directory>
+ */
+
+#include <dirent.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <CocosDL/TextureCache.h>
+#include <CocosDL/Log.h>
+
+using namespace cocosdl;
+using namespace cocosdl::util;
+
+static bool isImage( const std::string &name )
+{
+  size_t dot = name.rfind( '.' );
+  if( dot == std::string::npos )
+  {
+    return false;
+  }
+  const char *extension = name.c_str() + dot + 1;
+  return strcasecmp( extension, "png" ) == 0 || strcasecmp( extension, "jpg" ) == 0 ||
+         strcasecmp( extension, "jpeg" ) == 0;
+}
+
+static bool listImages( const std::string &directory, std::vector<std::string> &paths )
+{
+  DIR *dir = opendir( directory.c_str() );
+  if( !dir )
+  {
+    Log::error() << "Can't read directory " << directory << std::endl;
+    return false;
+  }
+  bool ok = true;
+  struct dirent *entry;
+  while( ok && ( entry = readdir( dir ) ) != NULL )
+  {
+    std::string name = entry->d_name;
+    if( name.empty() || name[0] == '.' )
+    {
+      continue;
+    }
+    std::string path = directory + "/" + name;
+    struct stat fileStat;
+    if( stat( path.c_str(), &fileStat ) != 0 )
+    {
+      continue;
+    }
+    if( S_ISDIR( fileStat.st_mode ) )
+    {
+      ok = listImages( path, paths );
+    }
+    else if( S_ISREG( fileStat.st_mode ) && isImage( name ) )
+    {
+      paths.push_back( path );
+    }
+  }
+  closedir( dir );
+  return ok;
+}
+
+static bool readFile( const std::string &path, std::vector<Uint8> &data )
+{
+  SDL_RWops *rw = SDL_RWFromFile( path.c_str(), "rb" );
+  if( !rw )
+  {
+    return false;
+  }
+  Sint64 size = SDL_RWsize( rw );
+  bool ok = size > 0;
+  if( ok )
+  {
+    data.resize( (size_t) size );
+    ok = SDL_RWread( rw, &data[0], (size_t) size, 1 ) == 1;
+  }
+  SDL_RWclose( rw );
+  return ok;
+}
+
+int main( int argc, const char *argv[] )
+{
+  if( argc != 2 )
+  {
+    Log::error() << "Usage: BakeTextures <res directory>" << std::endl;
+    return 1;
+  }
+  std::vector<std::string> paths;
+  if( !listImages( argv[1], paths ) )
+  {
+    return 1;
+  }
+
+  size_t baked = 0;
+  for( size_t i = 0; i < paths.size(); i++ )
+  {
+    const std::string &path = paths.at( i );
+    const std::string entryPath = path + TextureCache::FILE_EXTENSION;
+    std::vector<Uint8> source;
+    if( !readFile( path, source ) )
+    {
+      Log::error() << "Can't read " << path << std::endl;
+      return 1;
+    }
+    Uint64 sourceHash = TextureCache::hashContents( &source[0], source.size() );
+    if( TextureCache::isValid( entryPath, sourceHash ) )
+    {
+      continue;
+    }
+    SDL_Surface *surface = TextureCache::decodeImage( &source[0], source.size() );
+    if( !surface )
+    {
+      Log::error() << "Can't decode " << path << std::endl;
+      return 1;
+    }
+    bool ok = TextureCache::write( entryPath, surface, sourceHash );
+    Log::info() << entryPath << ": " << surface->w << "x" << surface->h << std::endl;
+    SDL_FreeSurface( surface );
+    if( !ok )
+    {
+      return 1;
+    }
+    baked++;
+  }
+  Log::info() << "Baked " << baked << " of " << paths.size() << " images" << std::endl;
+  return 0;
+}
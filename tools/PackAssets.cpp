@@ -0,0 +1,118 @@
+/*
+   Copyright (c) 2014 Narciso Cerezo. All rights reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Packs a resource directory into an asset archive (see util::AssetArchive). Every regular file under the directory
+ * is stored with its path relative to it, using '/' separators, so resources keep the names the game loads them with.
+ * Hidden files are skipped.
+ *
+ *   PackAssets <res directory> <archive file>
+ *
+ * Copy the archive as res/assets.pak (Game's DEFAULT_ASSET_ARCHIVE) to have it mounted on start.
+ */
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <CocosDL/AssetArchive.h>
+#include <CocosDL/Log.h>
+
+using namespace cocosdl;
+using namespace cocosdl::util;
+
+static bool listFiles( const std::string &directory, const std::string &prefix, std::vector<std::string> &names )
+{
+  DIR *dir = opendir( directory.c_str() );
+  if( !dir )
+  {
+    Log::error() << "Can't read directory " << directory << std::endl;
+    return false;
+  }
+  bool ok = true;
+  struct dirent *entry;
+  while( ok && ( entry = readdir( dir ) ) != NULL )
+  {
+    std::string name = entry->d_name;
+    if( name.empty() || name[0] == '.' )
+    {
+      continue;
+    }
+    std::string path = directory + "/" + name;
+    struct stat fileStat;
+    if( stat( path.c_str(), &fileStat ) != 0 )
+    {
+      continue;
+    }
+    if( S_ISDIR( fileStat.st_mode ) )
+    {
+      ok = listFiles( path, prefix + name + "/", names );
+    }
+    else if( S_ISREG( fileStat.st_mode ) )
+    {
+      names.push_back( prefix + name );
+    }
+  }
+  closedir( dir );
+  return ok;
+}
+
+int main( int argc, const char *argv[] )
+{
+  if( argc != 3 )
+  {
+    Log::error() << "Usage: PackAssets <res directory> <archive file>" << std::endl;
+    return 1;
+  }
+  std::string directory = argv[1];
+  std::vector<std::string> names;
+  if( !listFiles( directory, "", names ) )
+  {
+    return 1;
+  }
+  // sorted, so packing the same directory always produces the same archive
+  std::sort( names.begin(), names.end() );
+
+  AssetArchiveWriter writer;
+  for( size_t i = 0; i < names.size(); i++ )
+  {
+    if( !writer.addFile( names.at( i ), directory + "/" + names.at( i ) ) )
+    {
+      return 1;
+    }
+  }
+  if( !writer.save( argv[2] ) )
+  {
+    return 1;
+  }
+
+  // check it reads back
+  AssetArchive archive;
+  if( !archive.open( argv[2] ) || archive.getCount() != names.size() )
+  {
+    Log::error() << "The archive written can't be read back" << std::endl;
+    return 1;
+  }
+  for( size_t i = 0; i < names.size(); i++ )
+  {
+    size_t size;
+    archive.find( names.at( i ), size );
+    Log::info() << names.at( i ) << ": " << size << " bytes" << std::endl;
+  }
+  Log::info() << "Packed " << names.size() << " files into " << argv[2] << std::endl;
+  return 0;
+}